@@ -0,0 +1,570 @@
+// Deterministic benchmark harness.
+//
+// Flies a recorded camera path through the scenes of util/SceneSetup.h with a fixed timestep,
+// once per rendering strategy and Settings combination, and writes the results as JSON.
+//
+//  FluxLuminaBench [--output results.json] [--frames 600] [--width 1280] [--height 720]
+//                  [--scenes scene01,scene01_10k,scene02,scene03,scene04] [--full-matrix] [--software] [--gpu-culling] [--occlusion-culling] [--no-lod]
+
+// First-party includes
+#include "FluxLumina.hpp"
+#include "util/SceneSetup.h"
+
+#include "scene/Scene.hpp"
+#include "rendering/Settings.hpp"
+#include "rendering/RenderStatistics.hpp"
+#include "rendering/GLStateCache.hpp"
+#include "rendering/strategy/StrategyChain.hpp"
+
+// STL includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    ///////////////////////////////////////////////////////////////////////////////////////////
+    /////////////////////////// SCENES
+    ///////////////////////////////////////////////////////////////////////////////////////////
+
+    struct BenchScene
+    {
+        std::string name;
+        std::function<void(FluxLumina&)> setup;
+        std::vector<E_RenderStrategy> strategies;   // Strategies the scene's shaders are written for
+        float extent;                               // Rough radius of the scene, scales the camera path
+    };
+
+    std::vector<BenchScene> benchScenes()
+    {
+        return {
+            { "scene01",     [](FluxLumina& engine){ scene01_Setup(engine); },
+                { E_RenderStrategy::ForwardShading, E_RenderStrategy::DeferredShading }, 30.0f },
+            { "scene01_10k", [](FluxLumina& engine){ scene01_Setup(engine, 100); },
+                { E_RenderStrategy::ForwardShading, E_RenderStrategy::DeferredShading }, 500.0f },
+            { "scene02",     [](FluxLumina& engine){ scene02_Setup(engine); },
+                { E_RenderStrategy::PBSShading }, 6.0f },
+            { "scene03",     [](FluxLumina& engine){ scene03_Setup(engine); },
+                { E_RenderStrategy::PBSShading }, 15.0f },
+            // Forward only, the toggle between the sorted and the weighted blended transparent passes is a forward one
+            { "scene04",     [](FluxLumina& engine){ scene04_Setup(engine); },
+                { E_RenderStrategy::ForwardShading }, 18.0f },
+        };
+    }
+
+    const char* strategyName(E_RenderStrategy strategy)
+    {
+        switch (strategy)
+        {
+            case E_RenderStrategy::DeferredShading:
+                return "Deferred";
+            case E_RenderStrategy::PBSShading:
+                return "PBS";
+            default:
+            case E_RenderStrategy::ForwardShading:
+                return "Forward";
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////
+    /////////////////////////// CAMERA PATH
+    ///////////////////////////////////////////////////////////////////////////////////////////
+
+    struct CameraKeyframe
+    {
+        float time;                         // Seconds
+        std::array<float, 3> position;      // In units of the scene extent
+        std::array<float, 3> target;
+    };
+
+    // Recorded once, replayed identically on every run: a high orbit followed by a low pass through the scene
+    const std::vector<CameraKeyframe> cameraPath = {
+        { 0.0f,  { 0.0f, 0.6f,  1.6f}, {0.0f, 0.0f,  0.0f} },
+        { 2.0f,  { 1.6f, 0.5f,  0.0f}, {0.0f, 0.0f,  0.0f} },
+        { 4.0f,  { 0.0f, 0.4f, -1.6f}, {0.0f, 0.0f,  0.0f} },
+        { 6.0f,  {-1.6f, 0.3f,  0.0f}, {0.0f, 0.1f,  0.0f} },
+        { 8.0f,  {-0.8f, 0.1f,  0.8f}, {0.8f, 0.1f, -0.8f} },
+        { 10.0f, { 0.8f, 0.1f, -0.8f}, {1.6f, 0.1f, -1.6f} },
+    };
+
+    std::array<float, 3> lerp(const std::array<float, 3>& a, const std::array<float, 3>& b, float t, float scale)
+    {
+        return {
+            (a[0] + (b[0] - a[0]) * t) * scale,
+            (a[1] + (b[1] - a[1]) * t) * scale,
+            (a[2] + (b[2] - a[2]) * t) * scale
+        };
+    }
+
+    void applyCameraPath(FluxLumina& engine, float time, float extent)
+    {
+        // The path loops when more frames than its length are requested
+        float duration = cameraPath.back().time;
+        time = std::fmod(time, duration);
+
+        unsigned int segment = 0;
+        while (segment + 2 < cameraPath.size() && cameraPath[segment + 1].time <= time)
+        {
+            segment++;
+        }
+
+        const CameraKeyframe& a = cameraPath[segment];
+        const CameraKeyframe& b = cameraPath[segment + 1];
+
+        // Smoothstep between keyframes, so the camera does not jerk at every keyframe
+        float t = (time - a.time) / (b.time - a.time);
+        t = t * t * (3.0f - 2.0f * t);
+
+        engine.setCameraView(lerp(a.position, b.position, t, extent), lerp(a.target, b.target, t, extent));
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////
+    /////////////////////////// CONFIGURATIONS
+    ///////////////////////////////////////////////////////////////////////////////////////////
+
+    struct BenchToggles
+    {
+        int bloom = 0;
+        int ssao = 1;
+        int shadows = 1;
+        int hdr = 1;
+        int oit = 0;    // Weighted blended transparency instead of the sorted transparent pass
+    };
+
+    // Toggles that actually change the work done by a strategy, the others are not worth a run
+    bool toggleMatters(E_RenderStrategy strategy, const std::string& toggle)
+    {
+        if (toggle == "bloom")
+        {
+            return strategy == E_RenderStrategy::ForwardShading;
+        }
+        if (toggle == "ssao")
+        {
+            return strategy == E_RenderStrategy::DeferredShading;
+        }
+        if (toggle == "shadows")
+        {
+            return strategy == E_RenderStrategy::ForwardShading;
+        }
+        if (toggle == "oit")
+        {
+            return strategy == E_RenderStrategy::ForwardShading;
+        }
+        return true;
+    }
+
+    // Defaults first, then either every toggle flipped on its own or every combination
+    std::vector<BenchToggles> benchToggles(E_RenderStrategy strategy, bool fullMatrix)
+    {
+        std::vector<BenchToggles> configurations;
+        BenchToggles defaults;
+        configurations.push_back(defaults);
+
+        if (fullMatrix)
+        {
+            for (int mask = 1; mask < 32; ++mask)
+            {
+                BenchToggles toggles = defaults;
+                if (mask & 1) { if (!toggleMatters(strategy, "bloom"))   continue; toggles.bloom   = 1 - toggles.bloom; }
+                if (mask & 2) { if (!toggleMatters(strategy, "ssao"))    continue; toggles.ssao    = 1 - toggles.ssao; }
+                if (mask & 4) { if (!toggleMatters(strategy, "shadows")) continue; toggles.shadows = 1 - toggles.shadows; }
+                if (mask & 8) { if (!toggleMatters(strategy, "hdr"))     continue; toggles.hdr     = 1 - toggles.hdr; }
+                if (mask & 16){ if (!toggleMatters(strategy, "oit"))     continue; toggles.oit     = 1 - toggles.oit; }
+                configurations.push_back(toggles);
+            }
+            return configurations;
+        }
+
+        if (toggleMatters(strategy, "bloom"))   { BenchToggles t = defaults; t.bloom   = 1 - t.bloom;   configurations.push_back(t); }
+        if (toggleMatters(strategy, "ssao"))    { BenchToggles t = defaults; t.ssao    = 1 - t.ssao;    configurations.push_back(t); }
+        if (toggleMatters(strategy, "shadows")) { BenchToggles t = defaults; t.shadows = 1 - t.shadows; configurations.push_back(t); }
+        if (toggleMatters(strategy, "hdr"))     { BenchToggles t = defaults; t.hdr     = 1 - t.hdr;     configurations.push_back(t); }
+        if (toggleMatters(strategy, "oit"))     { BenchToggles t = defaults; t.oit     = 1 - t.oit;     configurations.push_back(t); }
+
+        return configurations;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////
+    /////////////////////////// RESULTS
+    ///////////////////////////////////////////////////////////////////////////////////////////
+
+    struct BenchRun
+    {
+        std::string scene;
+        E_RenderStrategy strategy;
+        BenchToggles toggles;
+        double startupTime = 0.0;
+        std::vector<float> cpuTimes;
+        std::vector<float> gpuTimes;
+        std::vector<unsigned int> drawCalls;
+        std::vector<float> stateChangesIssued;
+        std::vector<float> stateChangesSkipped;
+        std::map<std::string, float> gpuPassTimes;
+        GeometryStatistics geometry = {};
+    };
+
+    float percentile(std::vector<float> values, float p)
+    {
+        if (values.empty())
+        {
+            return 0.0f;
+        }
+
+        std::sort(values.begin(), values.end());
+        size_t index = static_cast<size_t>(std::ceil(p * static_cast<float>(values.size())));
+        index = std::min(values.size() - 1, index > 0 ? index - 1 : 0);
+        return values[index];
+    }
+
+    float mean(const std::vector<float>& values)
+    {
+        if (values.empty())
+        {
+            return 0.0f;
+        }
+
+        double sum = 0.0;
+        for (float value : values)
+        {
+            sum += value;
+        }
+        return static_cast<float>(sum / static_cast<double>(values.size()));
+    }
+
+    void writeSeriesSummary(std::ostream& out, const std::vector<float>& values)
+    {
+        out << "{\"mean\":" << mean(values)
+            << ",\"p50\":" << percentile(values, 0.50f)
+            << ",\"p95\":" << percentile(values, 0.95f)
+            << ",\"p99\":" << percentile(values, 0.99f)
+            << ",\"max\":" << percentile(values, 1.0f) << "}";
+    }
+
+    template<typename T>
+    void writeArray(std::ostream& out, const std::vector<T>& values)
+    {
+        out << "[";
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            out << (i ? "," : "") << values[i];
+        }
+        out << "]";
+    }
+
+    void writeRun(std::ostream& out, const BenchRun& run)
+    {
+        std::vector<float> drawCalls(run.drawCalls.begin(), run.drawCalls.end());
+
+        out << "    {\"scene\":\"" << run.scene << "\""
+            << ",\"strategy\":\"" << strategyName(run.strategy) << "\""
+            << ",\"settings\":{\"bloom\":" << run.toggles.bloom << ",\"ssao\":" << run.toggles.ssao
+            << ",\"shadows\":" << run.toggles.shadows << ",\"hdr\":" << run.toggles.hdr
+            << ",\"oit\":" << run.toggles.oit << "}"
+            << ",\"startupMs\":" << run.startupTime;
+
+        out << ",\n     \"cpuMs\":";
+        writeSeriesSummary(out, run.cpuTimes);
+        out << ",\n     \"gpuMs\":";
+        writeSeriesSummary(out, run.gpuTimes);
+        out << ",\n     \"drawCalls\":";
+        writeSeriesSummary(out, drawCalls);
+
+        out << ",\n     \"stateChangesIssued\":";
+        writeSeriesSummary(out, run.stateChangesIssued);
+        out << ",\n     \"stateChangesSkipped\":";
+        writeSeriesSummary(out, run.stateChangesSkipped);
+
+        out << ",\n     \"gpuPassMs\":{";
+        bool first = true;
+        for (const auto& pass : run.gpuPassTimes)
+        {
+            out << (first ? "" : ",") << "\"" << pass.first << "\":" << pass.second;
+            first = false;
+        }
+        out << "}";
+
+        const GeometryStatistics& geometry = run.geometry;
+        out << ",\n     \"geometry\":{\"buffers\":" << geometry.bufferCount
+            << ",\"vertexCapacity\":" << geometry.vertexCapacity << ",\"vertexUsed\":" << geometry.vertexUsed
+            << ",\"indexCapacity\":" << geometry.indexCapacity << ",\"indexUsed\":" << geometry.indexUsed
+            << ",\"vertexFragmentation\":" << geometry.vertexFragmentation
+            << ",\"indexFragmentation\":" << geometry.indexFragmentation << "}";
+
+        out << ",\n     \"frames\":{\"cpuMs\":";
+        writeArray(out, run.cpuTimes);
+        out << ",\"gpuMs\":";
+        writeArray(out, run.gpuTimes);
+        out << ",\"drawCalls\":";
+        writeArray(out, run.drawCalls);
+        out << "}}";
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////////////////
+    /////////////////////////// RUNNER
+    ///////////////////////////////////////////////////////////////////////////////////////////
+
+    struct BenchOptions
+    {
+        std::string output = "FluxLuminaBench.json";
+        unsigned int frames = 600;
+        float timestep = 1.0f / 60.0f;
+        int width = 1280;
+        int height = 720;
+        std::vector<std::string> scenes;
+        bool fullMatrix = false;
+        bool software = false;
+        bool gpuCulling = false;
+        bool occlusionCulling = false;  // Runs on the GPU culling pass, enables it too
+        bool levelOfDetail = true;
+    };
+
+    BenchRun runConfiguration(const BenchScene& scene, E_RenderStrategy strategy, const BenchToggles& toggles, const BenchOptions& options)
+    {
+        using clock = std::chrono::steady_clock;
+        auto milliseconds = [](clock::duration d){ return std::chrono::duration<double, std::milli>(d).count(); };
+
+        BenchRun run;
+        run.scene = scene.name;
+        run.strategy = strategy;
+        run.toggles = toggles;
+
+        // Startup covers context creation, asset loading and the first frame, which reserves the strategy's resources
+        clock::time_point startupBegin = clock::now();
+
+        // Throws when the headless context cannot be created
+        FluxLumina engine(strategy, E_ContextMode::Headless);
+
+        std::shared_ptr<Settings> settings = engine.getSettings();
+        settings->set(E_Settings::VSYNC, 0);
+        settings->set(E_Settings::BLOOM, toggles.bloom);
+        settings->set(E_Settings::SSAO, toggles.ssao);
+        settings->set(E_Settings::SHADOW_GLOBAL, toggles.shadows);
+        settings->set(E_Settings::HIGH_DYNAMIC_RANGE, toggles.hdr);
+        settings->set(E_Settings::ORDER_INDEPENDENT_TRANSPARENCY, toggles.oit);
+        settings->set(E_Settings::GPU_PROFILING, 1);
+        settings->set(E_Settings::GPU_CULLING, options.gpuCulling || options.occlusionCulling);
+        settings->set(E_Settings::OCCLUSION_CULLING, options.occlusionCulling);
+        // Before the scene is loaded, the levels are generated at import
+        settings->set(E_Settings::LEVEL_OF_DETAIL, options.levelOfDetail);
+        engine.setRenderStrategy(strategy);
+
+        scene.setup(engine);
+        engine.resize(options.width, options.height);
+
+        applyCameraPath(engine, 0.0f, scene.extent);
+        engine.renderFrames(1);
+
+        run.startupTime = milliseconds(clock::now() - startupBegin);
+
+        const GPUProfiler& gpuProfiler = engine.getStrategyChain()->getGPUProfiler();
+        unsigned int collectedFrames = gpuProfiler.getCollectedFrameCount();
+
+        // GPU results come back a few frames late, keep rendering until the recorded frames are all in
+        unsigned int trailingFrames = GPUProfiler::framesInFlight;
+        for (unsigned int frame = 0; frame < options.frames + trailingFrames; ++frame)
+        {
+            bool recorded = frame < options.frames;
+
+            applyCameraPath(engine, static_cast<float>(frame) * options.timestep, scene.extent);
+
+            // CPU time is the submission cost of the frame, without waiting for the GPU
+            clock::time_point frameBegin = clock::now();
+            engine.submitFrame();
+            double frameTime = milliseconds(clock::now() - frameBegin);
+
+            if (recorded)
+            {
+                run.cpuTimes.push_back(static_cast<float>(frameTime));
+                run.drawCalls.push_back(RenderStatistics::Instance().drawCalls);
+            }
+
+            // The cache reports a frame once the next one starts
+            if (frame > 0 && frame <= options.frames)
+            {
+                run.stateChangesIssued.push_back(static_cast<float>(GLStateCache::Instance().getIssuedCount()));
+                run.stateChangesSkipped.push_back(static_cast<float>(GLStateCache::Instance().getSkippedCount()));
+            }
+
+            if (gpuProfiler.getCollectedFrameCount() != collectedFrames && run.gpuTimes.size() < options.frames)
+            {
+                collectedFrames = gpuProfiler.getCollectedFrameCount();
+                run.gpuTimes.push_back(gpuProfiler.getFrameTime());
+            }
+        }
+
+        run.gpuPassTimes = engine.getGPUPassTimes();
+        run.geometry = engine.getGeometryStatistics();
+
+        return run;
+    }
+
+    std::vector<std::string> split(const std::string& text, char separator)
+    {
+        std::vector<std::string> parts;
+        std::stringstream stream(text);
+        std::string part;
+        while (std::getline(stream, part, separator))
+        {
+            if (!part.empty())
+            {
+                parts.push_back(part);
+            }
+        }
+        return parts;
+    }
+
+    bool parseOptions(int argc, char** argv, BenchOptions& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string argument = argv[i];
+            bool hasValue = i + 1 < argc;
+
+            if (argument == "--output" && hasValue)
+            {
+                options.output = argv[++i];
+            }
+            else if (argument == "--frames" && hasValue)
+            {
+                options.frames = static_cast<unsigned int>(std::stoul(argv[++i]));
+            }
+            else if (argument == "--width" && hasValue)
+            {
+                options.width = std::stoi(argv[++i]);
+            }
+            else if (argument == "--height" && hasValue)
+            {
+                options.height = std::stoi(argv[++i]);
+            }
+            else if (argument == "--scenes" && hasValue)
+            {
+                options.scenes = split(argv[++i], ',');
+            }
+            else if (argument == "--full-matrix")
+            {
+                options.fullMatrix = true;
+            }
+            else if (argument == "--software")
+            {
+                options.software = true;
+            }
+            else if (argument == "--gpu-culling")
+            {
+                options.gpuCulling = true;
+            }
+            else if (argument == "--occlusion-culling")
+            {
+                options.occlusionCulling = true;
+            }
+            else if (argument == "--no-lod")
+            {
+                options.levelOfDetail = false;
+            }
+            else
+            {
+                std::cout << "Unknown argument " << argument << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options))
+    {
+        std::cout << "Usage: FluxLuminaBench [--output file] [--frames n] [--width w] [--height h] "
+                     "[--scenes a,b,...] [--full-matrix] [--software] [--gpu-culling] [--occlusion-culling] [--no-lod]" << std::endl;
+        return 1;
+    }
+
+    // Mesa picks llvmpipe when asked to, must be set before the context exists
+    if (options.software)
+    {
+#ifdef _WIN32
+        _putenv_s("LIBGL_ALWAYS_SOFTWARE", "1");
+#else
+        setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+#endif
+    }
+
+    std::vector<BenchRun> runs;
+
+    for (const BenchScene& scene : benchScenes())
+    {
+        if (!options.scenes.empty() && std::find(options.scenes.begin(), options.scenes.end(), scene.name) == options.scenes.end())
+        {
+            continue;
+        }
+
+        for (E_RenderStrategy strategy : scene.strategies)
+        {
+            for (const BenchToggles& toggles : benchToggles(strategy, options.fullMatrix))
+            {
+                std::cout << "Running " << scene.name << " / " << strategyName(strategy)
+                          << " bloom=" << toggles.bloom << " ssao=" << toggles.ssao
+                          << " shadows=" << toggles.shadows << " hdr=" << toggles.hdr
+                          << " oit=" << toggles.oit << std::endl;
+
+                try
+                {
+                    runs.push_back(runConfiguration(scene, strategy, toggles, options));
+                }
+                catch (const std::runtime_error& error)
+                {
+                    std::cout << error.what() << ", aborting" << std::endl;
+                    return 1;
+                }
+
+                // Enough to compare runs of a scene at a glance, e.g. the sorted and weighted blended transparent passes
+                const BenchRun& run = runs.back();
+                std::cout << "  cpu " << mean(run.cpuTimes) << " ms, gpu " << mean(run.gpuTimes) << " ms";
+                for (const auto& pass : run.gpuPassTimes)
+                {
+                    std::cout << ", " << pass.first << " " << pass.second << " ms";
+                }
+                std::cout << std::endl;
+            }
+        }
+    }
+
+    std::ofstream out(options.output);
+    if (!out.is_open())
+    {
+        std::cout << "Could not open " << options.output << std::endl;
+        return 1;
+    }
+
+    out << std::fixed << std::setprecision(4);
+    out << "{\n  \"frames\":" << options.frames
+        << ",\n  \"timestep\":" << options.timestep
+        << ",\n  \"resolution\":[" << options.width << "," << options.height << "]"
+        << ",\n  \"software\":" << (options.software ? "true" : "false")
+        << ",\n  \"gpuCulling\":" << (options.gpuCulling ? "true" : "false")
+        << ",\n  \"occlusionCulling\":" << (options.occlusionCulling ? "true" : "false")
+        << ",\n  \"levelOfDetail\":" << (options.levelOfDetail ? "true" : "false")
+        << ",\n  \"runs\":[\n";
+
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        writeRun(out, runs[i]);
+        out << (i + 1 < runs.size() ? ",\n" : "\n");
+    }
+
+    out << "  ]\n}\n";
+
+    std::cout << "Results written to " << options.output << std::endl;
+
+    return 0;
+}
@@ -3,9 +3,11 @@
 #include <string>
 #include <array>
 #include <vector>
+#include <map>
 
 // First party includes
 #include "GraphicalEngine.hpp"
+#include "GeometryStatistics.hpp"
 
 // Third party includes
 #include "boost/uuid/uuid.hpp"
@@ -20,16 +22,57 @@ enum class E_RenderStrategy : unsigned int
     PBSShading
 };
 
+enum class E_ContextMode : unsigned int
+{
+    Windowed,   // GLFW window, frames are presented on screen
+    Headless    // Surfaceless EGL context, frames stay in the scene FBO
+};
+
+// One entry of FluxLumina::setTransforms(), the rotation is a quaternion stored w, x, y, z
+struct TransformUpdate
+{
+	unsigned int handle;
+	std::array<float, 3> position;
+	std::array<float, 4> rotation;
+	float scale;
+};
+
 class FluxLumina : public GraphicalEngine
 {
 public:
-	FluxLumina(E_RenderStrategy strategy);
+	// Throws std::runtime_error when the headless context cannot be created
+	FluxLumina(E_RenderStrategy strategy, E_ContextMode mode = E_ContextMode::Windowed);
 
-	int initialize(E_RenderStrategy strategy);
+	int initialize(E_RenderStrategy strategy, E_ContextMode mode = E_ContextMode::Windowed);
 
 	// Update the engine internal state, and render a frame. This is an indefinitely blocking call.
+	// Only available in windowed mode, headless engines are driven by renderFrames().
 	void update();
 
+	// Rebuild the rendering pipeline, also picks up Settings that change its layout (bloom, SSAO, HDR)
+	void setRenderStrategy(E_RenderStrategy strategy);
+
+	// Resize the frame, in headless mode this replaces the window resize
+	void resize(int width, int height);
+
+	// Render a fixed amount of frames and return once the GPU is done with them
+	void renderFrames(unsigned int frameCount);
+
+	// Render a single frame and return as soon as it is submitted, without waiting for the GPU
+	void submitFrame();
+
+	// Read back the color of the last rendered frame as tightly packed RGBA8, bottom row first
+	std::vector<unsigned char> readback();
+
+	// Average GPU time of each node of the rendering strategy over the last frames, in milliseconds
+	std::map<std::string, float> getGPUPassTimes() const;
+
+	// Occupancy and fragmentation of the buffers all the meshes are loaded into
+	GeometryStatistics getGeometryStatistics() const;
+
+	// Dump the recorded CPU zones as a Chrome trace file, empty unless built with FLUXLUMINA_PROFILING
+	bool writeCPUTrace(const std::string& path) const;
+
 	// Adds a model to the bound scene
 	boost::uuids::uuid create_Model(
 		const std::string &modelPath, 
@@ -38,6 +81,18 @@ public:
 		std::array<std::vector<std::string>, 2> textureLocations = {}
 		);
 
+	// Adds count instances of a model to the bound scene, the file is only looked up once
+	std::vector<boost::uuids::uuid> create_Models(
+		const std::string &modelPath,
+		size_t count,
+		const std::string& shader = "Basic",
+		bool flipUVs = false,
+		std::array<std::vector<std::string>, 2> textureLocations = {}
+		);
+
+	// Removes a model from the bound scene, the meshes of its file are unloaded along with the last model using them
+	void remove_Model(boost::uuids::uuid modelID);
+
 	// Add lightsource to the scene
 	boost::uuids::uuid create_LightSource(unsigned int type);
 
@@ -54,10 +109,24 @@ public:
 	void setPosition(boost::uuids::uuid modelID, std::array<float, 3> position);
 	void setRotation(boost::uuids::uuid modelID, std::array<float, 3> rotation);
 	void setScale(boost::uuids::uuid modelID, float scale);
+	// The child then moves with the parent, an unknown parent detaches it
+	void setParent(boost::uuids::uuid childID, boost::uuids::uuid parentID);
+
+	// Bulk transforms, for objects moved every frame.
+	// Handles are resolved once from the ids and stay valid until their object is removed,
+	// an unknown id gets an invalid handle. setTransforms() skips invalid handles, and those of removed objects.
+	std::vector<unsigned int> getTransformHandles(const std::vector<boost::uuids::uuid>& objectIDs);
+	// Replaces position, rotation and scale of each entry, without looking the objects up.
+	// Entries with a non finite value are skipped.
+	void setTransforms(const TransformUpdate* updates, size_t count);
+
+	// Place the active camera and point it at a target
+	void setCameraView(std::array<float, 3> position, std::array<float, 3> target);
 
 	// Sets values for a LightSource
 	void setColor(boost::uuids::uuid lightID, std::array<float, 3> color);
 	void setAttenuationFactors(boost::uuids::uuid lightID, std::array<float, 3> attenuationFactors);
+	// Spot lights are pointed at the given point, directional lights take it as their direction
 	void setDirection(boost::uuids::uuid lightID, std::array<float, 3> direction);
 	void setSpotlightRadius(boost::uuids::uuid lightID, float radius);
 
@@ -0,0 +1,10 @@
+#pragma once
+
+// Occupancy of the shared geometry buffers, fragmentation is 0 when all the free space is one block
+struct GeometryStatistics
+{
+	unsigned int bufferCount;
+	unsigned int vertexCapacity, vertexUsed;
+	unsigned int indexCapacity, indexUsed;
+	float vertexFragmentation, indexFragmentation;
+};
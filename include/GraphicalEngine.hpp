@@ -12,6 +12,8 @@ class FBOManager;
 class ShaderLibrary;
 class LightLibrary;
 class InstancingManager;
+class CullingManager;
+class RenderQueue;
 class StrategyChain;
 class Settings;
 class glfwKeyboardScanner;
@@ -35,14 +37,21 @@ public:
 	std::shared_ptr<ShaderLibrary> getShaderLibrary() { return _shaderPrograms; };
 	std::shared_ptr<LightLibrary> getLightLibrary() { return _lightLibrary; };
 	std::shared_ptr<InstancingManager> getInstancingManager() { return _instancingManager; }
+	std::shared_ptr<CullingManager> getCullingManager() { return _cullingManager; }
+	std::shared_ptr<RenderQueue> getRenderQueue() { return _renderQueue; }
 	std::shared_ptr<StrategyChain> getStrategyChain() { return _strategyChain; }
 	std::shared_ptr<Settings> getSettings() const { return _settings; }
 
 	std::array<int, 2> getViewportSize() const { return { _viewportWidth, _viewportHeight }; }
 
+	// True when rendering without a window, there is no default framebuffer to present to
+	bool isHeadless() const { return _headless; }
+
 protected:
 	int _viewportWidth, _viewportHeight;
 
+	bool _headless;
+
 	std::vector<std::shared_ptr<Scene>> _scenes;
 
 	// SceneObjectFactory
@@ -66,6 +75,12 @@ protected:
 	// Instancing
 	std::shared_ptr<InstancingManager> _instancingManager;
 
+	// Visibility
+	std::shared_ptr<CullingManager> _cullingManager;
+
+	// Draw packets, sorted once per frame
+	std::shared_ptr<RenderQueue> _renderQueue;
+
 	// Rendering strategy
 	std::shared_ptr<StrategyChain> _strategyChain;
 
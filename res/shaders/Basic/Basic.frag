@@ -8,38 +8,17 @@ sampler2D normal;
 sampler2D height;
 };
 
-struct DirLight{
-vec3 direction;
-vec3 ambient;
-vec3 diffuse;
-vec3 specular;
+// Mirrors LightBuffer::GPULight
+struct Light{
+vec4 positionRange;		// xyz position, direction of a directional light, w range
+vec4 color;				// rgb color, w type (0 point, 1 spot, 2 directional)
+vec4 directionCutoff;	// xyz spot direction, w cosine of the outer cutoff
+vec4 attenuation;		// constant, linear, quadratic, w cosine of the inner cutoff
+vec4 shadow;			// x shadow map slot, -1 without one, y far plane of a point light shadow map
+mat4 shadowMatrix;		// Light space of a spot light shadow map
 };
 
-struct PointLight{
-vec3 position;
-vec3 ambient;
-vec3 diffuse;
-vec3 specular;
-float constant;
-float linear;
-float quadratic;
-float farPlane;
-samplerCube shadowMap;
-};
-
-struct SpotLight{
-vec3 position;
-vec3 direction;
-float innerCutOff;
-float outerCutOff;
-vec3 ambient;
-vec3 diffuse;
-vec3 specular;
-float constant;
-float linear;
-float quadratic;
-sampler2D shadowMap;
-};
+const int MAX_SHADOW_CASTERS = 10;
 
 // Inputs from the vertex shader
 in VertexOutput{
@@ -52,10 +31,6 @@ in VertexOutput{
 	vec3 TS_ViewPos;
 } FragmentIn;
 
-in LightSpaceVertexOutput{
-	vec4 Spotlight[10];
-} LightSpaceFragmentIn;
-
 //////////////////////////
 // Uniforms
 //////////////////////////
@@ -68,15 +43,34 @@ uniform int sampleFromNormal;
 uniform int sampleFromHeight;
 
 
-// Directional lights
-uniform int numDirLights;
-uniform DirLight dirLight[3];
-// Point lights
-uniform int numPointLights;
-uniform PointLight pointLight[10];
-// Spot lights
-uniform int numSpotLights;
-uniform SpotLight spotLight[10];
+// Shadow maps, indexed by the shadow slot of the lights, on the units LightLibrary binds them to
+layout(binding = 5) uniform sampler2D spotShadowMaps[MAX_SHADOW_CASTERS];
+layout(binding = 15) uniform samplerCube pointShadowMaps[MAX_SHADOW_CASTERS];
+
+// Directional lights first, then the point and spot lights listed in the clusters
+layout(std430, binding = 8) readonly buffer LightData
+{
+	uvec4 lightCounts;		// x directional lights, y point and spot lights
+	Light lights[];
+};
+
+layout(std430, binding = 9) readonly buffer ClusterGrid
+{
+	uvec4 clusterCounts;	// x, y, z cluster counts
+	vec4 clusterDepth;		// x depth slice scale, y depth slice bias, zw tile size in pixels
+	uvec2 clusterRanges[];	// Offset and count in the index list
+};
+
+layout(std430, binding = 10) readonly buffer ClusterLightIndices
+{
+	uint clusterLightIndices[];
+};
+
+layout(std140) uniform mvp_camera
+{
+	mat4 view;
+	mat4 projection;
+};
 
 layout(std140) uniform viewPosBlock
 {
@@ -153,10 +147,10 @@ vec2 ParallaxMapping(vec2 texCoords, vec3 viewDir)
 	return finalTexCoords;
 }
 
-float PointLightShadowCalculation(int index, vec3 fragPos)
+float PointLightShadowCalculation(int index, float farPlane, vec3 lightPos, vec3 fragPos)
 {
 	// get vector between fragment position and light position
-    vec3 fragToLight = fragPos - pointLight[index].position;
+    vec3 fragToLight = fragPos - lightPos;
     // now get current linear depth as the length between the fragment and light position
     float currentDepth = length(fragToLight);
 
@@ -164,11 +158,11 @@ float PointLightShadowCalculation(int index, vec3 fragPos)
     float bias = 0.15;
     int samples = 20;
     float viewDistance = length(viewPos - fragPos);
-    float diskRadius = (1.0 + (viewDistance / pointLight[index].farPlane)) / 25.0;
+    float diskRadius = (1.0 + (viewDistance / farPlane)) / 25.0;
     for(int i = 0; i < samples; ++i)
     {
-        float closestDepth = texture(pointLight[index].shadowMap, fragToLight + gridSamplingDisk[i] * diskRadius).r;
-        closestDepth *= pointLight[index].farPlane;   // undo mapping [0;1]
+        float closestDepth = texture(pointShadowMaps[index], fragToLight + gridSamplingDisk[i] * diskRadius).r;
+        closestDepth *= farPlane;   // undo mapping [0;1]
         if(currentDepth - bias > closestDepth)
             shadow += 1.0;
     }
@@ -184,7 +178,7 @@ float SpotLightShadowCalculation(int index, vec4 posLightSpace, vec3 normal, vec
 	// Transform to [0,1] range
 	projCoords = projCoords * 0.5 + 0.5;
 	// Get closest depth value from light's perspective (using [0,1] range fragPosLight as coords)
-	float closestDepth = texture(spotLight[index].shadowMap, projCoords.xy).r;
+	float closestDepth = texture(spotShadowMaps[index], projCoords.xy).r;
 	// Get depth of current fragment from light's perspective
 	float currentDepth = projCoords.z;
  	// Remove shadow acne by adding a bias
@@ -198,7 +192,44 @@ float SpotLightShadowCalculation(int index, vec4 posLightSpace, vec3 normal, vec
 	return shadow;
 }
 
-vec3 calcDirLight(DirLight light, vec3 normal, vec3 viewDir, vec2 texCoords)
+// Cluster of the fragment, screen tile from its window position and exponential slice from its view depth
+uint clusterIndex(vec3 fragPos)
+{
+	float viewDepth = -(view * vec4(fragPos, 1.0)).z;
+	uvec3 cluster;
+	cluster.xy = uvec2(gl_FragCoord.xy / clusterDepth.zw);
+	cluster.z = uint(max(log(viewDepth) * clusterDepth.x + clusterDepth.y, 0.0));
+	cluster = min(cluster, clusterCounts.xyz - 1u);
+	return cluster.x + clusterCounts.x * (cluster.y + clusterCounts.y * cluster.z);
+}
+
+// Sampler arrays only take dynamically uniform indices and neighbouring fragments may read different slots,
+// the loop counter is the index instead
+float pointLightShadow(Light light)
+{
+	int slot = int(light.shadow.x);
+	for(int i = 0; i < MAX_SHADOW_CASTERS; i++)
+	{
+		if(i == slot)
+			return PointLightShadowCalculation(i, light.shadow.y, light.positionRange.xyz, FragmentIn.FragPos);
+	}
+	return 0.0;
+}
+
+// The light space position comes from the matrix in the light buffer, the vertex shader does not know the lights
+float spotLightShadow(Light light, vec3 normal, vec3 lightDir)
+{
+	int slot = int(light.shadow.x);
+	vec4 posLightSpace = light.shadowMatrix * vec4(FragmentIn.FragPos, 1.0);
+	for(int i = 0; i < MAX_SHADOW_CASTERS; i++)
+	{
+		if(i == slot)
+			return SpotLightShadowCalculation(i, posLightSpace, normal, lightDir);
+	}
+	return 0.0;
+}
+
+vec3 calcDirLight(Light light, vec3 normal, vec3 viewDir, vec2 texCoords)
 {
 	vec3 diffTex = vec3(0.0);
 	vec3 specTex = vec3(0.0);
@@ -213,20 +244,20 @@ vec3 calcDirLight(DirLight light, vec3 normal, vec3 viewDir, vec2 texCoords)
 	else
 		specTex = FragmentIn.objectColor;
 
-	vec3 lightDir = normalize(-light.direction);
+	vec3 lightDir = normalize(-light.positionRange.xyz);
 	// Diffuse shading
 	float diff = max(dot(normal, lightDir), 0.0);
 	// Specular shading
 	vec3 halfwayDir = normalize(lightDir + viewDir);
 	float spec = pow(max(dot(normal, halfwayDir), 0.0), material.shininess);
 	// Combine results
-	vec3 ambient = light.ambient * diffTex;
-	vec3 diffuse = light.diffuse * diff * diffTex;
-	vec3 specular = light.specular * spec * specTex;
+	vec3 ambient = light.color.rgb * diffTex;
+	vec3 diffuse = light.color.rgb * diff * diffTex;
+	vec3 specular = light.color.rgb * spec * specTex;
 	return (ambient + diffuse + specular);
 }
 
-vec3 calcPointLight(int i, PointLight light, vec3 normal, vec3 FragPos, vec3 viewDir, vec2 texCoords)
+vec3 calcPointLight(Light light, vec3 normal, vec3 FragPos, vec3 viewDir, vec2 texCoords)
 {
 	vec3 diffTex = vec3(0.0);
 	vec3 specTex = vec3(0.0);
@@ -241,33 +272,32 @@ vec3 calcPointLight(int i, PointLight light, vec3 normal, vec3 FragPos, vec3 vie
 	else
 		specTex = FragmentIn.objectColor;
 
-	vec3 lightDir = normalize(light.position - FragPos);
+	vec3 lightPos = light.positionRange.xyz;
+	vec3 lightDir = normalize(lightPos - FragPos);
 	// Diffuse shading
 	float diff = max(dot(normal, lightDir), 0.0);
 	// Specular shading
 	vec3 halfwayDir = normalize(lightDir + viewDir);
 	float spec = pow(max(dot(normal, halfwayDir), 0.0), material.shininess);
 	// Attenuation
-	float distance = length(light.position - FragPos);
-	float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+	float distance = length(lightPos - FragPos);
+	float attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + light.attenuation.z * (distance * distance));
 	// Combine results
-	vec3 ambient = light.ambient * diffTex;
-	vec3 diffuse = light.diffuse * diff * diffTex;
-	vec3 specular = light.specular * spec * specTex;
-	ambient *= attenuation;
+	vec3 diffuse = light.color.rgb * diff * diffTex;
+	vec3 specular = light.color.rgb * spec * specTex;
 	diffuse *= attenuation;
 	specular *= attenuation;
 
 	// Calculate shadow
 	float shadow = 0.0;
-	if(point)
+	if(point && light.shadow.x >= 0.0)
 	{
-		shadow = PointLightShadowCalculation(i, FragmentIn.FragPos);
+		shadow = pointLightShadow(light);
 	}
 	return ( (1.0 - shadow) * (diffuse + specular));
 }
 
-vec3 calcSpotLight(int i, SpotLight light, vec3 normal, vec3 FragPos, vec3 viewDir, vec2 texCoords)
+vec3 calcSpotLight(Light light, vec3 normal, vec3 FragPos, vec3 viewDir, vec2 texCoords)
 {
 
 	vec3 diffTex = vec3(0.0);
@@ -283,11 +313,12 @@ vec3 calcSpotLight(int i, SpotLight light, vec3 normal, vec3 FragPos, vec3 viewD
 	else
 		specTex = FragmentIn.objectColor;
 
-	vec3 lightDir = normalize(light.position - FragPos);
+	vec3 lightPos = light.positionRange.xyz;
+	vec3 lightDir = normalize(lightPos - FragPos);
 
-	float theta = dot(lightDir, normalize(-light.direction));
-	float epsilon = light.innerCutOff - light.outerCutOff;
-	float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+	float theta = dot(lightDir, normalize(-light.directionCutoff.xyz));
+	float epsilon = light.attenuation.w - light.directionCutoff.w;
+	float intensity = clamp((theta - light.directionCutoff.w) / epsilon, 0.0, 1.0);
 
 	// Diffuse shading
 	float diff = max(dot(normal, lightDir), 0.0);
@@ -295,21 +326,19 @@ vec3 calcSpotLight(int i, SpotLight light, vec3 normal, vec3 FragPos, vec3 viewD
 	vec3 halfwayDir = normalize(lightDir + viewDir);
 	float spec = pow(max(dot(normal, halfwayDir), 0.0), material.shininess);
 	// Attenuation
-	float distance = length(light.position - FragPos);
-	float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+	float distance = length(lightPos - FragPos);
+	float attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + light.attenuation.z * (distance * distance));
 	// Combine results
-	vec3 ambient = light.ambient * diffTex;
-	vec3 diffuse = light.diffuse * diff * diffTex;
-	vec3 specular = light.specular * spec * specTex;
-	ambient *= attenuation;
+	vec3 diffuse = light.color.rgb * diff * diffTex;
+	vec3 specular = light.color.rgb * spec * specTex;
 	diffuse *= attenuation * intensity;
 	specular *= attenuation * intensity;
 	
 	// Calculate shadow
 	float shadow = 0.0;
-	if(spot)
+	if(spot && light.shadow.x >= 0.0)
 	{
-		shadow = SpotLightShadowCalculation(i, LightSpaceFragmentIn.Spotlight[i], normal, lightDir);
+		shadow = spotLightShadow(light, normal, lightDir);
 	}
 	return ( (1.0 - shadow) * (diffuse + specular) );
 }
@@ -351,19 +380,19 @@ void main()
 
 
 	// 1 - Directional Lights
-	for(int i = 0; i < numDirLights; i++)
+	for(uint i = 0u; i < lightCounts.x; i++)
 	{
-		totalLight += calcDirLight(dirLight[i], norm, viewDir, texCoords);
+		totalLight += calcDirLight(lights[i], norm, viewDir, texCoords);
 	}
-	// 2 - Point Lights
-	for(int i = 0; i < numPointLights; i++)
+	// 2 - Point and spot lights reaching the cluster of the fragment
+	uvec2 range = clusterRanges[clusterIndex(FragmentIn.FragPos)];
+	for(uint i = range.x; i < range.x + range.y; i++)
 	{
-		totalLight += calcPointLight(i , pointLight[i], norm, FragmentIn.FragPos, viewDir, texCoords);
-	}
-	// 3 - Spot light
-	for(int i = 0; i < numSpotLights; i++)
-	{	
-		totalLight += calcSpotLight(i, spotLight[i], norm, FragmentIn.FragPos, viewDir, texCoords);
+		Light light = lights[clusterLightIndices[i]];
+		if(light.color.w == 0.0)
+			totalLight += calcPointLight(light, norm, FragmentIn.FragPos, viewDir, texCoords);
+		else
+			totalLight += calcSpotLight(light, norm, FragmentIn.FragPos, viewDir, texCoords);
 	}
 
 	fragColor = vec4(totalLight, 1.0);
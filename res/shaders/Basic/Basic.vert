@@ -26,8 +26,6 @@ layout(std140) uniform mvp_camera
 
 uniform int sampleFromNormal;
 uniform int sampleFromHeight;
-uniform int numSpotLights;
-uniform mat4 spotLightSpaceMatrix[10];
 
 // Output
 out VertexOutput{
@@ -40,10 +38,6 @@ out VertexOutput{
 	vec3 TS_ViewPos;
 } VertexOut;
 
-out LightSpaceVertexOutput{
-	vec4 Spotlight[10];
-} LightSpaceVertexOut;
-
 void main()
 {
 	VertexOut.objectColor = aObjectColor;
@@ -51,12 +45,6 @@ void main()
 	VertexOut.TexCoords = aTexCoords;
 	VertexOut.FragPos = vec3(instanceMatrix * vec4(aPosition, 1.0f));
 
-	// Vertex position in worldspace of light i = lightSpaceMatrix * vertex position in worldspace
-	for(int i = 0; i < numSpotLights; i++)
-	{
-		LightSpaceVertexOut.Spotlight[i] = spotLightSpaceMatrix[i] * vec4(VertexOut.FragPos, 1.0);
-	}
-
 	if(sampleFromNormal	== 1 || sampleFromHeight == 1)
 	{
 		vec3 T = normalize(vec3(instanceMatrix * vec4(aTangent,   0.0)));
@@ -10,16 +10,14 @@ sampler2D roughness;    // Roughness in G channel, metallic in B channel
 sampler2D ao;
 };
 
-struct PointLight{
-vec3 position;
-vec3 ambient;
-vec3 diffuse;
-vec3 specular;
-float constant;
-float linear;
-float quadratic;
-float farPlane;
-samplerCube shadowMap;
+// Mirrors LightBuffer::GPULight
+struct Light{
+vec4 positionRange;     // xyz position, direction of a directional light, w range
+vec4 color;             // rgb color, w type (0 point, 1 spot, 2 directional)
+vec4 directionCutoff;   // xyz spot direction, w cosine of the outer cutoff
+vec4 attenuation;       // constant, linear, quadratic, w cosine of the inner cutoff
+vec4 shadow;            // x shadow map slot, -1 without one, y far plane of a point light shadow map
+mat4 shadowMatrix;      // Light space of a spot light shadow map
 };
 
 
@@ -36,8 +34,31 @@ in VertexData{
 
 // Uniforms
 uniform Material material;
-uniform int numPointLights;
-uniform PointLight pointLight[10];
+
+// Directional lights first, then the point and spot lights listed in the clusters
+layout(std430, binding = 8) readonly buffer LightData
+{
+    uvec4 lightCounts;      // x directional lights, y point and spot lights
+    Light lights[];
+};
+
+layout(std430, binding = 9) readonly buffer ClusterGrid
+{
+    uvec4 clusterCounts;    // x, y, z cluster counts
+    vec4 clusterDepth;      // x depth slice scale, y depth slice bias, zw tile size in pixels
+    uvec2 clusterRanges[];  // Offset and count in the index list
+};
+
+layout(std430, binding = 10) readonly buffer ClusterLightIndices
+{
+    uint clusterLightIndices[];
+};
+
+layout(std140) uniform mvp_camera
+{
+    mat4 view;
+    mat4 projection;
+};
 
 uniform samplerCube irradianceMap;
 uniform samplerCube prefilterMap;
@@ -61,6 +82,7 @@ float GeometrySchlickGGX(float NdotV, float roughness);
 float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness);
 vec3 fresnelSchlick(float cosTheta, vec3 F0);
 vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness);
+uint clusterIndex(vec3 fragPos);
 
 void main()
 {
@@ -84,18 +106,30 @@ void main()
 
     // Reflectance equation
     vec3 Lo = vec3(0.0);
-    for(int i = 0; i < numPointLights; i++)
+    uvec2 range = clusterRanges[clusterIndex(fragIn.FragPos)];
+    for(uint i = range.x; i < range.x + range.y; i++)
     {
+        Light light = lights[clusterLightIndices[i]];
+
         // Light vector
-        vec3 L = normalize(pointLight[i].position - fragIn.FragPos);
+        vec3 L = normalize(light.positionRange.xyz - fragIn.FragPos);
 
         // Halfway vector
         vec3 H = normalize(V + L);
 
-        float distance = length(pointLight[i].position - fragIn.FragPos);
-        // float attenuation = 1.0 / (pointLight[i].constant + pointLight[i].linear * distance + pointLight[i].quadratic * (distance * distance));
+        float distance = length(light.positionRange.xyz - fragIn.FragPos);
+        // float attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + light.attenuation.z * (distance * distance));
         float attenuation = 1.0 / (distance * distance);
-        vec3 radiance = pointLight[i].diffuse * attenuation;
+        // Faded out to zero at the range, past it the light is not listed in the cluster
+        float window = clamp(1.0 - pow(distance / light.positionRange.w, 4.0), 0.0, 1.0);
+        attenuation *= window * window;
+        // Spot cone
+        if(light.color.w != 0.0)
+        {
+            float theta = dot(L, normalize(-light.directionCutoff.xyz));
+            attenuation *= clamp((theta - light.directionCutoff.w) / (light.attenuation.w - light.directionCutoff.w), 0.0, 1.0);
+        }
+        vec3 radiance = light.color.rgb * attenuation;
 
         // Cook-Torrance BRDF
         float NDF = DistributionGGX(N, H, roughness);
@@ -177,4 +211,15 @@ vec3 fresnelSchlick(float cosTheta, vec3 F0)
 vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness)
 {
     return F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
-}   
\ No newline at end of file
+}
+
+// Cluster of the fragment, screen tile from its window position and exponential slice from its view depth
+uint clusterIndex(vec3 fragPos)
+{
+    float viewDepth = -(view * vec4(fragPos, 1.0)).z;
+    uvec3 cluster;
+    cluster.xy = uvec2(gl_FragCoord.xy / clusterDepth.zw);
+    cluster.z = uint(max(log(viewDepth) * clusterDepth.x + clusterDepth.y, 0.0));
+    cluster = min(cluster, clusterCounts.xyz - 1u);
+    return cluster.x + clusterCounts.x * (cluster.y + clusterCounts.y * cluster.z);
+}
@@ -17,7 +17,6 @@ layout(std140) uniform viewPosBlock
 {
 	vec3 viewPos;
 };
-uniform mat4 model;
 uniform int sampleFromNormal;
 uniform int sampleFromHeight;
 
@@ -34,19 +33,19 @@ out VertexData{
 
 void main()
 {
-    VertexOut.Normal = mat3(transpose(inverse(model))) * aNormal;
+    VertexOut.Normal = mat3(transpose(inverse(instanceMatrix))) * aNormal;
     VertexOut.TexCoords = aTexCoords;
-    VertexOut.FragPos = vec3(model * vec4(aPosition, 1.0));
+    VertexOut.FragPos = vec3(instanceMatrix * vec4(aPosition, 1.0));
 
     if(sampleFromNormal	== 1 || sampleFromHeight == 1)
 	{
-		vec3 T = normalize(vec3(model * vec4(aTangent,   0.0)));
-		vec3 N = normalize(vec3(model * vec4(aNormal,    0.0)));
+		vec3 T = normalize(vec3(instanceMatrix * vec4(aTangent,   0.0)));
+		vec3 N = normalize(vec3(instanceMatrix * vec4(aNormal,    0.0)));
 		vec3 B = cross(N, T);	
 		VertexOut.TBN = mat3(T, B, N);
 		VertexOut.TS_FragPos = inverse(VertexOut.TBN) * VertexOut.FragPos;
 		VertexOut.TS_ViewPos = inverse(VertexOut.TBN) * viewPos;
-        VertexOut.TS_SphereCenter = inverse(VertexOut.TBN) * model[3].xyz;
+        VertexOut.TS_SphereCenter = inverse(VertexOut.TBN) * instanceMatrix[3].xyz;
 	}
 
     gl_Position = projection * view * vec4(VertexOut.FragPos, 1.0);
@@ -2,11 +2,9 @@
 
 // Input Layout Locations
 layout (location = 0) in vec3 aPos;
-
-// Uniforms
-uniform mat4 model;
+layout (location = 5) in mat4 instanceMatrix;
 
 void main()
 {
-    gl_Position = model * vec4(aPos, 1.0);
+    gl_Position = instanceMatrix * vec4(aPos, 1.0);
 }  
\ No newline at end of file
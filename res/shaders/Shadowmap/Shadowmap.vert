@@ -1,10 +1,10 @@
 #version 430
 layout (location = 0) in vec3 aPos;
+layout (location = 5) in mat4 instanceMatrix;
 
 uniform mat4 lightSpaceMatrix;
-uniform mat4 shadowModel;
 
 void main()
 {
-    gl_Position = lightSpaceMatrix * shadowModel * vec4(aPos, 1.0);
+    gl_Position = lightSpaceMatrix * instanceMatrix * vec4(aPos, 1.0);
 }  
\ No newline at end of file
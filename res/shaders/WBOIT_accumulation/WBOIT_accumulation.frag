@@ -0,0 +1,34 @@
+#version 430
+
+// Weighted blended order-independent transparency (McGuire & Bavoil 2013), accumulation pass.
+// Drawn unsorted with depth writes off, the accumulation target blends with (ONE, ONE)
+// and the revealage target with (ZERO, ONE_MINUS_SRC_COLOR).
+
+struct Material
+{
+sampler2D diffuse;
+};
+
+// Inputs from the vertex shader
+in vec2 TexCoords;
+
+//////////////////////////
+// Uniforms
+//////////////////////////
+uniform Material material;
+
+// Outputs
+layout (location = 0) out vec4 accumulation;
+layout (location = 1) out float revealage;
+
+void main()
+{
+    vec4 color = texture(material.diffuse, TexCoords);
+
+    // Closer and more opaque surfaces weigh more, clamped so that 16 bit floats neither overflow nor underflow
+    float depth = 1.0 - gl_FragCoord.z * 0.9;
+    float weight = clamp(pow(min(1.0, color.a * 10.0) + 0.01, 3.0) * 1e8 * depth * depth * depth, 1e-2, 3e3);
+
+    accumulation = vec4(color.rgb * color.a, color.a) * weight;
+    revealage = color.a;
+}
@@ -0,0 +1,24 @@
+#version 430
+
+// Input Layout Locations
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in vec3 aNormal;
+layout(location = 2) in vec2 aTexCoords;
+layout(location = 3) in vec3 aObjectColor;
+layout(location = 5) in mat4 instanceMatrix;
+
+// Uniforms
+layout(std140) uniform mvp_camera 
+{
+	mat4 view;
+	mat4 projection;
+};
+
+// Outputs
+out vec2 TexCoords;
+
+void main()
+{
+	TexCoords = aTexCoords;
+	gl_Position = projection * view * instanceMatrix * vec4(aPosition, 1.0f);
+}
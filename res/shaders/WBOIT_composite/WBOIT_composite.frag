@@ -0,0 +1,35 @@
+#version 430
+
+// Weighted blended order-independent transparency, composite pass.
+// Blended over the opaque color with (SRC_ALPHA, ONE_MINUS_SRC_ALPHA).
+
+// Inputs
+in vec2 TexCoords;
+
+// Uniforms
+uniform sampler2D accumulation;
+uniform sampler2D revealage;
+
+// Outputs
+layout (location = 0) out vec4 FragColor;
+
+void main()
+{
+    // Product of (1 - alpha) of every transparent fragment, nothing was drawn here when it is still 1
+    float reveal = texture(revealage, TexCoords).r;
+    if(reveal >= 1.0)
+    {
+        discard;
+    }
+
+    vec4 accumulated = texture(accumulation, TexCoords);
+
+    // Too many bright fragments, keep the hue rather than an infinite color
+    if(isinf(max(max(abs(accumulated.r), abs(accumulated.g)), abs(accumulated.b))))
+    {
+        accumulated.rgb = vec3(accumulated.a);
+    }
+
+    vec3 average = accumulated.rgb / max(accumulated.a, 1e-5);
+    FragColor = vec4(average, 1.0 - reveal);
+}
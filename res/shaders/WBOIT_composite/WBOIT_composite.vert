@@ -0,0 +1,14 @@
+#version 430
+
+// Layouts
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoords;
+
+// Outputs
+out vec2 TexCoords;
+
+void main()
+{
+    TexCoords = aTexCoords;
+    gl_Position = vec4(aPos.x,aPos.y, 0.0, 1.0); 
+}  
\ No newline at end of file
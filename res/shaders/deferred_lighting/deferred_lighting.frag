@@ -7,18 +7,6 @@ struct GSamples
     sampler2D albedo;
 };
 
-struct PointLight{
-vec3 position;
-vec3 ambient;
-vec3 diffuse;
-vec3 specular;
-float constant;
-float linear;
-float quadratic;
-float farPlane;
-samplerCube shadowMap;
-};
-
 // Inputs
 in VertexOutput
 {
@@ -30,9 +18,6 @@ in VertexOutput
 uniform	GSamples gData;
 // SSAO data
 uniform sampler2D ssaoOcclusion;
-// Point lights
-uniform int numPointLights;
-uniform PointLight pointLight[32];
 
 layout(std140) uniform viewPosBlock
 {
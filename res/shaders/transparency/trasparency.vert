@@ -5,6 +5,7 @@ layout(location = 0) in vec3 aPosition;
 layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec2 aTexCoords;
 layout(location = 3) in vec3 aObjectColor;
+layout(location = 5) in mat4 instanceMatrix;
 
 // Uniforms
 layout(std140) uniform mvp_camera 
@@ -12,9 +13,8 @@ layout(std140) uniform mvp_camera
 	mat4 view;
 	mat4 projection;
 };
-uniform mat4 model;
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPosition, 1.0f);
+	gl_Position = projection * view * instanceMatrix * vec4(aPosition, 1.0f);
 }
\ No newline at end of file
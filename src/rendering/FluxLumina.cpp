@@ -8,6 +8,7 @@
 #include <scene/Scene.hpp>
 
 #include "scene/SceneObjectFactory.hpp"
+#include "scene/TransformStore.hpp"
 #include "rendering/strategy/StrategyChain.hpp"
 #include "rendering/shader/ShaderLibrary.hpp"
 #include "user_input/glfwUserInputScanner.hpp"
@@ -17,39 +18,71 @@
 #include "rendering/libraries/TextureLibrary.hpp"
 #include "rendering/engineModules/LightManager.hpp"
 #include "rendering/engineModules/InstancingManager.hpp"
+#include "rendering/engineModules/CullingManager.hpp"
+#include "rendering/RenderQueue.hpp"
+#include "rendering/RenderStatistics.hpp"
+#include "rendering/GLStateCache.hpp"
+#include "util/Profiler.hpp"
 
+#include <cmath>
+#include <stdexcept>
 
-FluxLumina::FluxLumina( E_RenderStrategy strategy)
+
+FluxLumina::FluxLumina( E_RenderStrategy strategy, E_ContextMode mode) :
+    _window(nullptr)
 {
-    initialize(strategy);
+    initialize(strategy, mode);
 }
 
-int FluxLumina::initialize(E_RenderStrategy strategy)
+int FluxLumina::initialize(E_RenderStrategy strategy, E_ContextMode mode)
 {
     _scenes.clear();
     _scenes.emplace_back(std::make_shared<Scene>());
     //_scenes.push_back(scene);
 
-    _window = InitializeOpenGLContext();
+    _headless = (mode == E_ContextMode::Headless);
+
+    if(_headless)
+    {
+        _window = nullptr;
+
+        if(!InitializeHeadlessOpenGLContext())
+        {
+            throw std::runtime_error("Could not create a headless OpenGL context");
+        }
+
+        // Offscreen frames keep the size the window would have had
+        _viewportWidth = openGLContext::WINDOW_WIDTH;
+        _viewportHeight = openGLContext::WINDOW_HEIGHT;
+    }
+    else
+    {
+        _window = InitializeOpenGLContext();
+
+        /* Make the window's context current */
+        glfwMakeContextCurrent(_window);
 
-    /* Make the window's context current */
-    glfwMakeContextCurrent(_window);
+        glfwGetWindowSize(_window, &_viewportWidth, &_viewportHeight);
+    }
 
-    glfwGetWindowSize(_window, &_viewportWidth, &_viewportHeight);
+    // Whatever was tracked belongs to a previous context
+    GLStateCache::Instance().invalidate();
 
     /* Set the viewport */
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
     glViewport(0, 0, _viewportWidth, _viewportHeight);
 
-
-    // Set window resize code
-    glfwSetWindowUserPointer(_window, this);
-    auto func = [](GLFWwindow* window, int width, int height)
+    if(!_headless)
     {
-        static_cast<FluxLumina*>(glfwGetWindowUserPointer(window))->resizeWindowCallback(window, width, height);
-    };
-    glfwSetWindowSizeCallback(_window, func);
-    // End window resize code
+        // Set window resize code
+        glfwSetWindowUserPointer(_window, this);
+        auto func = [](GLFWwindow* window, int width, int height)
+        {
+            static_cast<FluxLumina*>(glfwGetWindowUserPointer(window))->resizeWindowCallback(window, width, height);
+        };
+        glfwSetWindowSizeCallback(_window, func);
+        // End window resize code
+    }
 
     // Settings module initialization
     _settings = std::make_shared<Settings>(_window);
@@ -66,7 +99,6 @@ int FluxLumina::initialize(E_RenderStrategy strategy)
     // Shader Library initialization
     _shaderPrograms = std::make_shared<ShaderLibrary>("res/shaders/");
 
-    _shaderPrograms->getShader("Basic")->addSupportedFeature(E_ShaderProgramFeatures::E_AUTO_INSTANCING);
     _shaderPrograms->getShader("transparency")->addSupportedFeature(E_ShaderProgramFeatures::E_TRANSPARENCY);
 
     // Add uniform buffers to the shaders
@@ -87,7 +119,30 @@ int FluxLumina::initialize(E_RenderStrategy strategy)
     // Initialize Instancing Manager
     _instancingManager = std::make_shared<InstancingManager>();
 
+    // Initialize Culling Manager
+    _cullingManager = std::make_shared<CullingManager>(this);
+
+    // Initialize Render Queue
+    _renderQueue = std::make_shared<RenderQueue>(this);
+
     // Initialize Rendering strategy
+    setRenderStrategy(strategy);
+
+    // Initialize User Input, there is nothing to listen to without a window
+    if(!_headless)
+    {
+        _userInput = std::make_shared<glfwKeyboardScanner>(_window);
+        _userInput->bindToScene(_scenes[0]);
+    }
+
+    // SceneObjectFactory initialization
+    _sceneObjectFactory = std::make_shared<SceneObjectFactory>(_scenes[0].get(), this);
+
+    return 1;
+}
+
+void FluxLumina::setRenderStrategy(E_RenderStrategy strategy)
+{
     switch (strategy)
     {
         case E_RenderStrategy::DeferredShading:
@@ -101,20 +156,22 @@ int FluxLumina::initialize(E_RenderStrategy strategy)
             _strategyChain = std::make_shared<ForwardShadingStrategyChain>(this);
             break;
     }
+}
 
-    // Initialize User Input
-    _userInput = std::make_shared<glfwKeyboardScanner>(_window);
-    _userInput->bindToScene(_scenes[0]);
-
-    // SceneObjectFactory initialization
-    _sceneObjectFactory = std::make_shared<SceneObjectFactory>(_scenes[0].get(), this);
-
-    return 1;
+void FluxLumina::resize(int width, int height)
+{
+    resizeWindowCallback(_window, width, height);
 }
 
 // Next step is to encapsulate this in a method that also handles Framebuffer changes
 void FluxLumina::renderFrame(std::shared_ptr<Scene> scene)
 {
+    FLUX_PROFILE_FUNCTION();
+
+    RenderStatistics::Instance().reset();
+    GLStateCache::Instance().beginFrame();
+    TransformStore::Instance().update();
+
     _strategyChain->run();
 }
 
@@ -146,6 +203,12 @@ void FluxLumina::resizeWindowCallback(GLFWwindow* window, int width, int height)
 
 void FluxLumina::update()
 {
+    if(_headless)
+    {
+        std::cout << "FluxLumina::update() requires a window, use renderFrames() in headless mode" << std::endl;
+        return;
+    }
+
     float startTime = static_cast<float>(glfwGetTime());
     float newTime  = 0.0f;
     float gameTime = 0.0f;
@@ -174,6 +237,71 @@ void FluxLumina::update()
     glfwTerminate();
 }
 
+void FluxLumina::renderFrames(unsigned int frameCount)
+{
+    for(unsigned int i = 0; i < frameCount; ++i)
+    {
+        submitFrame();
+    }
+
+    // Make sure the frames are actually done, so that timing the call is meaningful
+    glFinish();
+}
+
+void FluxLumina::submitFrame()
+{
+    renderFrame(_scenes[0]);
+
+    if(!_headless)
+    {
+        glfwSwapBuffers(_window);
+        glfwPollEvents();
+    }
+}
+
+std::vector<unsigned char> FluxLumina::readback()
+{
+    std::vector<unsigned char> pixels;
+
+    std::shared_ptr<FBO> sceneFBO = _frameBuffers->getSceneFBO(_scenes[0]);
+    if(sceneFBO == nullptr)
+    {
+        return pixels;
+    }
+
+    pixels.resize(static_cast<size_t>(_viewportWidth) * static_cast<size_t>(_viewportHeight) * 4);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneFBO->id());
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, _viewportWidth, _viewportHeight, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    return pixels;
+}
+
+bool FluxLumina::writeCPUTrace(const std::string& path) const
+{
+    return profiler::writeChromeTrace(path);
+}
+
+std::map<std::string, float> FluxLumina::getGPUPassTimes() const
+{
+    std::map<std::string, float> passTimes;
+
+    for(const auto& pass : _strategyChain->getGPUProfiler().getPassStatistics())
+    {
+        passTimes[pass.name] = pass.averageTime;
+    }
+
+    return passTimes;
+}
+
+GeometryStatistics FluxLumina::getGeometryStatistics() const
+{
+    return _meshLibrary->getGeometryStatistics();
+}
+
 boost::uuids::uuid FluxLumina::create_Model(
     const std::string &modelPath, 
     const std::string& shader, 
@@ -188,6 +316,41 @@ boost::uuids::uuid FluxLumina::create_Model(
     return _sceneObjectFactory->create_Model(modelPath, shader, flipUVs, textureLocations).id();
 }
 
+std::vector<boost::uuids::uuid> FluxLumina::create_Models(
+    const std::string &modelPath,
+    size_t count,
+    const std::string& shader,
+    bool flipUVs,
+    std::array<std::vector<std::string>, 2> textureLocationStrings
+    )
+{
+    TextureLocations textureLocations = {
+        textureLocationStrings[0],
+        textureLocationStrings[1]
+    };
+
+    std::vector<boost::uuids::uuid> ids;
+    ids.reserve(count);
+    for(const auto& model : _sceneObjectFactory->create_Models(modelPath, count, shader, flipUVs, textureLocations))
+    {
+        ids.push_back(model->id());
+    }
+    return ids;
+}
+
+void FluxLumina::remove_Model(boost::uuids::uuid modelID)
+{
+    std::shared_ptr<ModelObject> model = _scenes[0]->getModel(modelID);
+    if(model == nullptr)
+    {
+        return;
+    }
+
+    const std::string path = model->getModel()->directory;
+    _scenes[0]->remove(modelID);
+    _meshLibrary->removeMeshUser(path);
+}
+
 void FluxLumina::create_Camera()
 {
     _sceneObjectFactory->create_Camera();
@@ -212,22 +375,102 @@ void FluxLumina::create_Skybox(const std::vector<std::string>& path)
 
 void FluxLumina::setPosition(boost::uuids::uuid UUID, std::array<float, 3> position)
 {
-    _scenes[0]->get(UUID)->setPosition(position);
+    std::shared_ptr<SceneObject> object = _scenes[0]->get(UUID);
+
+    if (object != nullptr)
+    {
+        object->setPosition(position);
+    }
 }
 
 void FluxLumina::setRotation(boost::uuids::uuid UUID, std::array<float, 3> rotation)
 {
-    _scenes[0]->get(UUID)->rotate(rotation[0], rotation[1], rotation[2]);
+    std::shared_ptr<SceneObject> object = _scenes[0]->get(UUID);
+
+    if (object != nullptr)
+    {
+        object->rotate(rotation[0], rotation[1], rotation[2]);
+    }
 }
 
 void FluxLumina::setScale(boost::uuids::uuid UUID, float scale)
 {
-    _scenes[0]->get(UUID)->setScale(scale);
+    std::shared_ptr<SceneObject> object = _scenes[0]->get(UUID);
+
+    if (object != nullptr)
+    {
+        object->setScale(scale);
+    }
+}
+
+void FluxLumina::setParent(boost::uuids::uuid childUUID, boost::uuids::uuid parentUUID)
+{
+    std::shared_ptr<SceneObject> child = _scenes[0]->get(childUUID);
+
+    if (child != nullptr)
+    {
+        child->setParent(_scenes[0]->get(parentUUID).get());
+    }
+}
+
+std::vector<unsigned int> FluxLumina::getTransformHandles(const std::vector<boost::uuids::uuid>& objectIDs)
+{
+    TransformStore& transforms = TransformStore::Instance();
+
+    std::vector<unsigned int> handles;
+    handles.reserve(objectIDs.size());
+
+    for(const boost::uuids::uuid& id : objectIDs)
+    {
+        std::shared_ptr<SceneObject> object = _scenes[0]->get(id);
+        handles.push_back(object != nullptr ? transforms.getHandle(object->getTransformHandle()) : TransformStore::none);
+    }
+    return handles;
+}
+
+void FluxLumina::setTransforms(const TransformUpdate* updates, size_t count)
+{
+    FLUX_PROFILE_FUNCTION();
+
+    TransformStore& transforms = TransformStore::Instance();
+
+    for(size_t i = 0; i < count; ++i)
+    {
+        const TransformUpdate& update = updates[i];
+        // Stale handles would otherwise move whatever object got their slot since
+        unsigned int index = transforms.resolve(update.handle);
+        if(index == TransformStore::none)
+        {
+            continue;
+        }
+
+        // A single NaN would spread to the children, the bounds and the culling of the object
+        const std::array<float, 3>& position = update.position;
+        const std::array<float, 4>& rotation = update.rotation;
+        if(!std::isfinite(position[0]) || !std::isfinite(position[1]) || !std::isfinite(position[2]) || !std::isfinite(update.scale) ||
+           !std::isfinite(rotation[0]) || !std::isfinite(rotation[1]) || !std::isfinite(rotation[2]) || !std::isfinite(rotation[3]))
+        {
+            continue;
+        }
+
+        transforms.set(index, position, glm::fquat(rotation[0], rotation[1], rotation[2], rotation[3]), update.scale);
+    }
+}
+
+void FluxLumina::setCameraView(std::array<float, 3> position, std::array<float, 3> target)
+{
+    std::shared_ptr<Camera> camera = _scenes[0]->getActiveCamera();
+
+    if (camera != nullptr)
+    {
+        camera->setPosition(position);
+        camera->lookAt(target);
+    }
 }
 
 void FluxLumina::setColor(boost::uuids::uuid UUID, std::array<float, 3> color)
 {
-    std::shared_ptr<LightSource> light = std::dynamic_pointer_cast<LightSource>(_scenes[0]->get(UUID));
+    std::shared_ptr<LightSource> light = _scenes[0]->getLight(UUID);
 
     if (light != nullptr)
     {
@@ -237,7 +480,7 @@ void FluxLumina::setColor(boost::uuids::uuid UUID, std::array<float, 3> color)
 
 void FluxLumina::setAttenuationFactors(boost::uuids::uuid UUID, std::array<float, 3> attenuationFactors)
 {
-    std::shared_ptr<LightSource> light = std::dynamic_pointer_cast<LightSource>(_scenes[0]->get(UUID));
+    std::shared_ptr<LightSource> light = _scenes[0]->getLight(UUID);
 
     if (light != nullptr)
     {
@@ -247,17 +490,25 @@ void FluxLumina::setAttenuationFactors(boost::uuids::uuid UUID, std::array<float
 
 void FluxLumina::setDirection(boost::uuids::uuid UUID, std::array<float, 3> direction)
 {
-    std::shared_ptr<SpotLight> light = std::dynamic_pointer_cast<SpotLight>(_scenes[0]->get(UUID));
+    std::shared_ptr<SpotLight> light = _scenes[0]->getSpotLight(UUID);
 
     if (light != nullptr)
     {
         light->pointAt(direction);
+        return;
+    }
+
+    std::shared_ptr<DirectionalLight> directionalLight = _scenes[0]->getDirectionalLight(UUID);
+
+    if (directionalLight != nullptr)
+    {
+        directionalLight->setDirection(direction);
     }
 }
 
 void FluxLumina::setSpotlightRadius(boost::uuids::uuid UUID, float radius)
 {
-    std::shared_ptr<SpotLight> light = std::dynamic_pointer_cast<SpotLight>(_scenes[0]->get(UUID));
+    std::shared_ptr<SpotLight> light = _scenes[0]->getSpotLight(UUID);
 
     if (light != nullptr)
     {
@@ -0,0 +1,218 @@
+#include "rendering/GLStateCache.hpp"
+
+GLStateCache::GLStateCache() :
+    _issued(0),
+    _skipped(0),
+    _lastIssued(0),
+    _lastSkipped(0)
+{
+    invalidate();
+}
+
+GLStateCache& GLStateCache::Instance()
+{
+    if (instance == nullptr)
+    {
+        instance = new GLStateCache();
+    }
+    return *instance;
+}
+
+bool GLStateCache::update(GLuint& cached, GLuint value)
+{
+    if(cached == value)
+    {
+        _skipped++;
+        return false;
+    }
+
+    cached = value;
+    _issued++;
+    return true;
+}
+
+void GLStateCache::useProgram(GLuint program)
+{
+    if(update(_program, program))
+    {
+        glUseProgram(program);
+    }
+}
+
+void GLStateCache::activeTexture(GLenum unit)
+{
+    if(update(_activeUnit, unit - GL_TEXTURE0))
+    {
+        glActiveTexture(unit);
+    }
+}
+
+void GLStateCache::bindTexture(GLenum target, GLuint texture)
+{
+    GLuint* cached = nullptr;
+    if(_activeUnit < textureUnits)
+    {
+        if(target == GL_TEXTURE_2D)
+        {
+            cached = &_textures2D[_activeUnit];
+        }
+        else if(target == GL_TEXTURE_CUBE_MAP)
+        {
+            cached = &_texturesCube[_activeUnit];
+        }
+    }
+
+    // Other targets and units are not tracked, always bind
+    if(cached == nullptr)
+    {
+        _issued++;
+        glBindTexture(target, texture);
+        return;
+    }
+
+    if(update(*cached, texture))
+    {
+        glBindTexture(target, texture);
+    }
+}
+
+void GLStateCache::bindVertexArray(GLuint vertexArray)
+{
+    if(update(_vertexArray, vertexArray))
+    {
+        glBindVertexArray(vertexArray);
+    }
+}
+
+void GLStateCache::enable(GLenum capability)
+{
+    auto it = _capabilities.find(capability);
+    if(it != _capabilities.end() && it->second)
+    {
+        _skipped++;
+        return;
+    }
+
+    _capabilities[capability] = true;
+    _issued++;
+    glEnable(capability);
+}
+
+void GLStateCache::disable(GLenum capability)
+{
+    auto it = _capabilities.find(capability);
+    if(it != _capabilities.end() && !it->second)
+    {
+        _skipped++;
+        return;
+    }
+
+    _capabilities[capability] = false;
+    _issued++;
+    glDisable(capability);
+}
+
+void GLStateCache::depthMask(GLboolean flag)
+{
+    if(update(_depthMask, flag))
+    {
+        glDepthMask(flag);
+    }
+}
+
+void GLStateCache::depthFunc(GLenum function)
+{
+    if(update(_depthFunc, function))
+    {
+        glDepthFunc(function);
+    }
+}
+
+void GLStateCache::blendFunc(GLenum source, GLenum destination)
+{
+    if(_blendSource == source && _blendDestination == destination)
+    {
+        _skipped++;
+        return;
+    }
+
+    _blendSource = source;
+    _blendDestination = destination;
+    _issued++;
+    glBlendFunc(source, destination);
+}
+
+void GLStateCache::cullFace(GLenum mode)
+{
+    if(update(_cullFace, mode))
+    {
+        glCullFace(mode);
+    }
+}
+
+void GLStateCache::deleteTextures(GLsizei count, const GLuint* textures)
+{
+    for(GLsizei i = 0; i < count; ++i)
+    {
+        for(unsigned int unit = 0; unit < textureUnits; ++unit)
+        {
+            if(_textures2D[unit] == textures[i])
+            {
+                _textures2D[unit] = 0;
+            }
+            if(_texturesCube[unit] == textures[i])
+            {
+                _texturesCube[unit] = 0;
+            }
+        }
+    }
+
+    glDeleteTextures(count, textures);
+}
+
+void GLStateCache::deleteVertexArrays(GLsizei count, const GLuint* vertexArrays)
+{
+    for(GLsizei i = 0; i < count; ++i)
+    {
+        if(_vertexArray == vertexArrays[i])
+        {
+            _vertexArray = 0;
+        }
+    }
+
+    glDeleteVertexArrays(count, vertexArrays);
+}
+
+void GLStateCache::deleteProgram(GLuint program)
+{
+    // A program in use is only flagged for deletion, its name stays valid until it is replaced
+    if(_program == program)
+    {
+        _program = unknown;
+    }
+
+    glDeleteProgram(program);
+}
+
+void GLStateCache::invalidate()
+{
+    _program = unknown;
+    _activeUnit = unknown;
+    _vertexArray = unknown;
+    _textures2D.fill(unknown);
+    _texturesCube.fill(unknown);
+    _capabilities.clear();
+    _depthMask = unknown;
+    _depthFunc = unknown;
+    _blendSource = unknown;
+    _blendDestination = unknown;
+    _cullFace = unknown;
+}
+
+void GLStateCache::beginFrame()
+{
+    _lastIssued = _issued;
+    _lastSkipped = _skipped;
+    _issued = 0;
+    _skipped = 0;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+// GLFW include
+#include "rendering/GLFW_Wrapper.hpp"
+
+// STL includes
+#include <array>
+#include <unordered_map>
+
+// Tracks the OpenGL state the engine touches and skips the calls that would not change it.
+// Everything that binds programs, textures or VAOs, or flips capabilities, goes through here,
+// otherwise the tracked state would drift from the real one.
+class GLStateCache
+{
+public:
+    static GLStateCache& Instance();
+
+    // Mirrors of the GL calls of the same name
+    void useProgram(GLuint program);
+    void activeTexture(GLenum unit);
+    void bindTexture(GLenum target, GLuint texture);
+    void bindVertexArray(GLuint vertexArray);
+    void enable(GLenum capability);
+    void disable(GLenum capability);
+    void depthMask(GLboolean flag);
+    void depthFunc(GLenum function);
+    void blendFunc(GLenum source, GLenum destination);
+    void cullFace(GLenum mode);
+
+    // GL unbinds deleted objects on its own and reuses their names, the cache has to know
+    void deleteTextures(GLsizei count, const GLuint* textures);
+    void deleteVertexArrays(GLsizei count, const GLuint* vertexArrays);
+    void deleteProgram(GLuint program);
+
+    // Forget all tracked state, the next call of every kind is issued
+    void invalidate();
+
+    // Start counting a new frame, the counts of the previous one remain readable
+    void beginFrame();
+    unsigned int getIssuedCount() const { return _lastIssued; }
+    unsigned int getSkippedCount() const { return _lastSkipped; }
+
+private:
+    GLStateCache();
+    GLStateCache(const GLStateCache&) = delete;
+    GLStateCache& operator=(const GLStateCache&) = delete;
+
+    // Updates the cached value, returns whether the call has to be issued
+    bool update(GLuint& cached, GLuint value);
+
+    static constexpr unsigned int textureUnits = 32;
+    static constexpr GLuint unknown = 0xFFFFFFFF;
+
+    GLuint _program;
+    GLuint _activeUnit;
+    GLuint _vertexArray;
+    std::array<GLuint, textureUnits> _textures2D;
+    std::array<GLuint, textureUnits> _texturesCube;
+    std::unordered_map<GLenum, bool> _capabilities;
+    GLuint _depthMask;
+    GLuint _depthFunc;
+    GLuint _blendSource;
+    GLuint _blendDestination;
+    GLuint _cullFace;
+
+    unsigned int _issued, _skipped;
+    unsigned int _lastIssued, _lastSkipped;
+
+    inline static GLStateCache* instance = nullptr;
+};
@@ -0,0 +1,172 @@
+#include "rendering/GeometryBuffer.hpp"
+
+#include "rendering/GLStateCache.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////// RANGE ALLOCATOR
+///////////////////////////////////////////////////////////////////////////////////////////
+
+RangeAllocator::RangeAllocator(unsigned int capacity) :
+    _capacity(capacity),
+    _used(0)
+{
+    if(capacity > 0)
+    {
+        _freeBlocks[0] = capacity;
+    }
+}
+
+unsigned int RangeAllocator::allocate(unsigned int size)
+{
+    for(auto it = _freeBlocks.begin(); it != _freeBlocks.end(); ++it)
+    {
+        if(it->second < size)
+        {
+            continue;
+        }
+
+        unsigned int offset = it->first;
+        unsigned int remaining = it->second - size;
+        _freeBlocks.erase(it);
+        if(remaining > 0)
+        {
+            _freeBlocks[offset + size] = remaining;
+        }
+
+        _used += size;
+        return offset;
+    }
+
+    return invalid;
+}
+
+void RangeAllocator::release(unsigned int offset, unsigned int size)
+{
+    if(size == 0)
+    {
+        return;
+    }
+
+    _used -= size;
+    auto it = _freeBlocks.emplace(offset, size).first;
+
+    // Merge with the following block
+    auto next = std::next(it);
+    if(next != _freeBlocks.end() && it->first + it->second == next->first)
+    {
+        it->second += next->second;
+        _freeBlocks.erase(next);
+    }
+
+    // Merge with the previous block
+    if(it != _freeBlocks.begin())
+    {
+        auto previous = std::prev(it);
+        if(previous->first + previous->second == it->first)
+        {
+            previous->second += it->second;
+            _freeBlocks.erase(it);
+        }
+    }
+}
+
+unsigned int RangeAllocator::getLargestFreeBlock() const
+{
+    unsigned int largest = 0;
+    for(const auto& block : _freeBlocks)
+    {
+        largest = std::max(largest, block.second);
+    }
+    return largest;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////// GEOMETRY BUFFER
+///////////////////////////////////////////////////////////////////////////////////////////
+
+GeometryBuffer::GeometryBuffer(unsigned int vertexCapacity, unsigned int indexCapacity) :
+    _vertices(vertexCapacity),
+    _indices(indexCapacity)
+{
+    glGenVertexArrays(1, &_VAO);
+    glGenBuffers(1, &_VBO);
+    glGenBuffers(1, &_EBO);
+
+    GLStateCache::Instance().bindVertexArray(_VAO);
+    // Storage only, meshes are uploaded into their own ranges
+    glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertexCapacity) * sizeof(Vertex), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indexCapacity) * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+
+    // set the vertex attribute pointers
+    // vertex Positions
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
+    // vertex normals
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Normal));
+    // vertex texture coords
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, TexCoords));
+    // vertex color info
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Color));
+    // vertex tangent info
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Tangent));
+
+    GLStateCache::Instance().bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+GeometryBuffer::~GeometryBuffer()
+{
+    GLStateCache::Instance().deleteVertexArrays(1, &_VAO);
+    glDeleteBuffers(1, &_VBO);
+    glDeleteBuffers(1, &_EBO);
+}
+
+bool GeometryBuffer::add(Mesh& mesh)
+{
+    unsigned int vertexCount = static_cast<unsigned int>(mesh._vertices.size());
+    unsigned int indexCount = static_cast<unsigned int>(mesh._indices.size());
+
+    unsigned int baseVertex = _vertices.allocate(vertexCount);
+    if(baseVertex == RangeAllocator::invalid)
+    {
+        return false;
+    }
+    unsigned int firstIndex = _indices.allocate(indexCount);
+    if(firstIndex == RangeAllocator::invalid)
+    {
+        _vertices.release(baseVertex, vertexCount);
+        return false;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(baseVertex) * sizeof(Vertex), vertexCount * sizeof(Vertex), mesh._vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // The element buffer binding is VAO state
+    GLStateCache::Instance().bindVertexArray(_VAO);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLintptr>(firstIndex) * sizeof(unsigned int), indexCount * sizeof(unsigned int), mesh._indices.data());
+
+    mesh.VAO = _VAO;
+    mesh.VBO = _VBO;
+    mesh.EBO = _EBO;
+    mesh.baseVertex = baseVertex;
+    mesh.firstIndex = firstIndex;
+
+    return true;
+}
+
+void GeometryBuffer::remove(const Mesh& mesh)
+{
+    _vertices.release(mesh.baseVertex, static_cast<unsigned int>(mesh._vertices.size()));
+    _indices.release(mesh.firstIndex, static_cast<unsigned int>(mesh._indices.size()));
+}
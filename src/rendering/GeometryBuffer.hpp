@@ -0,0 +1,61 @@
+#pragma once
+
+// GLFW include
+#include "rendering/GLFW_Wrapper.hpp"
+
+// STL includes
+#include <map>
+
+// First-party includes
+#include "resources/Mesh.hpp"
+
+// First fit free list over a range of elements, neighbouring free blocks are merged back on release
+class RangeAllocator
+{
+public:
+    static constexpr unsigned int invalid = static_cast<unsigned int>(-1);
+
+    RangeAllocator(unsigned int capacity);
+
+    // Returns the offset of the block, or invalid when no free block is large enough
+    unsigned int allocate(unsigned int size);
+    void release(unsigned int offset, unsigned int size);
+
+    unsigned int getCapacity() const { return _capacity; }
+    unsigned int getUsed() const { return _used; }
+    unsigned int getLargestFreeBlock() const;
+    size_t getFreeBlockCount() const { return _freeBlocks.size(); }
+
+private:
+    unsigned int _capacity;
+    unsigned int _used;
+
+    // Offset -> size
+    std::map<unsigned int, unsigned int> _freeBlocks;
+};
+
+// One VAO over a large vertex and index buffer pair, meshes of the same vertex format live side by side in it
+// and are drawn with their base vertex and first index
+class GeometryBuffer
+{
+public:
+    GeometryBuffer(unsigned int vertexCapacity, unsigned int indexCapacity);
+    ~GeometryBuffer();
+
+    GeometryBuffer(const GeometryBuffer&) = delete;
+    GeometryBuffer& operator=(const GeometryBuffer&) = delete;
+
+    // Uploads the mesh data and fills in its rendering data, false when it does not fit
+    bool add(Mesh& mesh);
+    void remove(const Mesh& mesh);
+
+    GLuint getVAO() const { return _VAO; }
+    const RangeAllocator& getVertices() const { return _vertices; }
+    const RangeAllocator& getIndices() const { return _indices; }
+
+private:
+    GLuint _VAO, _VBO, _EBO;
+
+    RangeAllocator _vertices;
+    RangeAllocator _indices;
+};
@@ -7,6 +7,7 @@
 #include "rendering/shader/ShaderLibrary.hpp"
 #include "rendering/engineModules/LightManager.hpp"
 #include "rendering/engineModules/InstancingManager.hpp"
+#include "rendering/engineModules/CullingManager.hpp"
 #include "rendering/framebuffer/Framebuffer_Manager.hpp"
 #include "rendering/libraries/TextureLibrary.hpp"
 #include "rendering/Settings.hpp"
@@ -14,7 +15,8 @@
 
 
 
-GraphicalEngine::GraphicalEngine()
+GraphicalEngine::GraphicalEngine() :
+    _headless(false)
 {
     ;
 }
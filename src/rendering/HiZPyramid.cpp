@@ -0,0 +1,112 @@
+#include "rendering/HiZPyramid.hpp"
+
+#include "rendering/GLStateCache.hpp"
+#include "rendering/shader/Shader.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    constexpr GLuint buildGroupSize = 8;
+
+    GLuint groupCount(int size)
+    {
+        return (static_cast<GLuint>(size) + buildGroupSize - 1) / buildGroupSize;
+    }
+}
+
+HiZPyramid::HiZPyramid() :
+    _texture(0),
+    _width(0),
+    _height(0),
+    _levels(0),
+    _viewProjection(1.0f),
+    _valid(false)
+{
+    ;
+}
+
+HiZPyramid::~HiZPyramid()
+{
+    if(_texture != 0)
+    {
+        GLStateCache::Instance().deleteTextures(1, &_texture);
+    }
+}
+
+void HiZPyramid::allocate(int width, int height)
+{
+    if(_texture != 0)
+    {
+        GLStateCache::Instance().deleteTextures(1, &_texture);
+    }
+
+    _width = width;
+    _height = height;
+    _levels = 1;
+    for(int size = std::max(width, height); size > 1; size /= 2)
+    {
+        ++_levels;
+    }
+
+    // Immutable storage, the levels are bound one by one as images
+    glGenTextures(1, &_texture);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, _texture);
+    glTexStorage2D(GL_TEXTURE_2D, _levels, GL_R32F, _width, _height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, 0);
+
+    _valid = false;
+}
+
+void HiZPyramid::build(Shader& program, GLuint depthTexture, int width, int height, const glm::mat4& viewProjection)
+{
+    if(width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    if(width != _width || height != _height || _texture == 0)
+    {
+        allocate(width, height);
+    }
+
+    // Level 0 is a copy of the depth texture, every other one reduces the level above it
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, depthTexture);
+    program.setUniform1i("depthTexture", 0);
+
+    int levelWidth = _width;
+    int levelHeight = _height;
+    for(int level = 0; level < _levels; ++level)
+    {
+        program.setUniform1i("level", level);
+        if(level > 0)
+        {
+            glBindImageTexture(0, _texture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        }
+        glBindImageTexture(1, _texture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+        glDispatchCompute(groupCount(levelWidth), groupCount(levelHeight), 1);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+        levelWidth = std::max(levelWidth / 2, 1);
+        levelHeight = std::max(levelHeight / 2, 1);
+    }
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    _viewProjection = viewProjection;
+    _valid = true;
+}
+
+void HiZPyramid::bind(Shader& program, GLuint unit) const
+{
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + unit);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, _texture);
+    program.setUniform1i("hiZ", static_cast<int>(unit));
+    program.setUniformMatrix4fv("occlusionViewProjection", _viewProjection);
+}
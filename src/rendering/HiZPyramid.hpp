@@ -0,0 +1,38 @@
+#pragma once
+
+// GLFW include
+#include "rendering/GLFW_Wrapper.hpp"
+
+// Third-party includes
+#include <glm/glm.hpp>
+
+class Shader;
+
+// Mip chain of the farthest depth under each texel, built from a depth texture.
+// Texel x of level L covers the pixels [x * 2^L, (x + 1) * 2^L) of the depth texture, the last texel of a level
+// also covers the leftover of an odd sized level above it, so any rectangle can be tested against at most 2x2 texels.
+class HiZPyramid
+{
+public:
+    HiZPyramid();
+    ~HiZPyramid();
+
+    // Reduce the depth texture into the pyramid, the program is the HiZBuild compute shader and has to be in use already.
+    // viewProjection is the one the depth was rendered with, it is kept for reprojecting later tests.
+    void build(Shader& program, GLuint depthTexture, int width, int height, const glm::mat4& viewProjection);
+
+    // Sampled from the given texture unit, along with the matrix of the last build
+    void bind(Shader& program, GLuint unit) const;
+
+    // False until the first build, and again when the size changes
+    bool isValid() const { return _valid; }
+    void invalidate() { _valid = false; }
+
+private:
+    void allocate(int width, int height);
+
+    GLuint _texture;
+    int _width, _height, _levels;
+    glm::mat4 _viewProjection;
+    bool _valid;
+};
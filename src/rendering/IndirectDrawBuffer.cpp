@@ -0,0 +1,256 @@
+#include "rendering/IndirectDrawBuffer.hpp"
+
+#include "resources/Mesh.hpp"
+#include "rendering/GLStateCache.hpp"
+#include "rendering/shader/Shader.hpp"
+#include "rendering/HiZPyramid.hpp"
+#include "util/Culling.hpp"
+
+#include <algorithm>
+#include <array>
+#include <string>
+
+namespace
+{
+    // Grow the storage of a buffer when needed, otherwise orphan it so the driver does not wait on the previous frame
+    void reserveBuffer(GLenum target, GLuint buffer, size_t& capacity, size_t size)
+    {
+        glBindBuffer(target, buffer);
+        if(size > capacity)
+        {
+            capacity = std::max(size, capacity * 2);
+        }
+        glBufferData(target, capacity, nullptr, GL_STREAM_DRAW);
+    }
+
+    // Next region of the buffer, filled with the data
+    template <typename T>
+    void streamBuffer(StreamBuffer& buffer, const std::vector<T>& data)
+    {
+        size_t size = data.size() * sizeof(T);
+        buffer.next(size);
+        buffer.write(0, data.data(), size);
+    }
+
+    template <typename T>
+    void bindRange(GLuint index, const StreamBuffer& buffer, const std::vector<T>& data)
+    {
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, index, buffer.id(), buffer.getRegionOffset(), data.size() * sizeof(T));
+    }
+
+    constexpr GLuint cullingGroupSize = 64;
+
+    // Texture unit the depth pyramid is sampled from while culling
+    constexpr GLuint hiZUnit = 0;
+}
+
+IndirectDrawBuffer::IndirectDrawBuffer() :
+    _gpuCulling(false),
+    _twoPhase(false),
+    _secondChanceCapacity(0)
+{
+    glGenBuffers(1, &_secondChanceBuffer);
+
+    // Storage has to exist before any VAO points at the transform buffer
+    _transformBuffer.next(1024 * sizeof(glm::mat4));
+}
+
+IndirectDrawBuffer::~IndirectDrawBuffer()
+{
+    glDeleteBuffers(1, &_secondChanceBuffer);
+}
+
+void IndirectDrawBuffer::clear()
+{
+    _commands.clear();
+    _transforms.clear();
+    _commandBounds.clear();
+}
+
+GLuint IndirectDrawBuffer::addTransforms(const glm::mat4* transforms, unsigned int count)
+{
+    GLuint baseInstance = static_cast<GLuint>(_transforms.size());
+    _transforms.insert(_transforms.end(), transforms, transforms + count);
+    return baseInstance;
+}
+
+unsigned int IndirectDrawBuffer::addCommand(const Mesh& mesh, GLuint instanceCount, GLuint baseInstance, bool cullable)
+{
+    DrawElementsIndirectCommand command;
+    command.count = static_cast<GLuint>(mesh._indices.size());
+    command.instanceCount = instanceCount;
+    command.firstIndex = mesh.firstIndex;
+    command.baseVertex = static_cast<GLint>(mesh.baseVertex);
+    command.baseInstance = baseInstance;
+
+    _commands.push_back(command);
+    _commandBounds.emplace_back(mesh._boundingSphere.center, cullable ? mesh._boundingSphere.radius : -1.0f);
+    return static_cast<unsigned int>(_commands.size() - 1);
+}
+
+void IndirectDrawBuffer::addInstances(unsigned int command, GLuint instanceCount)
+{
+    _commands[command].instanceCount += instanceCount;
+}
+
+void IndirectDrawBuffer::upload(bool gpuCulling, bool twoPhase)
+{
+    _gpuCulling = gpuCulling && !_transforms.empty();
+    _twoPhase = _gpuCulling && twoPhase;
+    if(_commands.empty())
+    {
+        return;
+    }
+
+    // With GPU culling only the compute pass writes the transforms, the late instances go after the early ones
+    const size_t slices = _twoPhase ? 2 : 1;
+    if(_transformBuffer.next(slices * _transforms.size() * sizeof(glm::mat4)))
+    {
+        // A new buffer object, the VAOs still point at the old one
+        _boundVertexArrays.clear();
+    }
+    const GLuint transformBase = static_cast<GLuint>(_transformBuffer.getRegionOffset() / sizeof(glm::mat4));
+
+    _frameCommands.assign(_commands.begin(), _commands.end());
+    for(auto& command : _frameCommands)
+    {
+        command.baseInstance += transformBase;
+    }
+
+    if(!_gpuCulling)
+    {
+        _transformBuffer.write(0, _transforms.data(), _transforms.size() * sizeof(glm::mat4));
+        streamBuffer(_commandBuffer, _frameCommands);
+        return;
+    }
+
+    // The compute pass counts the instances back up from zero
+    _instanceCommands.resize(_transforms.size());
+    for(unsigned int i = 0; i < _commands.size(); ++i)
+    {
+        _frameCommands[i].instanceCount = 0;
+        const DrawElementsIndirectCommand& command = _commands[i];
+        std::fill_n(_instanceCommands.begin() + command.baseInstance, command.instanceCount, i);
+    }
+
+    streamBuffer(_commandBuffer, _frameCommands);
+    streamBuffer(_sourceBuffer, _transforms);
+    streamBuffer(_instanceCommandBuffer, _instanceCommands);
+    streamBuffer(_boundsBuffer, _commandBounds);
+
+    if(!_twoPhase)
+    {
+        return;
+    }
+
+    _lateCommands.assign(_frameCommands.begin(), _frameCommands.end());
+    for(auto& command : _lateCommands)
+    {
+        command.baseInstance += static_cast<GLuint>(_transforms.size());
+    }
+    streamBuffer(_lateCommandBuffer, _lateCommands);
+
+    // Every flag is written by the first phase before the second one reads it
+    reserveBuffer(GL_SHADER_STORAGE_BUFFER, _secondChanceBuffer, _secondChanceCapacity, _transforms.size() * sizeof(GLuint));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void IndirectDrawBuffer::cull(Shader& program, const Frustum& frustum, const HiZPyramid* previousDepth)
+{
+    if(!_gpuCulling)
+    {
+        return;
+    }
+
+    static const std::array<std::string, 6> planeNames = {
+        "frustumPlanes[0]", "frustumPlanes[1]", "frustumPlanes[2]",
+        "frustumPlanes[3]", "frustumPlanes[4]", "frustumPlanes[5]"
+    };
+
+    const auto& planes = frustum.getPlanes();
+    for(size_t i = 0; i < planes.size(); ++i)
+    {
+        program.setUniform4fv(planeNames[i], planes[i]);
+    }
+
+    bool occlusion = _twoPhase && previousDepth != nullptr && previousDepth->isValid();
+    if(occlusion)
+    {
+        previousDepth->bind(program, hiZUnit);
+    }
+    program.setUniform1i("occlusion", occlusion);
+    program.setUniform1i("twoPhase", _twoPhase);
+
+    dispatch(program, 0);
+
+    // The counts are read as draw parameters, the transforms as vertex attributes, the flags by the second phase
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void IndirectDrawBuffer::cullLate(Shader& program, const HiZPyramid& currentDepth)
+{
+    if(!_twoPhase || !currentDepth.isValid())
+    {
+        return;
+    }
+
+    currentDepth.bind(program, hiZUnit);
+    program.setUniform1i("occlusion", true);
+    program.setUniform1i("twoPhase", true);
+
+    dispatch(program, 1);
+
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+}
+
+void IndirectDrawBuffer::dispatch(Shader& program, GLuint phase)
+{
+    GLuint instanceCount = static_cast<GLuint>(_transforms.size());
+    program.setUniform1ui("instanceCount", instanceCount);
+    program.setUniform1ui("transformBase", static_cast<GLuint>(_transformBuffer.getRegionOffset() / sizeof(glm::mat4)));
+    program.setUniform1ui("phase", phase);
+
+    // Only this frame's regions, the transforms are written at the base instance of their command which already covers it
+    bindRange(0, _sourceBuffer, _transforms);
+    bindRange(1, _instanceCommandBuffer, _instanceCommands);
+    bindRange(2, _boundsBuffer, _commandBounds);
+    bindRange(3, _commandBuffer, _frameCommands);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, _transformBuffer.id());
+    if(_twoPhase)
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, _secondChanceBuffer);
+        bindRange(6, _lateCommandBuffer, _lateCommands);
+    }
+
+    glDispatchCompute((instanceCount + cullingGroupSize - 1) / cullingGroupSize, 1, 1);
+}
+
+void IndirectDrawBuffer::bindInstanceAttributes(GLuint vertexArray)
+{
+    if(!_boundVertexArrays.insert(vertexArray).second)
+    {
+        return;
+    }
+
+    GLStateCache::Instance().bindVertexArray(vertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, _transformBuffer.id());
+
+    std::size_t vec4Size = sizeof(glm::vec4);
+    for(GLuint column = 0; column < 4; ++column)
+    {
+        glEnableVertexAttribArray(5 + column);
+        glVertexAttribPointer(5 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(column * vec4Size));
+        glVertexAttribDivisor(5 + column, 1);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void IndirectDrawBuffer::draw(unsigned int firstCommand, unsigned int commandCount, bool late) const
+{
+    const StreamBuffer& commands = late ? _lateCommandBuffer : _commandBuffer;
+    size_t offset = commands.getRegionOffset() + firstCommand * sizeof(DrawElementsIndirectCommand);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commands.id());
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)offset, static_cast<GLsizei>(commandCount), 0);
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+// GLFW include
+#include "rendering/GLFW_Wrapper.hpp"
+
+// First-party includes
+#include "rendering/StreamBuffer.hpp"
+
+// STL includes
+#include <unordered_set>
+#include <vector>
+
+// Third-party includes
+#include <glm/glm.hpp>
+
+class Mesh;
+class Shader;
+class Frustum;
+class HiZPyramid;
+
+// Layout expected by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// Draw commands and per-instance transforms of one frame, uploaded together.
+// The transforms feed the instanceMatrix attribute (locations 5 to 8) with a divisor of 1,
+// each command selects its own slice of them through baseInstance.
+// With GPU culling, the commands go up with no instances and a compute pass appends the visible ones,
+// compacting their transforms at the start of each slice.
+// In two phases, the instances hidden by the previous frame's depth are retested once the pass drew the others,
+// the ones still visible are drawn through a second set of commands pointing past every early transform.
+// Everything the CPU writes goes through StreamBuffers, the commands point at this frame's region of the transforms.
+class IndirectDrawBuffer
+{
+public:
+    IndirectDrawBuffer();
+    ~IndirectDrawBuffer();
+
+    void clear();
+
+    // Returns the base instance of the first transform added
+    GLuint addTransforms(const glm::mat4* transforms, unsigned int count);
+    // Returns the index of the new command, only the instances of cullable commands are tested on the GPU
+    unsigned int addCommand(const Mesh& mesh, GLuint instanceCount, GLuint baseInstance, bool cullable = false);
+    // Grow a command whose transforms were added right after its own
+    void addInstances(unsigned int command, GLuint instanceCount);
+
+    // Instance counts before GPU culling
+    const DrawElementsIndirectCommand& getCommand(unsigned int command) const { return _commands[command]; }
+    size_t getCommandCount() const { return _commands.size(); }
+
+    void upload(bool gpuCulling = false, bool twoPhase = false);
+
+    // Dispatch the culling compute pass over the last upload, its program has to be in use already.
+    // In two phases, the instances hidden by previousDepth are left for cullLate()
+    void cull(Shader& program, const Frustum& frustum, const HiZPyramid* previousDepth = nullptr);
+    // Second phase, against the depth of what the early commands drew
+    void cullLate(Shader& program, const HiZPyramid& currentDepth);
+    bool isTwoPhase() const { return _twoPhase; }
+
+    // Point the instanceMatrix attribute of a VAO at the transform buffer, only done once per VAO
+    void bindInstanceAttributes(GLuint vertexArray);
+
+    // One glMultiDrawElementsIndirect over consecutive commands, the VAO has to be bound already
+    void draw(unsigned int firstCommand, unsigned int commandCount, bool late = false) const;
+
+private:
+    void dispatch(Shader& program, GLuint phase);
+
+    std::vector<DrawElementsIndirectCommand> _commands;
+    std::vector<glm::mat4> _transforms;
+
+    // As uploaded, offset to the region of the transform buffer written this frame.
+    // With GPU culling they go up with no instances
+    std::vector<DrawElementsIndirectCommand> _frameCommands;
+    std::vector<DrawElementsIndirectCommand> _lateCommands;
+
+    // GPU culling inputs, the mesh space sphere of each command and the command of each instance
+    std::vector<glm::vec4> _commandBounds;
+    std::vector<GLuint> _instanceCommands;
+    bool _gpuCulling, _twoPhase;
+
+    StreamBuffer _commandBuffer, _transformBuffer;
+    StreamBuffer _sourceBuffer, _instanceCommandBuffer, _boundsBuffer;
+    StreamBuffer _lateCommandBuffer;
+
+    // Only ever written by the GPU
+    GLuint _secondChanceBuffer;
+    size_t _secondChanceCapacity;
+
+    std::unordered_set<GLuint> _boundVertexArrays;
+};
@@ -3,6 +3,21 @@
 // GLFW include
 #include "rendering/GLFW_Wrapper.hpp"
 
+#include <algorithm>
+
+namespace
+{
+    std::vector<unsigned int> textureSet(const Mesh& mesh)
+    {
+        std::vector<unsigned int> textures;
+        for(const auto& texture : mesh._textures)
+        {
+            textures.push_back(static_cast<unsigned int>(texture._type));
+            textures.push_back(texture._id);
+        }
+        return textures;
+    }
+}
 
 void MeshLibrary::addMesh(const std::string& name, const std::vector<std::shared_ptr<Mesh>>& meshes)
 {
@@ -15,39 +30,129 @@ void MeshLibrary::addMesh(const std::string& name, const std::vector<std::shared
     _meshes[Math::calculateHash(name)].insert(_meshes[Math::calculateHash(name)].end(), meshes.begin(), meshes.end());
 }
 
+void MeshLibrary::removeMesh(const std::string& name)
+{
+    auto it = _meshes.find(Math::calculateHash(name));
+    if(it == _meshes.end())
+    {
+        return;
+    }
+
+    for(auto& mesh : it->second)
+    {
+        releaseMesh(*mesh);
+    }
+
+    _meshes.erase(it);
+    _meshUsers.erase(Math::calculateHash(name));
+}
+
+void MeshLibrary::addMeshUsers(const std::string& name, unsigned int count)
+{
+    _meshUsers[Math::calculateHash(name)] += count;
+}
+
+void MeshLibrary::removeMeshUser(const std::string& name)
+{
+    auto users = _meshUsers.find(Math::calculateHash(name));
+    if(users == _meshUsers.end())
+    {
+        return;
+    }
+
+    if(--users->second == 0)
+    {
+        removeMesh(name);
+    }
+}
+
+void MeshLibrary::releaseMesh(const Mesh& mesh)
+{
+    for(auto& geometryBuffer : _geometryBuffers)
+    {
+        if(geometryBuffer->getVAO() == mesh.VAO)
+        {
+            geometryBuffer->remove(mesh);
+            break;
+        }
+    }
+    releaseMaterial(mesh);
+    _freeMeshIndices.push_back(mesh._index);
+
+    for(const auto& lod : mesh._lods)
+    {
+        releaseMesh(*lod);
+    }
+}
+
 void MeshLibrary::initializeMesh(const std::shared_ptr<Mesh> mesh)
 {
-    // create buffers/arrays
-    glGenVertexArrays(1, &mesh->VAO);
-    glGenBuffers(1, &mesh->VBO);
-    glGenBuffers(1, &mesh->EBO);
-
-    glBindVertexArray(mesh->VAO);
-    // load data into vertex buffers
-    glBindBuffer(GL_ARRAY_BUFFER, mesh->VBO);
-    glBufferData(GL_ARRAY_BUFFER, mesh->_vertices.size() * sizeof(Vertex), &mesh->_vertices[0], GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh->_indices.size() * sizeof(unsigned int), &mesh->_indices[0], GL_STATIC_DRAW);
-
-    // set the vertex attribute pointers
-    // vertex Positions
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
-    // vertex normals
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Normal));
-    // vertex texture coords
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, TexCoords));
-    // vertex color info
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Color));
-    // vertex tangent info
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Tangent));
-
-    glBindVertexArray(0);
+    // The levels of detail live in the geometry buffers like any other mesh
+    for(const auto& lod : mesh->_lods)
+    {
+        initializeMesh(lod);
+    }
+
+    mesh->_material = acquireMaterial(*mesh);
+    mesh->_index = acquireMeshIndex();
+
+    for(auto& geometryBuffer : _geometryBuffers)
+    {
+        if(geometryBuffer->add(*mesh))
+        {
+            return;
+        }
+    }
+
+    // Every buffer is full, start a new one
+    unsigned int vertexCapacity = std::max(vertexBufferCapacity, static_cast<unsigned int>(mesh->_vertices.size()));
+    unsigned int indexCapacity = std::max(indexBufferCapacity, static_cast<unsigned int>(mesh->_indices.size()));
+    _geometryBuffers.push_back(std::make_unique<GeometryBuffer>(vertexCapacity, indexCapacity));
+    _geometryBuffers.back()->add(*mesh);
+}
+
+unsigned int MeshLibrary::acquireMaterial(const Mesh& mesh)
+{
+    auto material = _materials.find(textureSet(mesh));
+    if(material != _materials.end())
+    {
+        ++material->second.meshCount;
+        return material->second.id;
+    }
+
+    unsigned int id = static_cast<unsigned int>(_materials.size());
+    if(!_freeMaterials.empty())
+    {
+        id = _freeMaterials.back();
+        _freeMaterials.pop_back();
+    }
+
+    _materials.emplace(textureSet(mesh), Material{id, 1});
+    return id;
+}
+
+void MeshLibrary::releaseMaterial(const Mesh& mesh)
+{
+    auto material = _materials.find(textureSet(mesh));
+    if(material == _materials.end() || --material->second.meshCount > 0)
+    {
+        return;
+    }
+
+    _freeMaterials.push_back(material->second.id);
+    _materials.erase(material);
+}
+
+unsigned int MeshLibrary::acquireMeshIndex()
+{
+    if(_freeMeshIndices.empty())
+    {
+        return _meshIndexCount++;
+    }
 
+    unsigned int index = _freeMeshIndices.back();
+    _freeMeshIndices.pop_back();
+    return index;
 }
 
 std::vector<std::shared_ptr<Mesh>> MeshLibrary::getMeshes(const std::string& name)
@@ -83,4 +188,30 @@ bool MeshLibrary::isMeshLoaded(const std::string& name)
 void MeshLibrary::addTexture(const Texture& texture)
 {
     _loadedTextures.push_back(texture);
-}
\ No newline at end of file
+}
+
+GeometryStatistics MeshLibrary::getGeometryStatistics() const
+{
+    GeometryStatistics statistics = {};
+    statistics.bufferCount = static_cast<unsigned int>(_geometryBuffers.size());
+
+    unsigned int largestFreeVertices = 0;
+    unsigned int largestFreeIndices = 0;
+    for(const auto& geometryBuffer : _geometryBuffers)
+    {
+        statistics.vertexCapacity += geometryBuffer->getVertices().getCapacity();
+        statistics.vertexUsed += geometryBuffer->getVertices().getUsed();
+        statistics.indexCapacity += geometryBuffer->getIndices().getCapacity();
+        statistics.indexUsed += geometryBuffer->getIndices().getUsed();
+
+        largestFreeVertices = std::max(largestFreeVertices, geometryBuffer->getVertices().getLargestFreeBlock());
+        largestFreeIndices = std::max(largestFreeIndices, geometryBuffer->getIndices().getLargestFreeBlock());
+    }
+
+    unsigned int freeVertices = statistics.vertexCapacity - statistics.vertexUsed;
+    unsigned int freeIndices = statistics.indexCapacity - statistics.indexUsed;
+    statistics.vertexFragmentation = freeVertices > 0 ? 1.0f - static_cast<float>(largestFreeVertices) / freeVertices : 0.0f;
+    statistics.indexFragmentation = freeIndices > 0 ? 1.0f - static_cast<float>(largestFreeIndices) / freeIndices : 0.0f;
+
+    return statistics;
+}
@@ -2,6 +2,7 @@
 
 // STD library includes
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <set>
@@ -10,6 +11,8 @@
 #include "util/Arithmetic.hpp"
 #include "resources/Mesh.hpp"
 #include "resources/Texture.hpp"
+#include "rendering/GeometryBuffer.hpp"
+#include "GeometryStatistics.hpp"
 
 class MeshLibrary
 {
@@ -17,6 +20,11 @@ public:
 
     // Meshes
     void addMesh(const std::string& name, const std::vector<std::shared_ptr<Mesh>>& mesh);
+    // Frees the space of the meshes loaded under this name, no model may use them anymore
+    void removeMesh(const std::string& name);
+    // Models built from the meshes of a name, the meshes are removed along with the last one
+    void addMeshUsers(const std::string& name, unsigned int count = 1);
+    void removeMeshUser(const std::string& name);
 
     void initializeMesh(std::shared_ptr<Mesh> mesh);
 
@@ -27,8 +35,39 @@ public:
     // Textures
     void addTexture(const Texture& texture);
     const std::vector<Texture>& getLoadedTextures();
+
+    GeometryStatistics getGeometryStatistics() const;
+
 private:
+    // Gives back the space of the mesh and of its levels of detail
+    void releaseMesh(const Mesh& mesh);
+
+    // A material is the set of textures bound for a mesh, its id is reused once no mesh has it anymore
+    unsigned int acquireMaterial(const Mesh& mesh);
+    void releaseMaterial(const Mesh& mesh);
+
+    unsigned int acquireMeshIndex();
+
+    // Size of a new geometry buffer, unless a single mesh needs more
+    static constexpr unsigned int vertexBufferCapacity = 1 << 19;
+    static constexpr unsigned int indexBufferCapacity = 1 << 21;
+
     std::map<std::size_t, std::vector<std::shared_ptr<Mesh>>> _meshes;
+    std::map<std::size_t, unsigned int> _meshUsers;
     std::vector<Texture> _loadedTextures;
+
+    struct Material
+    {
+        unsigned int id;
+        unsigned int meshCount;
+    };
+    std::map<std::vector<unsigned int>, Material> _materials;
+    std::vector<unsigned int> _freeMaterials;
+
+    unsigned int _meshIndexCount = 0;
+    std::vector<unsigned int> _freeMeshIndices;
+
+    // All static meshes share these, so draws rarely switch VAO
+    std::vector<std::unique_ptr<GeometryBuffer>> _geometryBuffers;
     
 };
\ No newline at end of file
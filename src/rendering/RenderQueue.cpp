@@ -0,0 +1,293 @@
+#include "rendering/RenderQueue.hpp"
+
+#include "GraphicalEngine.hpp"
+#include "resources/Mesh.hpp"
+#include "rendering/shader/ShaderLibrary.hpp"
+#include "rendering/libraries/TextureLibrary.hpp"
+#include "rendering/GLStateCache.hpp"
+#include "rendering/RenderStatistics.hpp"
+#include "rendering/Settings.hpp"
+#include "rendering/framebuffer/Framebuffer_Manager.hpp"
+#include "scene/Scene.hpp"
+#include "util/RadixSort.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    constexpr unsigned int depthBits = 20;
+    constexpr uint64_t depthMax = (uint64_t(1) << depthBits) - 1;
+}
+
+RenderQueue::RenderQueue(GraphicalEngine* engine) :
+    _maxDepth(1.0f),
+    _ranFrom(engine)
+{
+    _depthOrders.fill(E_DepthOrder::FRONT_TO_BACK);
+    _depthOrders[static_cast<std::size_t>(E_RenderPass::FORWARD_TRANSPARENT)] = E_DepthOrder::BACK_TO_FRONT;
+
+    for(auto& range : _passRanges)
+    {
+        range = {0, 0};
+    }
+}
+
+void RenderQueue::setDepthOrder(E_RenderPass pass, E_DepthOrder order)
+{
+    _depthOrders[static_cast<std::size_t>(pass)] = order;
+}
+
+void RenderQueue::clear(float maxDepth)
+{
+    _packets.clear();
+    _maxDepth = std::max(maxDepth, 1e-6f);
+
+    for(auto& range : _passRanges)
+    {
+        range = {0, 0};
+    }
+}
+
+void RenderQueue::add(E_RenderPass pass, unsigned int shader, const Mesh& mesh, const glm::mat4* model, float distance, unsigned int instanceCount)
+{
+    DrawPacket packet;
+    packet.shader = shader;
+    packet.material = mesh._material;
+    packet.mesh = &mesh;
+    packet.model = model;
+    packet.instanceCount = instanceCount;
+    packet.key = makeKey(pass, shader, packet.material, mesh.VAO, mesh._index, distance);
+
+    _packets.push_back(packet);
+}
+
+uint64_t RenderQueue::makeKey(E_RenderPass pass, unsigned int shader, unsigned int material, unsigned int vertexArray, unsigned int mesh, float distance) const
+{
+    uint64_t depth = static_cast<uint64_t>(std::clamp(distance / _maxDepth, 0.0f, 1.0f) * static_cast<float>(depthMax));
+    uint64_t passBits = static_cast<uint64_t>(pass) & 0xF;
+    uint64_t shaderBits = static_cast<uint64_t>(shader) & 0xFF;
+    uint64_t materialBits = static_cast<uint64_t>(material) & 0xFFFF;
+    // Static meshes share a handful of geometry buffers, the rest of the field groups packets of the same mesh
+    uint64_t geometryBits = ((static_cast<uint64_t>(vertexArray) & 0xF) << 12) | (static_cast<uint64_t>(mesh) & 0xFFF);
+
+    if(_depthOrders[static_cast<std::size_t>(pass)] == E_DepthOrder::BACK_TO_FRONT)
+    {
+        return (passBits << 60) | ((depthMax - depth) << 40) | (shaderBits << 32) | (materialBits << 16) | geometryBits;
+    }
+
+    return (passBits << 60) | (shaderBits << 52) | (materialBits << 36) | (geometryBits << 20) | depth;
+}
+
+void RenderQueue::sort()
+{
+    const unsigned int count = static_cast<unsigned int>(_packets.size());
+
+    _order.resize(count);
+    for(unsigned int i = 0; i < count; ++i)
+    {
+        _order[i] = i;
+    }
+
+    // Equal keys keep their submission order
+    sorting::radixSort(_order, _scratch, 64, [this](unsigned int index){ return _packets[index].key; });
+
+    // Passes sit in the top bits, so each one is a contiguous range
+    for(auto& range : _passRanges)
+    {
+        range = {0, 0};
+    }
+    for(unsigned int i = 0; i < count; ++i)
+    {
+        auto& range = _passRanges[_packets[_order[i]].key >> 60];
+        if(range[1] == 0)
+        {
+            range[0] = i;
+        }
+        range[1] = i + 1;
+    }
+
+    buildIndirectCommands();
+}
+
+void RenderQueue::buildIndirectCommands()
+{
+    const unsigned int count = static_cast<unsigned int>(_packets.size());
+    const bool gpuCulling = _ranFrom->getSettings()->getGPUCulling() == E_Setting::ON;
+    const bool occlusionCulling = gpuCulling && _ranFrom->getSettings()->getOcclusionCulling() == E_Setting::ON;
+
+    _indirect.clear();
+    _commands.resize(count);
+
+    // Consecutive instanced packets of the same mesh and state share a command, their transforms end up contiguous
+    const DrawPacket* previous = nullptr;
+    for(unsigned int i = 0; i < count; ++i)
+    {
+        const DrawPacket& packet = _packets[_order[i]];
+        if(packet.instanceCount == 0)
+        {
+            previous = nullptr;
+            continue;
+        }
+
+        GLuint baseInstance = _indirect.addTransforms(packet.model, packet.instanceCount);
+
+        if(
+            previous != nullptr &&
+            previous->mesh == packet.mesh &&
+            previous->shader == packet.shader &&
+            previous->material == packet.material &&
+            (previous->key >> 60) == (packet.key >> 60)
+            )
+        {
+            _indirect.addInstances(_commands[i - 1], packet.instanceCount);
+            _commands[i] = _commands[i - 1];
+        }
+        else
+        {
+            // Shadow casters are already selected per light, only the camera passes are culled
+            E_RenderPass pass = static_cast<E_RenderPass>(packet.key >> 60);
+            bool cullable = pass == E_RenderPass::FORWARD_OPAQUE || pass == E_RenderPass::DEFERRED_GEOMETRY;
+            _commands[i] = _indirect.addCommand(*packet.mesh, packet.instanceCount, baseInstance, cullable);
+        }
+
+        previous = &packet;
+    }
+
+    _indirect.upload(gpuCulling, occlusionCulling);
+
+    if(gpuCulling)
+    {
+        std::shared_ptr<ShaderLibrary> shaderLibrary = _ranFrom->getShaderLibrary();
+        unsigned int cullingShader = shaderLibrary->getShaderIndex("GPUCulling");
+        shaderLibrary->use(cullingShader);
+        _indirect.cull(*shaderLibrary->getShader(cullingShader), _ranFrom->getScene()->getActiveCamera()->getFrustum(), &_depthPyramid);
+    }
+}
+
+void RenderQueue::submit(E_RenderPass pass)
+{
+    submitRange(pass, true);
+}
+
+void RenderQueue::submitGeometry(E_RenderPass pass)
+{
+    submitRange(pass, false);
+}
+
+void RenderQueue::submitOccluded(E_RenderPass pass)
+{
+    if(!_indirect.isTwoPhase())
+    {
+        return;
+    }
+
+    std::shared_ptr<ShaderLibrary> shaderLibrary = _ranFrom->getShaderLibrary();
+    std::shared_ptr<Scene> scene = _ranFrom->getScene();
+    std::shared_ptr<FBO> fbo = _ranFrom->getFBOManager()->getSceneFBO(scene);
+    const std::shared_ptr<Camera>& camera = scene->getActiveCamera();
+
+    unsigned int buildShader = shaderLibrary->getShaderIndex("HiZBuild");
+    shaderLibrary->use(buildShader);
+    _depthPyramid.build(*shaderLibrary->getShader(buildShader), fbo->getDepthTextureID(),
+        static_cast<int>(fbo->getOriginalSize()[0]), static_cast<int>(fbo->getOriginalSize()[1]),
+        camera->getProjectionMatrix() * camera->getViewMatrix());
+
+    unsigned int cullingShader = shaderLibrary->getShaderIndex("GPUCulling");
+    shaderLibrary->use(cullingShader);
+    _indirect.cullLate(*shaderLibrary->getShader(cullingShader), _depthPyramid);
+
+    submitRange(pass, true, true);
+}
+
+void RenderQueue::submitRange(E_RenderPass pass, bool applyMaterials, bool late)
+{
+    std::shared_ptr<ShaderLibrary> shaderLibrary = _ranFrom->getShaderLibrary();
+    std::shared_ptr<TextureLibrary> textureLibrary = _ranFrom->getTextureLibrary();
+
+    const auto& range = _passRanges[static_cast<std::size_t>(pass)];
+
+    const unsigned int none = static_cast<unsigned int>(-1);
+    unsigned int currentShader = none;
+    unsigned int currentMaterial = none;
+    const glm::mat4* currentModel = nullptr;
+
+    unsigned int i = range[0];
+    while(i < range[1])
+    {
+        const DrawPacket& packet = _packets[_order[i]];
+
+        // Regular draws have no second chance, nothing may be bound for them
+        if(packet.instanceCount == 0 && late)
+        {
+            ++i;
+            continue;
+        }
+
+        if(applyMaterials && packet.shader != currentShader)
+        {
+            shaderLibrary->use(packet.shader);
+            currentShader = packet.shader;
+            // Uniforms belong to the program, they have to be set again
+            currentMaterial = none;
+            currentModel = nullptr;
+        }
+
+        if(applyMaterials && packet.material != currentMaterial)
+        {
+            textureLibrary->bindTextures(*packet.mesh);
+            currentMaterial = packet.material;
+        }
+
+        if(packet.instanceCount == 0)
+        {
+            // Meshes of the same model usually follow each other
+            if(packet.model != nullptr && packet.model != currentModel)
+            {
+                shaderLibrary->setUniformMat4("model", *packet.model);
+                currentModel = packet.model;
+            }
+
+            GLStateCache::Instance().bindVertexArray(packet.mesh->VAO);
+            glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<int>(packet.mesh->_indices.size()), GL_UNSIGNED_INT,
+                (void*)(packet.mesh->firstIndex * sizeof(unsigned int)), static_cast<int>(packet.mesh->baseVertex));
+            RenderStatistics::Instance().addDrawCall();
+
+            ++i;
+            continue;
+        }
+
+        // Every following instanced packet with the same program, textures and VAO goes in the same multi-draw
+        unsigned int end = i + 1;
+        while(end < range[1])
+        {
+            const DrawPacket& next = _packets[_order[end]];
+            if(
+                next.instanceCount == 0 ||
+                next.shader != packet.shader ||
+                next.material != packet.material ||
+                next.mesh->VAO != packet.mesh->VAO
+                )
+            {
+                break;
+            }
+            ++end;
+        }
+
+        _indirect.bindInstanceAttributes(packet.mesh->VAO);
+        GLStateCache::Instance().bindVertexArray(packet.mesh->VAO);
+
+        unsigned int firstCommand = _commands[i];
+        unsigned int commandCount = _commands[end - 1] - firstCommand + 1;
+        _indirect.draw(firstCommand, commandCount, late);
+
+        unsigned int instanceCount = 0;
+        for(unsigned int command = firstCommand; command < firstCommand + commandCount; ++command)
+        {
+            instanceCount += _indirect.getCommand(command).instanceCount;
+        }
+        // The second chance instances are only counted on the GPU
+        RenderStatistics::Instance().addDrawCall(late ? 0 : instanceCount);
+
+        i = end;
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+// STL includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Third-party includes
+#include <glm/glm.hpp>
+
+// First-party includes
+#include "rendering/IndirectDrawBuffer.hpp"
+#include "rendering/HiZPyramid.hpp"
+
+class GraphicalEngine;
+class Mesh;
+
+// Passes are sorted in this order, so their packets end up contiguous
+enum class E_RenderPass : unsigned int
+{
+    SHADOW,
+    FORWARD_OPAQUE,
+    DEFERRED_GEOMETRY,
+    FORWARD_TRANSPARENT,
+    COUNT
+};
+
+enum class E_DepthOrder : unsigned int
+{
+    FRONT_TO_BACK,  // State changes first, depth only breaks ties
+    BACK_TO_FRONT   // Depth first, state changes only break ties
+};
+
+// Everything the backend needs to issue one draw call
+struct DrawPacket
+{
+    uint64_t key;
+    unsigned int shader;            // Index in the ShaderLibrary
+    unsigned int material;          // Meshes sharing a texture set share a material
+    const Mesh* mesh;
+    const glm::mat4* model;         // Regular draws set it as the "model" uniform, instanced ones read instanceCount contiguous matrices
+    unsigned int instanceCount;     // 0 for a regular draw, instanced draws go through the indirect buffer
+};
+
+class RenderQueue
+{
+public:
+    RenderQueue(GraphicalEngine* engine);
+
+    void setDepthOrder(E_RenderPass pass, E_DepthOrder order);
+
+    // Start a new frame, distances are normalized by maxDepth (usually the camera far plane)
+    void clear(float maxDepth);
+
+    void add(E_RenderPass pass, unsigned int shader, const Mesh& mesh, const glm::mat4* model, float distance, unsigned int instanceCount = 0);
+
+    // Radix sort of every packet added this frame, then upload of the indirect commands
+    void sort();
+
+    // Issue the draws of one pass, in key order
+    void submit(E_RenderPass pass);
+    // Same without touching programs or textures, for depth only passes whose caller sets up the program
+    void submitGeometry(E_RenderPass pass);
+    // With occlusion culling, once the pass is drawn: reduce its depth into a pyramid, then draw the instances
+    // the previous frame's pyramid hid but this one does not. Does nothing otherwise
+    void submitOccluded(E_RenderPass pass);
+
+    const std::vector<DrawPacket>& getPackets() const { return _packets; }
+
+private:
+    void buildIndirectCommands();
+    // The late commands are the second chance of occlusion culling, only instanced packets have one
+    void submitRange(E_RenderPass pass, bool applyMaterials, bool late = false);
+
+    // Key layout, from the most significant bit:
+    //  FRONT_TO_BACK:  pass (4) | shader (8) | material (16) | VAO (4) | mesh (12) | depth (20)
+    //  BACK_TO_FRONT:  pass (4) | inverted depth (20) | shader (8) | material (16) | VAO (4) | mesh (12)
+    uint64_t makeKey(E_RenderPass pass, unsigned int shader, unsigned int material, unsigned int vertexArray, unsigned int mesh, float distance) const;
+
+    std::array<E_DepthOrder, static_cast<std::size_t>(E_RenderPass::COUNT)> _depthOrders;
+    std::array<std::array<unsigned int, 2>, static_cast<std::size_t>(E_RenderPass::COUNT)> _passRanges;
+
+    float _maxDepth;
+
+    // Packets of the frame and their sorted order, _scratch holds the other half of every radix pass
+    std::vector<DrawPacket> _packets;
+    std::vector<unsigned int> _order;
+    std::vector<unsigned int> _scratch;
+
+    // Instanced packets, the indirect command of every sorted packet
+    IndirectDrawBuffer _indirect;
+    std::vector<unsigned int> _commands;
+
+    // Depth of the last pass culled in two phases, kept for reprojection by the next frame
+    HiZPyramid _depthPyramid;
+
+    // The engine currently running this queue
+    GraphicalEngine* _ranFrom;
+};
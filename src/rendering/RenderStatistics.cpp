@@ -0,0 +1,31 @@
+#include "rendering/RenderStatistics.hpp"
+
+RenderStatistics::RenderStatistics() :
+    drawCalls(0),
+    instances(0),
+    culledModels(0)
+{
+    ;
+}
+
+RenderStatistics& RenderStatistics::Instance()
+{
+    if (instance == nullptr)
+    {
+        instance = new RenderStatistics();
+    }
+    return *instance;
+}
+
+void RenderStatistics::reset()
+{
+    drawCalls = 0;
+    instances = 0;
+    culledModels = 0;
+}
+
+void RenderStatistics::addDrawCall(unsigned int instanceCount)
+{
+    drawCalls++;
+    instances += instanceCount;
+}
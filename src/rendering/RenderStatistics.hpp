@@ -0,0 +1,23 @@
+#pragma once
+
+// Counts the work submitted to the GPU, reset at the start of every frame
+class RenderStatistics
+{
+public:
+    static RenderStatistics& Instance();
+
+    void reset();
+    void addDrawCall(unsigned int instanceCount = 1);
+
+    unsigned int drawCalls;
+    unsigned int instances;
+    // Models left out of the camera pass by the CullingManager
+    unsigned int culledModels;
+
+private:
+    RenderStatistics();
+    RenderStatistics(const RenderStatistics&) = delete;
+    RenderStatistics& operator=(const RenderStatistics&) = delete;
+
+    inline static RenderStatistics* instance = nullptr;
+};
@@ -2,6 +2,7 @@
 
 // First-party headers
 #include "rendering/GLFW_Wrapper.hpp"
+#include "rendering/GLStateCache.hpp"
 
 #include "rendering/shader/ShaderLibrary.hpp"
 
@@ -25,10 +26,19 @@ Settings::Settings(GLFWwindow* _window)    :
     _seamlessCubemapSampling(E_Setting::ON),
     _vSync(E_Setting::ON),
     _polygonMode(E_PolygonMode::FILL),
-    _graphicalDebugOutput(E_Setting::OFF)
+    _graphicalDebugOutput(E_Setting::OFF),
+    _gpuProfiling(E_Setting::ON),
+    _frustumCulling(E_Setting::ON),
+    _gpuCulling(E_Setting::OFF),
+    _occlusionCulling(E_Setting::OFF),
+    _levelOfDetail(E_Setting::ON),
+    _orderIndependentTransparency(E_Setting::OFF)
 {
-    /* Make the window's context current */
-    glfwMakeContextCurrent(_window);
+    /* Make the window's context current, headless contexts are already current */
+    if(_window)
+    {
+        glfwMakeContextCurrent(_window);
+    }
     
     // Initializer list is not enough because some of these 
     // involve also calling some functions
@@ -47,11 +57,20 @@ Settings::Settings(GLFWwindow* _window)    :
     set(E_Settings::VSYNC, 1);
     set(E_Settings::POLYGON_LINES, 0);
     set(E_Settings::GRAPHICAL_DEBUG_OUTPUT, 0);
+    set(E_Settings::GPU_PROFILING, 1);
+    set(E_Settings::FRUSTUM_CULLING, 1);
+    set(E_Settings::GPU_CULLING, 0);
+    set(E_Settings::OCCLUSION_CULLING, 0);
+    set(E_Settings::LEVEL_OF_DETAIL, 1);
+    set(E_Settings::ORDER_INDEPENDENT_TRANSPARENCY, 0);
 }
 
 void Settings::set(E_Settings setting, int value)
 {
-    glfwMakeContextCurrent(_window);
+    if(_window)
+    {
+        glfwMakeContextCurrent(_window);
+    }
 
     switch (setting)
     {
@@ -74,58 +93,58 @@ void Settings::set(E_Settings setting, int value)
         _antiAliasing = static_cast<E_Setting>(value);
         if(value)
         {
-            glEnable(GL_MULTISAMPLE);
+            GLStateCache::Instance().enable(GL_MULTISAMPLE);
         }
         else
         {
-            glDisable(GL_MULTISAMPLE);
+            GLStateCache::Instance().disable(GL_MULTISAMPLE);
         }
         break;
     case E_Settings::TRANSPARENCY:
         _transparency = static_cast<E_Setting>(value);
         if(value)
         {
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            GLStateCache::Instance().enable(GL_BLEND);
+            GLStateCache::Instance().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         }
         else
         {
-            glDisable(GL_BLEND);
+            GLStateCache::Instance().disable(GL_BLEND);
         }
         break;
     case E_Settings::GAMMA_CORRECTION:
         _gammaCorrection = static_cast<E_Setting>(value);
         if(value)
         {
-            glEnable(GL_FRAMEBUFFER_SRGB); 
+            GLStateCache::Instance().enable(GL_FRAMEBUFFER_SRGB); 
         }
         else
         {
-            glDisable(GL_FRAMEBUFFER_SRGB); 
+            GLStateCache::Instance().disable(GL_FRAMEBUFFER_SRGB); 
         }
         break;
     case E_Settings::FACE_CULLING:
         _faceCulling = static_cast<E_Setting>(value);
         if(value)
         {
-            glEnable(GL_CULL_FACE);
-            glCullFace(GL_BACK);
+            GLStateCache::Instance().enable(GL_CULL_FACE);
+            GLStateCache::Instance().cullFace(GL_BACK);
         }
         else
         {
-            glDisable(GL_CULL_FACE);
+            GLStateCache::Instance().disable(GL_CULL_FACE);
         }
         break;
     case E_Settings::DEPTH_TEST:
         _depthTest = static_cast<E_Setting>(value);
         if(value)
         {
-            glEnable(GL_DEPTH_TEST);
-            glDepthFunc(GL_LESS);
+            GLStateCache::Instance().enable(GL_DEPTH_TEST);
+            GLStateCache::Instance().depthFunc(GL_LESS);
         }
         else
         {
-            glDisable(GL_DEPTH_TEST);
+            GLStateCache::Instance().disable(GL_DEPTH_TEST);
         }
         break;
     case E_Settings::NORMAL_MAPPING:
@@ -147,15 +166,20 @@ void Settings::set(E_Settings setting, int value)
         _seamlessCubemapSampling = static_cast<E_Setting>(value);
         if(value)
         {
-            glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);  
+            GLStateCache::Instance().enable(GL_TEXTURE_CUBE_MAP_SEAMLESS);  
         }
         else
         {
-            glDisable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+            GLStateCache::Instance().disable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
         }
         break;
     case E_Settings::VSYNC:
         _vSync = static_cast<E_Setting>(value);
+        if(!_window)
+        {
+            // Nothing is presented, there is no swap interval to set
+            break;
+        }
         if(value)
         {
             glfwSwapInterval(1);
@@ -186,17 +210,41 @@ void Settings::set(E_Settings setting, int value)
         _graphicalDebugOutput = static_cast<E_Setting>(value);
         if(value)
         {
-            glEnable(GL_DEBUG_OUTPUT);
-            glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+            GLStateCache::Instance().enable(GL_DEBUG_OUTPUT);
+            GLStateCache::Instance().enable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
             //glDebugMessageCallback(MessageCallback, 0);
         }
         else
         {
-            glDisable(GL_DEBUG_OUTPUT);
-            glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+            GLStateCache::Instance().disable(GL_DEBUG_OUTPUT);
+            GLStateCache::Instance().disable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
         }
         break;
 
+    case E_Settings::GPU_PROFILING:
+        _gpuProfiling = static_cast<E_Setting>(value);
+        break;
+
+    case E_Settings::FRUSTUM_CULLING:
+        _frustumCulling = static_cast<E_Setting>(value);
+        break;
+
+    case E_Settings::GPU_CULLING:
+        _gpuCulling = static_cast<E_Setting>(value);
+        break;
+
+    case E_Settings::OCCLUSION_CULLING:
+        _occlusionCulling = static_cast<E_Setting>(value);
+        break;
+
+    case E_Settings::LEVEL_OF_DETAIL:
+        _levelOfDetail = static_cast<E_Setting>(value);
+        break;
+
+    case E_Settings::ORDER_INDEPENDENT_TRANSPARENCY:
+        _orderIndependentTransparency = static_cast<E_Setting>(value);
+        break;
+
     default:
         break;
     }
@@ -295,4 +343,34 @@ E_PolygonMode Settings::getPolygonMode() const
 E_Setting Settings::getGLDebugOutput() const
 {
     return _graphicalDebugOutput;
-}
\ No newline at end of file
+}
+
+E_Setting Settings::getGPUProfiling() const
+{
+    return _gpuProfiling;
+}
+
+E_Setting Settings::getFrustumCulling() const
+{
+    return _frustumCulling;
+}
+
+E_Setting Settings::getGPUCulling() const
+{
+    return _gpuCulling;
+}
+
+E_Setting Settings::getOcclusionCulling() const
+{
+    return _occlusionCulling;
+}
+
+E_Setting Settings::getLevelOfDetail() const
+{
+    return _levelOfDetail;
+}
+
+E_Setting Settings::getOrderIndependentTransparency() const
+{
+    return _orderIndependentTransparency;
+}
@@ -2,7 +2,7 @@
 
 class GLFWwindow;
 
-enum class E_Settings{SHADOW_QUALITY_GLOBAL,SHADOW_GLOBAL, SHADOW_DIRECTIONAL, SHADOW_POINT, SHADOW_SPOT, ANTI_ALIASING_QUALITY, TRANSPARENCY, GAMMA_CORRECTION, FACE_CULLING, DEPTH_TEST, NORMAL_MAPPING, HEIGHT_MAPPING, HIGH_DYNAMIC_RANGE, BLOOM, SSAO, SEAMLESS_CUBEMAP_SAMPLING, VSYNC, POLYGON_LINES, GRAPHICAL_DEBUG_OUTPUT};
+enum class E_Settings{SHADOW_QUALITY_GLOBAL,SHADOW_GLOBAL, SHADOW_DIRECTIONAL, SHADOW_POINT, SHADOW_SPOT, ANTI_ALIASING_QUALITY, TRANSPARENCY, GAMMA_CORRECTION, FACE_CULLING, DEPTH_TEST, NORMAL_MAPPING, HEIGHT_MAPPING, HIGH_DYNAMIC_RANGE, BLOOM, SSAO, SEAMLESS_CUBEMAP_SAMPLING, VSYNC, POLYGON_LINES, GRAPHICAL_DEBUG_OUTPUT, GPU_PROFILING, FRUSTUM_CULLING, GPU_CULLING, OCCLUSION_CULLING, LEVEL_OF_DETAIL, ORDER_INDEPENDENT_TRANSPARENCY};
 
 enum class E_Setting{OFF, ON};
 enum class E_ShadowQuality_Global{LOW, MEDIUM, HIGH, ULTRA};
@@ -34,6 +34,12 @@ public:
     E_Setting getvSync() const;
     E_PolygonMode getPolygonMode() const;
     E_Setting getGLDebugOutput() const;
+    E_Setting getGPUProfiling() const;
+    E_Setting getFrustumCulling() const;
+    E_Setting getGPUCulling() const;
+    E_Setting getOcclusionCulling() const;
+    E_Setting getLevelOfDetail() const;
+    E_Setting getOrderIndependentTransparency() const;
 
 private:
     GLFWwindow* _window;
@@ -57,5 +63,11 @@ private:
     E_Setting _vSync;
     E_PolygonMode _polygonMode;
     E_Setting _graphicalDebugOutput;
+    E_Setting _gpuProfiling;
+    E_Setting _frustumCulling;
+    E_Setting _gpuCulling;
+    E_Setting _occlusionCulling;
+    E_Setting _levelOfDetail;
+    E_Setting _orderIndependentTransparency;
     
 };
\ No newline at end of file
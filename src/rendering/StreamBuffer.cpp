@@ -0,0 +1,134 @@
+#include "rendering/StreamBuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // Covers the offset alignment of uniform, storage and vertex bindings on every implementation
+    constexpr size_t regionAlignment = 256;
+
+    // One second per try, it only loops when the GPU is that far behind
+    constexpr GLuint64 fenceTimeout = 1000000000;
+}
+
+StreamBuffer::StreamBuffer() :
+    _buffer(0),
+    _persistent(GLAD_GL_VERSION_4_4 != 0),
+    _mapping(nullptr),
+    _regionSize(0),
+    _region(0)
+{
+    _fences.fill(nullptr);
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    release();
+}
+
+void StreamBuffer::allocate(size_t regionSize)
+{
+    _regionSize = (std::max(regionSize, regionAlignment) + regionAlignment - 1) / regionAlignment * regionAlignment;
+    _region = 0;
+
+    glGenBuffers(1, &_buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+
+    if(!_persistent)
+    {
+        glBufferData(GL_COPY_WRITE_BUFFER, _regionSize, nullptr, GL_STREAM_DRAW);
+        return;
+    }
+
+    // Not coherent, write() flushes what it copied
+    const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT;
+    glBufferStorage(GL_COPY_WRITE_BUFFER, regionCount * _regionSize, nullptr, access);
+    _mapping = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, regionCount * _regionSize, access | GL_MAP_FLUSH_EXPLICIT_BIT));
+}
+
+void StreamBuffer::release()
+{
+    for(GLsync& fence : _fences)
+    {
+        if(fence != nullptr)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    if(_buffer == 0)
+    {
+        return;
+    }
+
+    // The GL keeps the storage alive until the commands still reading it are done
+    if(_mapping != nullptr)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        _mapping = nullptr;
+    }
+    glDeleteBuffers(1, &_buffer);
+    _buffer = 0;
+}
+
+bool StreamBuffer::next(size_t size)
+{
+    if(size > _regionSize || _buffer == 0)
+    {
+        size_t regionSize = std::max(size, _regionSize * 2);
+        release();
+        allocate(regionSize);
+        return true;
+    }
+
+    if(!_persistent)
+    {
+        // Orphaning, the driver hands out fresh storage while the GPU reads the old one
+        glBindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, _regionSize, nullptr, GL_STREAM_DRAW);
+        return false;
+    }
+
+    // One call per frame, every command reading the current region was issued before this one
+    _fences[_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _region = (_region + 1) % regionCount;
+
+    GLsync& fence = _fences[_region];
+    if(fence != nullptr)
+    {
+        GLenum status;
+        do
+        {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, fenceTimeout);
+        } while(status == GL_TIMEOUT_EXPIRED);
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    return false;
+}
+
+void StreamBuffer::write(size_t offset, const void* data, size_t size)
+{
+    if(size == 0)
+    {
+        return;
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+
+    if(!_persistent)
+    {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+        return;
+    }
+
+    size_t start = getRegionOffset() + offset;
+    std::memcpy(_mapping + start, data, size);
+    glFlushMappedBufferRange(GL_COPY_WRITE_BUFFER, start, size);
+    // Without coherent mapping the writes are only guaranteed visible to commands issued after this barrier
+    glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+// GLFW include
+#include "rendering/GLFW_Wrapper.hpp"
+
+// STL includes
+#include <array>
+#include <cstddef>
+
+// Buffer the CPU fills again every frame, split in regions used in turn so that writing one frame
+// never waits on the GPU reading the previous ones.
+// With buffer storage (GL 4.4) it stays persistently mapped, a fence per region tells when it can be written again,
+// and only the written bytes are flushed. Older contexts get a single region, orphaned on every frame.
+class StreamBuffer
+{
+public:
+    // The GPU may still be reading the two frames before this one
+    static constexpr unsigned int regionCount = 3;
+
+    StreamBuffer();
+    ~StreamBuffer();
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // Moves to the next region and makes sure it holds size bytes, waiting for the GPU to be done with it first.
+    // Returns true when growing replaced the buffer object, whatever pointed at the old one has to point at the new one
+    bool next(size_t size);
+    // Copies to the current region, offset is relative to the region
+    void write(size_t offset, const void* data, size_t size);
+
+    GLuint id() const { return _buffer; }
+    // In bytes from the start of the buffer, always a multiple of 256 so any binding accepts it
+    size_t getRegionOffset() const { return _persistent ? _region * _regionSize : 0; }
+    size_t getRegionSize() const { return _regionSize; }
+
+private:
+    void allocate(size_t regionSize);
+    void release();
+
+    GLuint _buffer;
+    bool _persistent;
+    unsigned char* _mapping;
+
+    size_t _regionSize;
+    unsigned int _region;
+    std::array<GLsync, regionCount> _fences;
+};
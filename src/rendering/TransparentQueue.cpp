@@ -0,0 +1,60 @@
+#include "rendering/TransparentQueue.hpp"
+
+#include "rendering/RenderQueue.hpp"
+#include "resources/Mesh.hpp"
+#include "util/RadixSort.hpp"
+
+#include <algorithm>
+
+void TransparentQueue::clear(float maxDepth)
+{
+    _records.clear();
+    _maxDepth = std::max(maxDepth, 1e-6f);
+}
+
+void TransparentQueue::add(unsigned int shader, const Mesh& mesh, const glm::mat4* transform, float distance, bool instanced)
+{
+    const double normalized = std::clamp(distance / _maxDepth, 0.0f, 1.0f);
+    const uint32_t depth = static_cast<uint32_t>(normalized * static_cast<double>(UINT32_MAX));
+
+    _records.push_back({UINT32_MAX - depth, shader, &mesh, transform, distance, instanced});
+}
+
+void TransparentQueue::sort()
+{
+    // Records at the same depth keep their submission order
+    sorting::radixSort(_records, _scratch, 32, [](const Record& record){ return record.depth; });
+}
+
+void TransparentQueue::emit(RenderQueue& queue)
+{
+    sort();
+
+    // Sized once so that the packets can point into it
+    _transforms.resize(_records.size());
+
+    size_t transformCount = 0;
+    size_t i = 0;
+    while(i < _records.size())
+    {
+        const Record& first = _records[i];
+        if(!first.instanced)
+        {
+            queue.add(E_RenderPass::FORWARD_TRANSPARENT, first.shader, *first.mesh, first.transform, first.distance);
+            ++i;
+            continue;
+        }
+
+        // Instances drawn by one call are blended in order, a run only merges records already next to each other
+        size_t end = i;
+        const size_t runStart = transformCount;
+        while(end < _records.size() && _records[end].instanced && _records[end].shader == first.shader && _records[end].mesh == first.mesh)
+        {
+            _transforms[transformCount++] = *_records[end].transform;
+            ++end;
+        }
+
+        queue.add(E_RenderPass::FORWARD_TRANSPARENT, first.shader, *first.mesh, &_transforms[runStart], first.distance, static_cast<unsigned int>(end - i));
+        i = end;
+    }
+}
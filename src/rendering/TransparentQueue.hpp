@@ -0,0 +1,49 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+#include <vector>
+
+// Third-party includes
+#include <glm/glm.hpp>
+
+class Mesh;
+class RenderQueue;
+
+// Back to front ordering of the transparent meshes of one frame, at mesh and instance granularity.
+// Every mesh instance is a record sorted by its quantized view depth, then consecutive records of the same
+// instanced shader and mesh are merged back into a single instanced draw.
+class TransparentQueue
+{
+public:
+    // Start a new frame, distances are normalized by maxDepth (usually the camera far plane)
+    void clear(float maxDepth);
+
+    // transform has to stay valid until the packets are drawn, instanced shaders read it as instanceMatrix
+    void add(unsigned int shader, const Mesh& mesh, const glm::mat4* transform, float distance, bool instanced);
+
+    // Radix sort of the records, farthest first, then one FORWARD_TRANSPARENT packet per run
+    void emit(RenderQueue& queue);
+
+    size_t size() const { return _records.size(); }
+
+private:
+    struct Record
+    {
+        uint32_t depth;                 // Inverted, the farthest record has the smallest one
+        unsigned int shader;
+        const Mesh* mesh;
+        const glm::mat4* transform;
+        float distance;
+        bool instanced;
+    };
+
+    void sort();
+
+    float _maxDepth = 1.0f;
+
+    std::vector<Record> _records;
+    std::vector<Record> _scratch;
+    // Transforms of the instanced runs, contiguous per run
+    std::vector<glm::mat4> _transforms;
+};
@@ -0,0 +1,194 @@
+#include "rendering/engineModules/CullingManager.hpp"
+
+#include "GraphicalEngine.hpp"
+#include "rendering/Settings.hpp"
+#include "rendering/RenderStatistics.hpp"
+#include "util/Arithmetic.hpp"
+#include "util/Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    constexpr float DEG_TO_RAD = 3.14159265358979323846f / 180.0f;
+
+    // Without attenuation the range is infinite, or NaN
+    float shadowRange(const LightSource& light)
+    {
+        float range = light.calculateMaxRange();
+        return std::isfinite(range) ? range : std::numeric_limits<float>::max();
+    }
+
+    // Coarsest level whose error stays under the threshold once projected.
+    // Refining waits until the current error is past threshold * (1 + hysteresis),
+    // coarsening until the next error is under threshold * (1 - hysteresis).
+    unsigned int selectLevel(const Mesh& mesh, unsigned int current, float pixelsPerUnit, float threshold, float hysteresis)
+    {
+        const unsigned int last = static_cast<unsigned int>(mesh.getLodCount() - 1);
+        current = std::min(current, last);
+
+        if(mesh.getLod(current)._lodError * pixelsPerUnit > threshold * (1.0f + hysteresis))
+        {
+            while(current > 0 && mesh.getLod(current)._lodError * pixelsPerUnit > threshold)
+            {
+                --current;
+            }
+            return current;
+        }
+
+        while(current < last && mesh.getLod(current + 1)._lodError * pixelsPerUnit <= threshold * (1.0f - hysteresis))
+        {
+            ++current;
+        }
+        return current;
+    }
+}
+
+CullingManager::CullingManager(GraphicalEngine* engine) :
+    _visibleCount(0),
+    _shadowCasterCount(0),
+    _ranFrom(engine)
+{
+    ;
+}
+
+void CullingManager::update(Scene& scene)
+{
+    FLUX_PROFILE_FUNCTION();
+
+    scene.refreshSpatialIndex();
+    selectLevelsOfDetail(scene);
+
+    const bool cull = _ranFrom->getSettings()->getFrustumCulling() == E_Setting::ON;
+    const auto& models = scene.getModels();
+
+    for(const auto& model : models)
+    {
+        model->setVisible(!cull && model->enabled());
+        model->setCastsShadow(!cull && model->enabled());
+    }
+
+    if(!cull)
+    {
+        _visibleCount = _shadowCasterCount = models.size();
+        return;
+    }
+
+    // The index answers with boxes around the bounding spheres, the spheres themselves are tested four at a time
+    _candidates.clear();
+    scene.getSpatialIndex().queryFrustum(scene.getActiveCamera()->getFrustum(), _candidates, sceneObjectMask(E_SceneObjectType::MODEL));
+
+    _x.clear();
+    _y.clear();
+    _z.clear();
+    _radii.clear();
+    for(SceneObject* candidate : _candidates)
+    {
+        BoundingSphere bounds = candidate->getWorldBounds();
+        _x.push_back(bounds.center.x);
+        _y.push_back(bounds.center.y);
+        _z.push_back(bounds.center.z);
+        _radii.push_back(bounds.radius);
+    }
+
+    _visible.resize(_candidates.size());
+    culling::frustumSpheres(scene.getActiveCamera()->getFrustum(), _x.data(), _y.data(), _z.data(), _radii.data(), _candidates.size(), _visible.data());
+
+    _visibleCount = 0;
+    for(size_t i = 0; i < _candidates.size(); ++i)
+    {
+        ModelObject* model = static_cast<ModelObject*>(_candidates[i]);
+        if(_visible[i] && model->enabled())
+        {
+            model->setVisible(true);
+            ++_visibleCount;
+        }
+    }
+
+    findShadowCasters(scene);
+
+    RenderStatistics::Instance().culledModels += static_cast<unsigned int>(models.size() - _visibleCount);
+}
+
+void CullingManager::findShadowCasters(Scene& scene)
+{
+    std::shared_ptr<Settings> settings = _ranFrom->getSettings();
+    _shadowCasterCount = 0;
+
+    if(settings->getShadowGlobal() != E_Setting::ON)
+    {
+        return;
+    }
+
+    // Only models within reach of a shadow casting light are drawn in the shadow maps
+    const SpatialIndex& index = scene.getSpatialIndex();
+    const uint32_t modelMask = sceneObjectMask(E_SceneObjectType::MODEL);
+    const LightContents& lights = scene.getAllLights();
+
+    _candidates.clear();
+    if(settings->getShadowPoint() == E_Setting::ON)
+    {
+        for(const auto& light : lights.pointLights)
+        {
+            index.querySphere({light->getWorldBounds().center, shadowRange(*light)}, _candidates, modelMask);
+        }
+    }
+    if(settings->getShadowSpot() == E_Setting::ON)
+    {
+        // An occluder outside the cone can only shadow places the light does not reach
+        for(const auto& light : lights.spotLights)
+        {
+            index.queryCone(light->getWorldBounds().center, conversion::toVec3(light->getDirection()), light->getCutoff()[1] * DEG_TO_RAD, shadowRange(*light), _candidates, modelMask);
+        }
+    }
+
+    for(SceneObject* candidate : _candidates)
+    {
+        ModelObject* model = static_cast<ModelObject*>(candidate);
+        if(!model->castsShadow() && model->enabled())
+        {
+            model->setCastsShadow(true);
+            ++_shadowCasterCount;
+        }
+    }
+}
+
+void CullingManager::selectLevelsOfDetail(Scene& scene)
+{
+    FLUX_PROFILE_FUNCTION();
+
+    const bool enabled = _ranFrom->getSettings()->getLevelOfDetail() == E_Setting::ON;
+    std::shared_ptr<Camera> camera = scene.getActiveCamera();
+
+    // Pixels covered by one unit, seen at a distance of one
+    const float pixelScale = camera->getProjectionMatrix()[1][1] * 0.5f * static_cast<float>(_ranFrom->getViewportSize()[1]);
+    const glm::vec3& viewPosition = camera->getPosition();
+
+    for(const auto& model : scene.getModels())
+    {
+        if(!model->enabled())
+        {
+            continue;
+        }
+
+        const auto& meshes = model->getModel()->meshes;
+        const size_t meshCount = std::min(meshes.size(), model->getMeshLodCount());
+        for(size_t i = 0; i < meshCount; ++i)
+        {
+            const Mesh& mesh = *meshes[i];
+            if(!enabled || mesh.getLodCount() == 1)
+            {
+                model->setMeshLod(i, 0);
+                continue;
+            }
+
+            // The errors scale with the mesh, like its radius does
+            BoundingSphere bounds = mesh._boundingSphere.transformed(model->getMeshMatrix(i));
+            float scale = mesh._boundingSphere.radius > 0.0f ? bounds.radius / mesh._boundingSphere.radius : 1.0f;
+            float distance = std::max(glm::length(bounds.center - viewPosition) - bounds.radius, 1e-3f);
+            model->setMeshLod(i, selectLevel(mesh, model->getMeshLod(i), scale * pixelScale / distance, lodPixelError, lodHysteresis));
+        }
+    }
+}
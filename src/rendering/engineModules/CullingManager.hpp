@@ -0,0 +1,49 @@
+#pragma once
+
+// First party includes
+#include "scene/Scene.hpp"
+#include "util/Culling.hpp"
+
+// STL includes
+#include <cstdint>
+#include <vector>
+
+class GraphicalEngine;
+
+// Decides once per frame, before the render queue is built, which models reach the camera pass
+// and which ones can cast a shadow. The result is stored on each ModelObject.
+// Candidates come from the scene's SpatialIndex, so only the models near the frustum and the lights are tested.
+// It also picks the level of detail of every mesh, from the size its simplification error takes on screen.
+class CullingManager
+{
+public:
+    CullingManager(GraphicalEngine* engine);
+
+    void update(Scene& scene);
+
+    size_t getVisibleCount() const { return _visibleCount; }
+    size_t getShadowCasterCount() const { return _shadowCasterCount; }
+
+private:
+    // Projected error, in pixels, a level of detail may reach
+    static constexpr float lodPixelError = 1.0f;
+    // Fraction of the threshold a mesh must go past before changing level, so it does not flicker on the boundary
+    static constexpr float lodHysteresis = 0.25f;
+
+    void findShadowCasters(Scene& scene);
+    // Every enabled model, the GPU may still draw the ones culled here
+    void selectLevelsOfDetail(Scene& scene);
+
+    // Objects returned by the spatial queries
+    std::vector<SceneObject*> _candidates;
+
+    // World bounds of the frustum candidates, one array per component
+    std::vector<float> _x, _y, _z, _radii;
+    std::vector<uint8_t> _visible;
+
+    size_t _visibleCount;
+    size_t _shadowCasterCount;
+
+    // The engine currently running this manager
+    GraphicalEngine* _ranFrom;
+};
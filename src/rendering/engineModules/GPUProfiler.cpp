@@ -0,0 +1,180 @@
+#include "rendering/engineModules/GPUProfiler.hpp"
+
+// GLFW include
+#include "rendering/GLFW_Wrapper.hpp"
+
+// STL includes
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////// GPU PASS STATISTICS
+///////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+    unsigned int bucketOf(float time)
+    {
+        const auto& limits = GPUPassStatistics::bucketLimits;
+        return static_cast<unsigned int>(std::lower_bound(limits.begin(), limits.end(), time) - limits.begin());
+    }
+}
+
+void GPUPassStatistics::addSample(float time)
+{
+    // Evict the oldest sample once the window is full
+    if(historySize == historyLength)
+    {
+        histogram[bucketOf(history[historyIndex])]--;
+    }
+    else
+    {
+        historySize++;
+    }
+
+    history[historyIndex] = time;
+    historyIndex = (historyIndex + 1) % historyLength;
+    histogram[bucketOf(time)]++;
+
+    lastTime = time;
+    maxTime = 0.0f;
+    float sum = 0.0f;
+    for(unsigned int i = 0; i < historySize; ++i)
+    {
+        sum += history[i];
+        maxTime = std::max(maxTime, history[i]);
+    }
+    averageTime = sum / static_cast<float>(historySize);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////// GPU PROFILER
+///////////////////////////////////////////////////////////////////////////////////////////
+
+GPUProfiler::GPUProfiler() :
+    _frameIndex(0),
+    _lastFrameTime(0.0f),
+    _collectedFrames(0)
+{
+    ;
+}
+
+GPUProfiler::~GPUProfiler()
+{
+    for(auto& frame : _frames)
+    {
+        if(!frame.queries.empty())
+        {
+            glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+        }
+    }
+}
+
+unsigned int GPUProfiler::registerPass(const std::string& name)
+{
+    // Chains hold several nodes of the same type, sharing a pass would mix their samples
+    unsigned int occurrence = ++_nameCounts[name];
+    std::string passName = occurrence == 1 ? name : name + " #" + std::to_string(occurrence);
+
+    unsigned int index = static_cast<unsigned int>(_passes.size());
+    _passes.emplace_back();
+    _passes.back().name = passName;
+    _passIndexes[passName] = index;
+
+    return index;
+}
+
+void GPUProfiler::clear()
+{
+    _passes.clear();
+    _passIndexes.clear();
+    _nameCounts.clear();
+
+    for(auto& frame : _frames)
+    {
+        frame.used = 0;
+        frame.pending = false;
+    }
+}
+
+void GPUProfiler::beginFrame()
+{
+    FrameQueries& frame = _frames[_frameIndex];
+
+    // This slot was last used framesInFlight frames ago, its results should be ready by now
+    if(frame.pending)
+    {
+        collect(frame);
+    }
+
+    frame.used = 0;
+    frame.pending = false;
+}
+
+void GPUProfiler::endFrame()
+{
+    _frames[_frameIndex].pending = (_frames[_frameIndex].used > 0);
+    _frameIndex = (_frameIndex + 1) % framesInFlight;
+}
+
+void GPUProfiler::beginPass(unsigned int passIndex)
+{
+    FrameQueries& frame = _frames[_frameIndex];
+
+    if(frame.used == frame.queries.size())
+    {
+        unsigned int query;
+        glGenQueries(1, &query);
+        frame.queries.push_back(query);
+        frame.passes.push_back(passIndex);
+    }
+
+    frame.passes[frame.used] = passIndex;
+    glBeginQuery(GL_TIME_ELAPSED, frame.queries[frame.used]);
+    frame.used++;
+}
+
+void GPUProfiler::endPass()
+{
+    glEndQuery(GL_TIME_ELAPSED);
+}
+
+const GPUPassStatistics* GPUProfiler::getPassStatistics(const std::string& name) const
+{
+    auto it = _passIndexes.find(name);
+    if(it == _passIndexes.end())
+    {
+        return nullptr;
+    }
+
+    return &_passes[it->second];
+}
+
+void GPUProfiler::collect(FrameQueries& frame)
+{
+    // Queries finish in order, if the last one is not available do not wait for it, just drop the frame
+    GLint available = 0;
+    glGetQueryObjectiv(frame.queries[frame.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if(!available)
+    {
+        return;
+    }
+
+    float frameTime = 0.0f;
+    for(unsigned int i = 0; i < frame.used; ++i)
+    {
+        if(frame.passes[i] >= _passes.size())
+        {
+            continue;
+        }
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &elapsed);
+
+        float time = static_cast<float>(elapsed) / 1000000.0f;
+        _passes[frame.passes[i]].addSample(time);
+        frameTime += time;
+    }
+
+    _lastFrameTime = frameTime;
+    _collectedFrames++;
+}
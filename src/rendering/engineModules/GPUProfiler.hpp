@@ -0,0 +1,86 @@
+#pragma once
+
+// STL includes
+#include <array>
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+// Timings of a single StrategyNode, in milliseconds
+struct GPUPassStatistics
+{
+    // Upper bound of each histogram bucket, the last bucket takes everything above
+    static constexpr unsigned int bucketCount = 9;
+    static constexpr std::array<float, bucketCount> bucketLimits = { 0.25f, 0.5f, 1.0f, 2.0f, 4.0f, 8.0f, 16.0f, 33.0f, 1e30f };
+
+    // Amount of frames kept in the rolling window
+    static constexpr unsigned int historyLength = 240;
+
+    std::string name;
+
+    float lastTime = 0.0f;
+    float averageTime = 0.0f;
+    float maxTime = 0.0f;
+
+    // Amount of samples of the rolling window that fell in each bucket
+    std::array<unsigned int, bucketCount> histogram = {};
+
+    // Rolling window
+    std::array<float, historyLength> history = {};
+    unsigned int historySize = 0;
+    unsigned int historyIndex = 0;
+
+    void addSample(float time);
+};
+
+class GPUProfiler
+{
+public:
+    // Frames a query result may take to come back before its slot is reused
+    static constexpr unsigned int framesInFlight = 4;
+
+    GPUProfiler();
+    ~GPUProfiler();
+
+    // Returns the index that identifies the pass from now on. Every call is a pass of its own,
+    // a repeated name is reported with a " #2", " #3"... suffix
+    unsigned int registerPass(const std::string& name);
+    void clear();
+
+    // Frame boundaries, collects whatever results are ready from previous frames
+    void beginFrame();
+    void endFrame();
+
+    // Only one pass can be timed at once, GL_TIME_ELAPSED queries do not nest
+    void beginPass(unsigned int passIndex);
+    void endPass();
+
+    const std::vector<GPUPassStatistics>& getPassStatistics() const { return _passes; }
+    const GPUPassStatistics* getPassStatistics(const std::string& name) const;
+
+    // GPU time of the most recently collected frame, framesInFlight behind the one being recorded
+    float getFrameTime() const { return _lastFrameTime; }
+    // Frames whose results came back, dropped frames are not counted
+    unsigned int getCollectedFrameCount() const { return _collectedFrames; }
+
+private:
+    struct FrameQueries
+    {
+        std::vector<unsigned int> queries;
+        std::vector<unsigned int> passes;
+        unsigned int used = 0;
+        bool pending = false;
+    };
+
+    void collect(FrameQueries& frame);
+
+    std::array<FrameQueries, framesInFlight> _frames;
+    unsigned int _frameIndex;
+
+    float _lastFrameTime;
+    unsigned int _collectedFrames;
+
+    std::vector<GPUPassStatistics> _passes;
+    std::unordered_map<std::string, unsigned int> _passIndexes;
+    std::unordered_map<std::string, unsigned int> _nameCounts;
+};
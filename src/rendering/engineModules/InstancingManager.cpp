@@ -4,105 +4,192 @@
 #define  GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
 
+#include "rendering/shader/ShaderLibrary.hpp"
+#include "util/Profiler.hpp"
+
+#include <algorithm>
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////// INSTANCING GROUP
 ///////////////////////////////////////////////////////////////////////////////////////////
 
-const std::vector<glm::mat4>& InstancingGroup::transforms()
+const std::vector<std::vector<glm::mat4>>& InstancingGroup::transforms(bool visibleOnly)
 {
-    _transforms.clear();
-
-    for (const auto& modelObject : modelObjects)
+    _transforms.resize(mesh->getLodCount());
+    for(auto& levelTransforms : _transforms)
     {
-        _transforms.push_back(modelObject.lock()->getModelMatrix());
+        levelTransforms.clear();
     }
 
-    return _transforms;
-}
-
-InstancingGroup::~InstancingGroup()
-{
-    glDeleteBuffers(1, &VBO);
-
-    if(mesh != nullptr)
+    // Only the instances that survived culling are uploaded, each with the level the CullingManager picked
+    for (size_t i = 0; i < modelObjects.size(); ++i)
     {
-        //glDisableVertexArrayAttrib(mesh->VAO, 4);
-        //glDisableVertexArrayAttrib(mesh->VAO, 5);
-        //glDisableVertexArrayAttrib(mesh->VAO, 6);
-        //glDisableVertexArrayAttrib(mesh->VAO, 7);
+        std::shared_ptr<ModelObject> modelObject = modelObjects[i].lock();
+        if (modelObject && (visibleOnly ? modelObject->isVisible() : modelObject->enabled()))
+        {
+            size_t level = std::min<size_t>(modelObject->getMeshLod(meshIndices[i]), _transforms.size() - 1);
+            _transforms[level].push_back(modelObject->getMeshMatrix(meshIndices[i]));
+        }
     }
+
+    return _transforms;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////// INSTANCING MANAGER
 ///////////////////////////////////////////////////////////////////////////////////////////
 
-void InstancingManager::setupInstancing(unsigned int shaderIndex, std::shared_ptr<Scene> scene)
+void InstancingManager::setupInstancing(std::shared_ptr<Scene> scene, const ShaderLibrary& shaderLibrary)
 {
+    FLUX_PROFILE_FUNCTION();
+
     resetInstancingGroups();
+    update(*scene, shaderLibrary);
+}
+
+void InstancingManager::update(Scene& scene, const ShaderLibrary& shaderLibrary)
+{
+    const ModelContents& contents = scene.getAllObjects().models;
+    if(&scene == _scene && contents.getVersion() == _contentsVersion)
+    {
+        return;
+    }
+
+    FLUX_PROFILE_FUNCTION();
+
+    if(&scene != _scene)
+    {
+        resetInstancingGroups();
+        _scene = &scene;
+    }
+    _contentsVersion = contents.getVersion();
 
-    auto &modelObjects = scene->getModels("Basic");
+    for(auto& member : _members)
+    {
+        member.second.seen = false;
+    }
 
-    for (auto& modelObject : modelObjects)
+    _joining.clear();
+    _leaving.clear();
+    const auto& shaders = shaderLibrary.getShaders();
+    for(unsigned int shaderIndex = 0; shaderIndex < shaders.size(); ++shaderIndex)
     {
-        if(!modelObject->enabled())
+        const Shader& shader = *shaders[shaderIndex];
+        if(!shader.isFeatureSupported(E_ShaderProgramFeatures::E_AUTO_INSTANCING))
         {
             continue;
         }
-        for(auto& mesh : modelObject->getModel()->meshes)
+
+        const auto& models = shader.isFeatureSupported(E_ShaderProgramFeatures::E_TRANSPARENCY) ?
+            scene.getTransparentModels(shader.getName()) :
+            scene.getModels(shader.getName());
+
+        for(const auto& modelObject : models)
         {
-            if (_instancingGroups.find(mesh) == _instancingGroups.end())
+            auto member = _members.find(modelObject.get());
+            if(member != _members.end())
             {
-                _instancingGroups[mesh] = InstancingGroup();
-                _instancingGroups[mesh].mesh = mesh;
+                // Same address but another object, a new Model or another shader, its old entries go first
+                if(
+                    member->second.object.lock() == modelObject &&
+                    member->second.model == modelObject->getModel() &&
+                    member->second.shader == shaderIndex
+                    )
+                {
+                    member->second.seen = true;
+                    continue;
+                }
+                _leaving.insert(member->first);
+                _members.erase(member);
             }
-            _instancingGroups[mesh].modelObjects.push_back(modelObject);
+            _joining.emplace_back(modelObject, shaderIndex);
         }
     }
 
-    for(auto& instancingGroup : _instancingGroups)
+    for(auto member = _members.begin(); member != _members.end(); )
     {
-        setupInstancingGroup(instancingGroup.second);
+        if(member->second.seen)
+        {
+            ++member;
+            continue;
+        }
+        _leaving.insert(member->first);
+        member = _members.erase(member);
     }
-}   
 
-const std::unordered_map<std::shared_ptr<Mesh>, InstancingGroup>& InstancingManager::getInstancingGroups() const
+    removeModels();
+    for(const auto& joining : _joining)
+    {
+        addModel(joining.first, joining.second);
+    }
+}
+
+void InstancingManager::addModel(const std::shared_ptr<ModelObject>& modelObject, unsigned int shader)
+{
+    const auto& meshes = modelObject->getModel()->meshes;
+    for(size_t i = 0; i < meshes.size(); ++i)
+    {
+        const std::shared_ptr<Mesh>& mesh = meshes[i];
+        InstancingGroup& group = _instancingGroups[{shader, mesh}];
+        group.mesh = mesh;
+        group.shader = shader;
+        group.modelObjects.push_back(modelObject);
+        group.meshIndices.push_back(i);
+    }
+
+    _members[modelObject.get()] = {modelObject, modelObject->getModel(), shader, true};
+}
+
+void InstancingManager::removeModels()
+{
+    if(_leaving.empty())
+    {
+        return;
+    }
+
+    for(auto group = _instancingGroups.begin(); group != _instancingGroups.end(); )
+    {
+        auto& modelObjects = group->second.modelObjects;
+        auto& meshIndices = group->second.meshIndices;
+
+        // Destroyed objects go too, their address may already belong to a new one
+        for(size_t i = 0; i < modelObjects.size(); )
+        {
+            std::shared_ptr<ModelObject> modelObject = modelObjects[i].lock();
+            if(modelObject && _leaving.count(modelObject.get()) == 0)
+            {
+                ++i;
+                continue;
+            }
+
+            modelObjects[i] = std::move(modelObjects.back());
+            modelObjects.pop_back();
+            meshIndices[i] = meshIndices.back();
+            meshIndices.pop_back();
+        }
+
+        if(modelObjects.empty())
+        {
+            group = _instancingGroups.erase(group);
+            continue;
+        }
+        ++group;
+    }
+}
+
+const std::map<InstancingKey, InstancingGroup>& InstancingManager::getInstancingGroups() const
 {
     return _instancingGroups;
 }
 
-void InstancingManager::resetInstancingGroups()
+std::map<InstancingKey, InstancingGroup>& InstancingManager::getInstancingGroups()
 {
-    _instancingGroups.clear();
+    return _instancingGroups;
 }
 
-void InstancingManager::setupInstancingGroup(InstancingGroup& group)
+void InstancingManager::resetInstancingGroups()
 {
-        std::shared_ptr<Mesh> mesh = group.mesh;
-        const std::vector<glm::mat4>& modelMatrices = group.transforms();
-
-        // vertex buffer object
-        glGenBuffers(1, &group.VBO);
-        glBindBuffer(GL_ARRAY_BUFFER, group.VBO);
-        glBufferData(GL_ARRAY_BUFFER, modelMatrices.size() * sizeof(glm::mat4), &modelMatrices[0], GL_STATIC_DRAW);
-
-        glBindVertexArray(mesh->VAO);
-        std::size_t vec4Size = sizeof(glm::vec4);
-        glEnableVertexAttribArray(5);
-        glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)0);
-        glEnableVertexAttribArray(6);
-        glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(vec4Size));
-        glEnableVertexAttribArray(7);
-        glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(2 * vec4Size));
-        glEnableVertexAttribArray(8);
-        glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(3 * vec4Size));
-
-        glVertexAttribDivisor(5, 1);
-        glVertexAttribDivisor(6, 1);
-        glVertexAttribDivisor(7, 1);
-        glVertexAttribDivisor(8, 1);
-
-        // Unbind the VBO and VAO
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
-}
\ No newline at end of file
+    _instancingGroups.clear();
+    _members.clear();
+    _scene = nullptr;
+}
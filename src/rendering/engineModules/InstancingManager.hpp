@@ -9,34 +9,74 @@
 #include "scene/Scene.hpp"
 
 // STD library includes
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
 // Third-party headers
 #include <boost/uuid/uuid.hpp>
 
+class ShaderLibrary;
 
+// The transforms are gathered every frame and drawn through the RenderQueue indirect buffer
 class InstancingGroup
 {
 public:
-    ~InstancingGroup();
     std::vector<std::weak_ptr<ModelObject>> modelObjects;
+    // Position of the mesh in each model, selects its imported transform
+    std::vector<size_t> meshIndices;
     std::shared_ptr<Mesh> mesh;
-    const std::vector<glm::mat4>& transforms();
-    unsigned int VBO;
-    std::vector<glm::mat4> _transforms;
+    // Index in the ShaderLibrary of the program the models are drawn with
+    unsigned int shader = 0;
+    // Matrices of the visible instances, one list per level of detail of the mesh, gathered again on every call.
+    // Without visibleOnly every enabled instance is kept, for the GPU to cull them
+    const std::vector<std::vector<glm::mat4>>& transforms(bool visibleOnly = true);
+    std::vector<std::vector<glm::mat4>> _transforms;
 };
 
+// Shader index and mesh of a group
+using InstancingKey = std::pair<unsigned int, std::shared_ptr<Mesh>>;
+
+// Groups the meshes of the models of every shader that supports E_AUTO_INSTANCING by (shader, mesh),
+// only the transparent models of a shader with E_TRANSPARENCY are taken since it draws no others.
+// Kept in step with the scene: update() adds and removes the models that joined or left a bucket since the previous frame,
+// disabled ones stay and are skipped when gathering.
 class InstancingManager
 {
 public:
-    void setupInstancing(unsigned int shaderIndex, std::shared_ptr<Scene> scene);
-    const std::unordered_map<std::shared_ptr<Mesh>, InstancingGroup>& getInstancingGroups() const;
+    // Rebuilds every group from the scene
+    void setupInstancing(std::shared_ptr<Scene> scene, const ShaderLibrary& shaderLibrary);
+    // Once per frame, does nothing unless the models of the scene changed
+    void update(Scene& scene, const ShaderLibrary& shaderLibrary);
+    const std::map<InstancingKey, InstancingGroup>& getInstancingGroups() const;
+    std::map<InstancingKey, InstancingGroup>& getInstancingGroups();
     void resetInstancingGroups();
 
 private:
-    void setupInstancingGroup(InstancingGroup& instancingGroup);
+    struct Member
+    {
+        std::weak_ptr<ModelObject> object;
+        // The one its meshes were grouped from, the object may have been given another since
+        std::shared_ptr<Model> model;
+        unsigned int shader;
+        bool seen;
+    };
+
+    void addModel(const std::shared_ptr<ModelObject>& modelObject, unsigned int shader);
+    // One sweep over the groups for every model leaving them this frame
+    void removeModels();
+
+    // Ordered so that the groups of a shader follow each other
+    std::map<InstancingKey, InstancingGroup> _instancingGroups;
+
+    std::unordered_map<const ModelObject*, Member> _members;
+    const Scene* _scene = nullptr;
+    uint64_t _contentsVersion = 0;
 
-    // Mesh uuid -> InstancingGroup
-    std::unordered_map<std::shared_ptr<Mesh>, InstancingGroup> _instancingGroups;
+    // Models leaving and joining the groups during an update
+    std::unordered_set<const ModelObject*> _leaving;
+    std::vector<std::pair<std::shared_ptr<ModelObject>, unsigned int>> _joining;
 };
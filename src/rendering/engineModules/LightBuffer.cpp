@@ -0,0 +1,154 @@
+#include "rendering/engineModules/LightBuffer.hpp"
+
+#include "rendering/engineModules/LightManager.hpp"
+#include "scene/Scene.hpp"
+#include "util/Arithmetic.hpp"
+#include "util/Profiler.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // Without attenuation the range is infinite, or NaN, such a light reaches every cluster and tile it faces
+    float lightRange(const LightSource& light)
+    {
+        float range = light.calculateMaxRange();
+        return std::isfinite(range) && range > 0.0f ? range : std::numeric_limits<float>::max();
+    }
+
+    // Header of the LightData block, the lights follow it
+    struct LightCounts
+    {
+        glm::uvec4 counts;          // x directional lights, y point and spot lights
+    };
+}
+
+LightBuffer::LightBuffer(LightLibrary* library) :
+    _library(library),
+    _buffer(0),
+    _directionalCount(0)
+{
+    ;
+}
+
+LightBuffer::~LightBuffer()
+{
+    if(_buffer != 0)
+    {
+        glDeleteBuffers(1, &_buffer);
+    }
+}
+
+bool LightBuffer::update(const LightContents& lights)
+{
+    FLUX_PROFILE_FUNCTION();
+
+    stamp(lights, _currentStamps);
+    if(_buffer != 0 && _currentStamps == _stamps)
+    {
+        return false;
+    }
+    _stamps.swap(_currentStamps);
+
+    pack(lights);
+    upload();
+    return true;
+}
+
+void LightBuffer::stamp(const LightContents& lights, std::vector<Stamp>& stamps) const
+{
+    stamps.clear();
+
+    for(const auto& light : lights.directionalLights)
+    {
+        stamps.push_back({light.get(), light->getVersion(), light->getTransformVersion(), -1});
+    }
+    for(size_t i = 0; i < lights.pointLights.size(); ++i)
+    {
+        const PointLight& light = *lights.pointLights[i];
+        stamps.push_back({&light, light.getVersion(), light.getTransformVersion(), _library->getShadowSlot(light, static_cast<unsigned int>(i))});
+    }
+    for(size_t i = 0; i < lights.spotLights.size(); ++i)
+    {
+        const SpotLight& light = *lights.spotLights[i];
+        stamps.push_back({&light, light.getVersion(), light.getTransformVersion(), _library->getShadowSlot(light, static_cast<unsigned int>(i))});
+    }
+}
+
+void LightBuffer::pack(const LightContents& lights)
+{
+    _lights.clear();
+
+    // Points along its direction, no range
+    for(const auto& light : lights.directionalLights)
+    {
+        GPULight data;
+        data.positionRange = glm::vec4(conversion::toVec3(light->getDirection()), 0.0f);
+        data.color = glm::vec4(conversion::toVec3(light->getColor()), 2.0f);
+        data.directionCutoff = glm::vec4(0.0f);
+        data.attenuation = glm::vec4(0.0f);
+        data.shadow = glm::vec4(-1.0f, 0.0f, 0.0f, 0.0f);
+        data.shadowMatrix = glm::mat4(1.0f);
+        _lights.push_back(data);
+    }
+    _directionalCount = static_cast<unsigned int>(_lights.size());
+
+    for(size_t i = 0; i < lights.pointLights.size(); ++i)
+    {
+        const PointLight& light = *lights.pointLights[i];
+        const std::array<float, 3>& attenuation = light.getAttenuationFactors();
+        const int slot = _library->getShadowSlot(light, static_cast<unsigned int>(i));
+
+        GPULight data;
+        data.positionRange = glm::vec4(light.getWorldPosition(), lightRange(light));
+        data.color = glm::vec4(conversion::toVec3(light.getColor()), 0.0f);
+        data.directionCutoff = glm::vec4(0.0f);
+        data.attenuation = glm::vec4(attenuation[0], attenuation[1], attenuation[2], 0.0f);
+        data.shadow = glm::vec4(static_cast<float>(slot), slot >= 0 ? _library->getShadowMap(light)->getFarPlane() : 0.0f, 0.0f, 0.0f);
+        data.shadowMatrix = glm::mat4(1.0f);
+        _lights.push_back(data);
+    }
+
+    for(size_t i = 0; i < lights.spotLights.size(); ++i)
+    {
+        const SpotLight& light = *lights.spotLights[i];
+        const std::array<float, 3>& attenuation = light.getAttenuationFactors();
+        const std::array<float, 2>& cutoff = light.getCutoff();
+        const int slot = _library->getShadowSlot(light, static_cast<unsigned int>(i));
+
+        GPULight data;
+        data.positionRange = glm::vec4(light.getWorldPosition(), lightRange(light));
+        data.color = glm::vec4(conversion::toVec3(light.getColor()), 1.0f);
+        data.directionCutoff = glm::vec4(conversion::toVec3(light.getDirection()), glm::cos(glm::radians(cutoff[1])));
+        data.attenuation = glm::vec4(attenuation[0], attenuation[1], attenuation[2], glm::cos(glm::radians(cutoff[0])));
+        data.shadow = glm::vec4(static_cast<float>(slot), 0.0f, 0.0f, 0.0f);
+        data.shadowMatrix = slot >= 0 ? _library->getShadowMap(light)->getLightSpaceMatrix() : glm::mat4(1.0f);
+        _lights.push_back(data);
+    }
+}
+
+void LightBuffer::upload()
+{
+    if(_buffer == 0)
+    {
+        glGenBuffers(1, &_buffer);
+    }
+
+    LightCounts header;
+    header.counts = glm::uvec4(_directionalCount, static_cast<unsigned int>(_lights.size()) - _directionalCount, 0u, 0u);
+
+    const size_t lightsSize = _lights.size() * sizeof(GPULight);
+
+    // Fresh storage on every rewrite, the frames still in flight keep reading the previous one
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, sizeof(LightCounts) + lightsSize, nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, 0, sizeof(LightCounts), &header);
+    if(lightsSize > 0)
+    {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(LightCounts), lightsSize, _lights.data());
+    }
+
+    // Nothing else uses the binding, it holds for every shader until the next rewrite
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, _buffer);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+// GLFW include
+#include "rendering/GLFW_Wrapper.hpp"
+
+// GLM includes
+#include <glm/glm.hpp>
+
+// STL includes
+#include <cstdint>
+#include <vector>
+
+class LightLibrary;
+class LightSource;
+struct LightContents;
+
+// Every light of the scene packed in one storage buffer, bound once for all the shaders.
+// The buffer is only rewritten when a light was added, removed or changed, or when its shadow map came or went.
+class LightBuffer
+{
+public:
+    // Storage buffer binding of the LightData block
+    static constexpr unsigned int binding = 8;
+
+    // std430, mirrored by the Light struct of the shaders
+    struct GPULight
+    {
+        glm::vec4 positionRange;    // xyz world position, direction of a directional light, w range
+        glm::vec4 color;            // rgb color, w type (0 point, 1 spot, 2 directional)
+        glm::vec4 directionCutoff;  // xyz spot direction, w cosine of the outer cutoff
+        glm::vec4 attenuation;      // constant, linear, quadratic, w cosine of the inner cutoff
+        glm::vec4 shadow;           // x shadow map slot, -1 without one, y far plane of a point light shadow map
+        glm::mat4 shadowMatrix;     // Light space of a spot light shadow map
+    };
+
+    LightBuffer(LightLibrary* library);
+    ~LightBuffer();
+    LightBuffer(const LightBuffer&) = delete;
+    LightBuffer& operator=(const LightBuffer&) = delete;
+
+    // Returns true when the lights changed and the buffer was rewritten
+    bool update(const LightContents& lights);
+
+    // Directional lights first, then the point lights and the spot lights
+    const std::vector<GPULight>& getLights() const { return _lights; }
+    unsigned int getDirectionalCount() const { return _directionalCount; }
+
+private:
+    // What the packed data of a light depends on
+    struct Stamp
+    {
+        const LightSource* light;
+        uint32_t version;
+        uint32_t transformVersion;
+        int shadowSlot;
+
+        bool operator==(const Stamp& other) const
+        {
+            return light == other.light && version == other.version && transformVersion == other.transformVersion && shadowSlot == other.shadowSlot;
+        }
+    };
+
+    void stamp(const LightContents& lights, std::vector<Stamp>& stamps) const;
+    void pack(const LightContents& lights);
+    void upload();
+
+    LightLibrary* _library;
+
+    GLuint _buffer;
+    std::vector<GPULight> _lights;
+    unsigned int _directionalCount;
+
+    // Stamps of the last upload, and of the lights being checked against them
+    std::vector<Stamp> _stamps;
+    std::vector<Stamp> _currentStamps;
+};
@@ -0,0 +1,221 @@
+#include "rendering/engineModules/LightClusters.hpp"
+
+#include "GraphicalEngine.hpp"
+#include "rendering/engineModules/LightBuffer.hpp"
+#include "rendering/engineModules/LightManager.hpp"
+#include "scene/Camera.hpp"
+#include "util/Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // Squared distance from a point to a box, zero inside of it
+    float distanceSquared(const glm::vec3& point, const glm::vec3& min, const glm::vec3& max)
+    {
+        glm::vec3 delta = glm::max(glm::max(min - point, point - max), glm::vec3(0.0f));
+        return glm::dot(delta, delta);
+    }
+
+    unsigned int tile(float ndc, unsigned int count)
+    {
+        return static_cast<unsigned int>(std::clamp((ndc * 0.5f + 0.5f) * count, 0.0f, count - 1.0f));
+    }
+
+    // Next region of the buffer, filled and bound to the storage binding
+    void streamStorage(StreamBuffer& buffer, GLuint binding, const void* data, size_t size)
+    {
+        // Empty ranges cannot be bound, the shaders never read past the counts anyway
+        size_t boundSize = std::max<size_t>(size, 16);
+        buffer.next(boundSize);
+        buffer.write(0, data, size);
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, buffer.id(), buffer.getRegionOffset(), boundSize);
+    }
+}
+
+LightClusters::LightClusters(LightLibrary* library) :
+    _library(library),
+    _projection(0.0f),
+    _nearPlane(0.1f),
+    _farPlane(1.0f),
+    _sliceScale(0.0f),
+    _sliceBias(0.0f)
+{
+    ;
+}
+
+void LightClusters::update(const LightBuffer& lights, const Camera& camera)
+{
+    FLUX_PROFILE_FUNCTION();
+
+    const glm::mat4 projection = camera.getProjectionMatrix();
+    const glm::mat4 view = camera.getViewMatrix();
+    if(_bounds.empty() || projection != _projection)
+    {
+        buildBounds(projection, camera.getNearPlane(), camera.getFarPlane());
+    }
+
+    _pairs.clear();
+
+    // Directional lights reach everything, the shaders go through them apart from the clusters
+    const std::vector<LightBuffer::GPULight>& gpuLights = lights.getLights();
+    for(size_t i = lights.getDirectionalCount(); i < gpuLights.size(); ++i)
+    {
+        const glm::vec4& positionRange = gpuLights[i].positionRange;
+        assign(glm::vec3(view * glm::vec4(glm::vec3(positionRange), 1.0f)), positionRange.w, projection, static_cast<uint32_t>(i));
+    }
+
+    // Counting sort of the assignments by cluster, the lights of every cluster end up contiguous
+    _ranges.assign(clusterCount, {0, 0});
+    for(const auto& pair : _pairs)
+    {
+        ++_ranges[pair[0]][1];
+    }
+
+    uint32_t offset = 0;
+    for(auto& range : _ranges)
+    {
+        range[0] = offset;
+        offset += range[1];
+        range[1] = 0;
+    }
+
+    _indices.resize(_pairs.size());
+    for(const auto& pair : _pairs)
+    {
+        auto& range = _ranges[pair[0]];
+        _indices[range[0] + range[1]++] = pair[1];
+    }
+
+    // Tiles split the viewport evenly, whatever its size
+    std::array<int, 2> viewportSize = _library->engine()->getViewportSize();
+    GridHeader header;
+    header.counts = glm::uvec4(countX, countY, countZ, 0u);
+    header.depth = glm::vec4(_sliceScale, _sliceBias, static_cast<float>(viewportSize[0]) / countX, static_cast<float>(viewportSize[1]) / countY);
+
+    const size_t rangesSize = _ranges.size() * sizeof(_ranges[0]);
+    _gridBuffer.next(sizeof(GridHeader) + rangesSize);
+    _gridBuffer.write(0, &header, sizeof(GridHeader));
+    _gridBuffer.write(sizeof(GridHeader), _ranges.data(), rangesSize);
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, gridBinding, _gridBuffer.id(), _gridBuffer.getRegionOffset(), sizeof(GridHeader) + rangesSize);
+
+    streamStorage(_indexBuffer, indicesBinding, _indices.data(), _indices.size() * sizeof(uint32_t));
+}
+
+void LightClusters::buildBounds(const glm::mat4& projection, float nearPlane, float farPlane)
+{
+    _projection = projection;
+    _nearPlane = nearPlane;
+    _farPlane = farPlane;
+
+    // Slice k starts at near * (far / near)^(k / countZ), so that froxels stay roughly cubic along the depth
+    const float logRatio = std::log(farPlane / nearPlane);
+    _sliceScale = countZ / logRatio;
+    _sliceBias = -(countZ * std::log(nearPlane)) / logRatio;
+
+    // View space rays through the tile corners, scaled to a depth of 1
+    const glm::mat4 inverse = glm::inverse(projection);
+    std::array<glm::vec3, (countX + 1) * (countY + 1)> rays;
+    for(unsigned int y = 0; y <= countY; ++y)
+    {
+        for(unsigned int x = 0; x <= countX; ++x)
+        {
+            glm::vec4 corner = inverse * glm::vec4(-1.0f + 2.0f * x / countX, -1.0f + 2.0f * y / countY, -1.0f, 1.0f);
+            glm::vec3 ray = glm::vec3(corner) / corner.w;
+            rays[y * (countX + 1) + x] = ray / -ray.z;
+        }
+    }
+
+    _bounds.resize(clusterCount);
+    for(unsigned int z = 0; z < countZ; ++z)
+    {
+        const float depths[2] = {
+            nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(z) / countZ),
+            nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(z + 1) / countZ)
+        };
+
+        for(unsigned int y = 0; y < countY; ++y)
+        {
+            for(unsigned int x = 0; x < countX; ++x)
+            {
+                Bounds bounds = {glm::vec3(std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::lowest())};
+                for(unsigned int corner = 0; corner < 4; ++corner)
+                {
+                    const glm::vec3& ray = rays[(y + corner / 2) * (countX + 1) + x + corner % 2];
+                    for(float depth : depths)
+                    {
+                        bounds.min = glm::min(bounds.min, ray * depth);
+                        bounds.max = glm::max(bounds.max, ray * depth);
+                    }
+                }
+                _bounds[x + countX * (y + countY * z)] = bounds;
+            }
+        }
+    }
+}
+
+unsigned int LightClusters::depthSlice(float depth) const
+{
+    float slice = std::floor(std::log(depth) * _sliceScale + _sliceBias);
+    return static_cast<unsigned int>(std::clamp(slice, 0.0f, countZ - 1.0f));
+}
+
+void LightClusters::assign(const glm::vec3& center, float range, const glm::mat4& projection, uint32_t light)
+{
+    const float depth = -center.z;
+    const float nearest = depth - range;
+    const float farthest = depth + range;
+    if(farthest < _nearPlane || nearest > _farPlane)
+    {
+        return;
+    }
+
+    const unsigned int firstZ = depthSlice(std::max(nearest, _nearPlane));
+    const unsigned int lastZ = depthSlice(std::min(farthest, _farPlane));
+
+    // Tiles covered by the projected box around the sphere, all of them once the sphere reaches the near plane
+    unsigned int firstX = 0, lastX = countX - 1;
+    unsigned int firstY = 0, lastY = countY - 1;
+    if(nearest > _nearPlane)
+    {
+        glm::vec2 ndcMin(std::numeric_limits<float>::max());
+        glm::vec2 ndcMax(std::numeric_limits<float>::lowest());
+        for(unsigned int corner = 0; corner < 8; ++corner)
+        {
+            glm::vec3 offset((corner & 1) ? range : -range, (corner & 2) ? range : -range, (corner & 4) ? range : -range);
+            glm::vec4 clip = projection * glm::vec4(center + offset, 1.0f);
+            glm::vec2 ndc = glm::vec2(clip) / clip.w;
+            ndcMin = glm::min(ndcMin, ndc);
+            ndcMax = glm::max(ndcMax, ndc);
+        }
+
+        if(ndcMax.x < -1.0f || ndcMin.x > 1.0f || ndcMax.y < -1.0f || ndcMin.y > 1.0f)
+        {
+            return;
+        }
+
+        firstX = tile(ndcMin.x, countX);
+        lastX = tile(ndcMax.x, countX);
+        firstY = tile(ndcMin.y, countY);
+        lastY = tile(ndcMax.y, countY);
+    }
+
+    const float rangeSquared = range * range;
+    for(unsigned int z = firstZ; z <= lastZ; ++z)
+    {
+        for(unsigned int y = firstY; y <= lastY; ++y)
+        {
+            for(unsigned int x = firstX; x <= lastX; ++x)
+            {
+                const uint32_t cluster = x + countX * (y + countY * z);
+                const Bounds& bounds = _bounds[cluster];
+                if(distanceSquared(center, bounds.min, bounds.max) <= rangeSquared)
+                {
+                    _pairs.push_back({cluster, light});
+                }
+            }
+        }
+    }
+}
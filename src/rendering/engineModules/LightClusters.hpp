@@ -0,0 +1,73 @@
+#pragma once
+
+// GLM includes
+#include <glm/glm.hpp>
+
+// STL includes
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// First party includes
+#include "rendering/StreamBuffer.hpp"
+
+class Camera;
+class LightBuffer;
+class LightLibrary;
+
+// Clustered forward lighting. The view frustum is split in a grid of froxels, screen tiles in x and y and
+// exponential depth slices in z, and every point and spot light is listed in the clusters its range reaches.
+// Fragments find their cluster from gl_FragCoord and their view depth, then only iterate the lights listed there.
+// The lights themselves are in the LightBuffer, the grid and the index lists are streamed to storage buffers every frame.
+class LightClusters
+{
+public:
+    static constexpr unsigned int countX = 16;
+    static constexpr unsigned int countY = 9;
+    static constexpr unsigned int countZ = 24;
+    static constexpr unsigned int clusterCount = countX * countY * countZ;
+
+    // Storage buffer bindings, past the ones of the GPU culling pass and the LightBuffer
+    static constexpr unsigned int gridBinding = 9;
+    static constexpr unsigned int indicesBinding = 10;
+
+    LightClusters(LightLibrary* library);
+
+    // Assigns the point and spot lights of the buffer to the clusters of the camera, uploads and binds the lists
+    void update(const LightBuffer& lights, const Camera& camera);
+
+    size_t getIndexCount() const { return _indices.size(); }
+
+private:
+    // std430 header of the ClusterGrid buffer, the per cluster ranges follow it
+    struct GridHeader
+    {
+        glm::uvec4 counts;          // Clusters in x, y and z
+        glm::vec4 depth;            // x depth slice scale, y depth slice bias, zw tile size in pixels
+    };
+
+    struct Bounds
+    {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    // View space boxes of the clusters, only rebuilt when the projection changes
+    void buildBounds(const glm::mat4& projection, float nearPlane, float farPlane);
+    void assign(const glm::vec3& center, float range, const glm::mat4& projection, uint32_t light);
+    unsigned int depthSlice(float depth) const;
+
+    LightLibrary* _library;
+
+    glm::mat4 _projection;
+    float _nearPlane, _farPlane;
+    float _sliceScale, _sliceBias;
+    std::vector<Bounds> _bounds;
+
+    std::vector<std::array<uint32_t, 2>> _pairs;    // Cluster and light of every assignment
+    std::vector<std::array<uint32_t, 2>> _ranges;   // Offset and count in the index list, per cluster
+    std::vector<uint32_t> _indices;                 // Indices in the LightBuffer
+
+    StreamBuffer _gridBuffer;
+    StreamBuffer _indexBuffer;
+};
@@ -2,13 +2,21 @@
 
 #include "GraphicalEngine.hpp"
 #include "rendering/shader/ShaderLibrary.hpp"
+#include "rendering/RenderQueue.hpp"
+#include "rendering/GLStateCache.hpp"
 #include "rendering/framebuffer/Framebuffer_Manager.hpp"
 #include "rendering/Settings.hpp"
+#include "util/Profiler.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace
 {
+    // First texture units of the shadow maps, the shaders' shadow sampler arrays are bound to them
+    constexpr unsigned int spotShadowUnit = 5;
+    constexpr unsigned int pointShadowUnit = 15;
+
     E_LightType getLightType(const LightSource& light)
     {
         if(dynamic_cast<const DirectionalLight*>(&light))
@@ -28,6 +36,18 @@ namespace
             throw std::runtime_error("Light type not recognized");
         }
     }
+
+    // The point and spot lights given a shadow map, the first ones of each type
+    std::vector<std::shared_ptr<LightSource>> getShadowCasters(const LightContents& lights)
+    {
+        const size_t pointCount = std::min<size_t>(lights.pointLights.size(), LightLibrary::maxShadowCasters);
+        const size_t spotCount = std::min<size_t>(lights.spotLights.size(), LightLibrary::maxShadowCasters);
+
+        std::vector<std::shared_ptr<LightSource>> shadowCasters;
+        shadowCasters.insert(shadowCasters.end(), lights.pointLights.begin(), lights.pointLights.begin() + pointCount);
+        shadowCasters.insert(shadowCasters.end(), lights.spotLights.begin(), lights.spotLights.begin() + spotCount);
+        return shadowCasters;
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -98,7 +118,7 @@ void ShadowMap::alignShadowMap(std::shared_ptr<LightSource> light)
         fov = glm::radians(90.0f);
 
         perMat = glm::perspective(fov, 1.0f, _nearPlane, _farPlane);
-        posVec = conversion::toVec3(light_point->getPosition());
+        posVec = light_point->getWorldPosition();
 
         _lightSpaceMatrix.clear();
 
@@ -126,7 +146,7 @@ void ShadowMap::alignShadowMap(std::shared_ptr<LightSource> light)
         _farPlane = 1000.0f;
         fov = light_spot->getCutoff()[1]*1.25f;
         perMat = glm::perspective(fov, 1.0f, _nearPlane, _farPlane);
-        posVec = conversion::toVec3(light_spot->getPosition());
+        posVec = light_spot->getWorldPosition();
         observed_point = posVec + conversion::toVec3(light_spot->getDirection());
 
         glm::mat4 lightSpaceMatrix = perMat * glm::lookAt(posVec,observed_point,glm::vec3(0.0f, 1.0f, 0.0f));
@@ -146,6 +166,11 @@ const glm::mat4& ShadowMap::getLightSpaceMatrix(unsigned int index) const
     return _lightSpaceMatrix[index];
 }
 
+float ShadowMap::getFarPlane() const
+{
+    return _farPlane;
+}
+
 void ShadowMap::setLightType(E_LightType type)
 {
     _lightType = type;
@@ -201,7 +226,9 @@ namespace
 
 LightLibrary::LightLibrary(GraphicalEngine* engine) :
     _ranFrom(engine),
-    _lightMap(this)
+    _lightMap(this),
+    _lightBuffer(this),
+    _lightClusters(this)
 {
     ;
 }
@@ -213,153 +240,55 @@ GraphicalEngine* LightLibrary::engine() const
 
 bool LightLibrary::prepare(const LightContents& lights)
 {
-    std::shared_ptr<ShaderLibrary> shaders = _ranFrom->getShaderLibrary();
-
-    auto& directionalLights = lights.directionalLights;
-    int directionalLightsCount = static_cast<int>(directionalLights.size()); // We need to cast to int because the uniform is an int, otherwise we'd get a warning
-    shaders->setUniformInt("numDirLights", directionalLightsCount);
-    for(int i(0); i<directionalLightsCount; ++i)
-    {
-        lightSetup(i, *directionalLights[i]);
-    }
-
-    auto& pointLights = lights.pointLights;
-    int pointLightsCount = static_cast<int>(pointLights.size());
-    shaders->setUniformInt("numPointLights", pointLightsCount);
-    for(int i(0); i<pointLightsCount; ++i)
-    {
-        lightSetup(i, *pointLights[i]);
-    }
+    FLUX_PROFILE_FUNCTION();
 
-    auto& spotLights = lights.spotLights;
-    int spotLightsCount = static_cast<int>(spotLights.size());
-    shaders->setUniformInt("numSpotLights", spotLightsCount);
-    for(int i(0); i<spotLightsCount; ++i)
-    {
-        lightSetup(i, *spotLights[i]);
-    }
-
-    return true;
+    bindShadowMaps(lights);
+    return _lightBuffer.update(lights);
 }
 
-void LightLibrary::lightSetup(unsigned int lightIndex, const DirectionalLight &light)
+void LightLibrary::bindShadowMaps(const LightContents& lights)
 {
-    std::shared_ptr<ShaderLibrary> shaders = _ranFrom->getShaderLibrary();
-
-    // Direction
-    glm::vec3 direction = conversion::toVec3(light.getDirection());
-    shaders->setUniformVec3("dirLight[" + std::to_string(lightIndex) + "].direction", direction);
-
-    // Color
-    glm::vec3 color = conversion::toVec3(light.getColor());
-    shaders->setUniformVec3("dirLight[" + std::to_string(lightIndex) + "].ambient", color);
-    shaders->setUniformVec3("dirLight[" + std::to_string(lightIndex) + "].diffuse", color);
-    shaders->setUniformVec3("dirLight[" + std::to_string(lightIndex) + "].specular", color);
-}
-
-void LightLibrary::lightSetup(unsigned int lightIndex, const PointLight &light)
-{
-    std::shared_ptr<ShaderLibrary> shaders = _ranFrom->getShaderLibrary();
-
-    // Position
-    glm::vec3 position = conversion::toVec3(light.getPosition());
-    shaders->setUniformVec3("pointLight[" + std::to_string(lightIndex) + "].position", position);
-
-    // Color
-    glm::vec3 color = conversion::toVec3(light.getColor());
-    shaders->setUniformVec3("pointLight[" + std::to_string(lightIndex) + "].ambient", color);
-    shaders->setUniformVec3("pointLight[" + std::to_string(lightIndex) + "].diffuse", color);
-    shaders->setUniformVec3("pointLight[" + std::to_string(lightIndex) + "].specular", color);
-
-    // Attenuation factors
-    const std::array<float, 3>& attFactors = light.getAttenuationFactors();
-    shaders->setUniformFloat("pointLight[" + std::to_string(lightIndex) + "].constant", attFactors[0]);
-    shaders->setUniformFloat("pointLight[" + std::to_string(lightIndex) + "].linear", attFactors[1]);
-    shaders->setUniformFloat("pointLight[" + std::to_string(lightIndex) + "].quadratic", attFactors[2]);
-
-    // Shadow Maps - Light Space Matrix
-    if( _ranFrom->getSettings()->getShadowGlobal() == E_Setting::OFF ||
-        _ranFrom->getSettings()->getShadowPoint() == E_Setting::OFF)
+    std::shared_ptr<Settings> settings = _ranFrom->getSettings();
+    if(settings->getShadowGlobal() == E_Setting::OFF)
     {
         return;
     }
 
-    if(_shadowMaps.find(light.id()) == _shadowMaps.end())
+    // Shadow slot i is sampled from the first unit of its type plus i
+    if(settings->getShadowPoint() == E_Setting::ON)
     {
-        return;
-        throw std::runtime_error("Shadow map not found");
-    }
-
-    ShadowMap& shaMap = _shadowMaps[light.id()];
-    shaders->setUniformFloat("pointLight[" + std::to_string(lightIndex) + "].farPlane", shaMap._farPlane);
-    shaders->setUniformInt("pointLight[" + std::to_string(lightIndex) + "].shadowMap", 15 + lightIndex);
-
-    glActiveTexture(GL_TEXTURE0 + 15 + lightIndex);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, shaMap.getShadowMap()->getDepthTextureID());
-    glActiveTexture(GL_TEXTURE0);
-}
-
-void LightLibrary::lightSetup(unsigned int lightIndex, const SpotLight &light)
-{
-    std::shared_ptr<ShaderLibrary> shaders = _ranFrom->getShaderLibrary();
-
-       // Position
-    glm::vec3 position = conversion::toVec3(light.getPosition());
-    shaders->setUniformVec3("spotLight[" + std::to_string(lightIndex) + "].position", position);
-
-    // Direction
-    glm::vec3 direction = conversion::toVec3(light.getDirection());
-    shaders->setUniformVec3("spotLight[" + std::to_string(lightIndex) + "].direction", direction);
-
-    // Color
-    glm::vec3 color = conversion::toVec3(light.getColor());
-    shaders->setUniformVec3("spotLight[" + std::to_string(lightIndex) + "].ambient", color);
-    shaders->setUniformVec3("spotLight[" + std::to_string(lightIndex) + "].diffuse", color);
-    shaders->setUniformVec3("spotLight[" + std::to_string(lightIndex) + "].specular", color);
-
-    // Attenuation factors
-    const std::array<float, 3>& attFactors = light.getAttenuationFactors();
-    shaders->setUniformFloat("spotLight[" + std::to_string(lightIndex) + "].constant", attFactors[0]);
-    shaders->setUniformFloat("spotLight[" + std::to_string(lightIndex) + "].linear", attFactors[1]);
-    shaders->setUniformFloat("spotLight[" + std::to_string(lightIndex) + "].quadratic", attFactors[2]);
-
-    // Cutoff
-    std::array<float, 2> cutoff = light.getCutoff();
-    shaders->setUniformFloat("spotLight[" + std::to_string(lightIndex) + "].innerCutOff", glm::cos(glm::radians(cutoff[0])));
-    shaders->setUniformFloat("spotLight[" + std::to_string(lightIndex) + "].outerCutOff", glm::cos(glm::radians(cutoff[1])));
-
-    // Shadow Maps - Light Space Matrix
-    if( _ranFrom->getSettings()->getShadowGlobal() == E_Setting::OFF ||
-        _ranFrom->getSettings()->getShadowSpot() == E_Setting::OFF)
-    {
-        return;
+        for(unsigned int i = 0; i < std::min<size_t>(lights.pointLights.size(), maxShadowCasters); ++i)
+        {
+            if(const ShadowMap* shadowMap = getShadowMap(*lights.pointLights[i]))
+            {
+                GLStateCache::Instance().activeTexture(GL_TEXTURE0 + pointShadowUnit + i);
+                GLStateCache::Instance().bindTexture(GL_TEXTURE_CUBE_MAP, shadowMap->getShadowMap()->getDepthTextureID());
+            }
+        }
     }
 
-    if(_shadowMaps.find(light.id()) == _shadowMaps.end())
+    if(settings->getShadowSpot() == E_Setting::ON)
     {
-        return;
-        throw std::runtime_error("Shadow map not found");
+        for(unsigned int i = 0; i < std::min<size_t>(lights.spotLights.size(), maxShadowCasters); ++i)
+        {
+            if(const ShadowMap* shadowMap = getShadowMap(*lights.spotLights[i]))
+            {
+                GLStateCache::Instance().activeTexture(GL_TEXTURE0 + spotShadowUnit + i);
+                GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, shadowMap->getShadowMap()->getDepthTextureID());
+            }
+        }
     }
-    
-    ShadowMap& shaMap = _shadowMaps[light.id()];
-    shaders->setUniformMat4("spotLightSpaceMatrix[" + std::to_string(lightIndex) + "]", shaMap.getLightSpaceMatrix());
-    shaders->setUniformInt("spotLight[" + std::to_string(lightIndex) + "].shadowMap", 5 + lightIndex);
 
-    glActiveTexture(GL_TEXTURE0 + 5 + lightIndex);
-    glBindTexture(GL_TEXTURE_2D, shaMap.getShadowMap()->getDepthTextureID());
-    glActiveTexture(GL_TEXTURE0);
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0);
 }
 
 void LightLibrary::alignShadowMaps(std::shared_ptr<Scene> scene)
 {
-    std::shared_ptr<FBOManager> framebuffers = _ranFrom->getFBOManager();
+    FLUX_PROFILE_FUNCTION();
 
-    auto lights = scene->getAllLights();
+    std::shared_ptr<FBOManager> framebuffers = _ranFrom->getFBOManager();
 
-    std::vector<std::shared_ptr<LightSource>> allLightSources;
-    // allLightSources.insert(allLightSources.end(), lights.directionalLights.begin(), lights.directionalLights.end());
-    allLightSources.insert(allLightSources.end(), lights.pointLights.begin(), lights.pointLights.end());
-    allLightSources.insert(allLightSources.end(), lights.spotLights.begin(), lights.spotLights.end());
+    std::vector<std::shared_ptr<LightSource>> allLightSources = getShadowCasters(scene->getAllLights());
 
     for(auto& light : allLightSources)
     {   
@@ -401,12 +330,7 @@ void LightLibrary::alignShadowMaps(std::shared_ptr<Scene> scene)
 
 void LightLibrary::renderShadowMaps(std::shared_ptr<Scene> scene)
 {
-    auto lights = scene->getAllLights();
-
-    std::vector<std::shared_ptr<LightSource>> allLightSources;
-    //allLightSources.insert(allLightSources.end(), lights.directionalLights.begin(), lights.directionalLights.end());
-    allLightSources.insert(allLightSources.end(), lights.pointLights.begin(), lights.pointLights.end());
-    allLightSources.insert(allLightSources.end(), lights.spotLights.begin(), lights.spotLights.end());
+    std::vector<std::shared_ptr<LightSource>> allLightSources = getShadowCasters(scene->getAllLights());
 
     for(auto& light : allLightSources)
     {
@@ -428,6 +352,33 @@ LightMap& LightLibrary::getLightMap()
     return _lightMap;
 }
 
+LightBuffer& LightLibrary::getLightBuffer()
+{
+    return _lightBuffer;
+}
+
+LightClusters& LightLibrary::getLightClusters()
+{
+    return _lightClusters;
+}
+
+int LightLibrary::getShadowSlot(const LightSource& light, unsigned int lightIndex) const
+{
+    if( lightIndex >= maxShadowCasters ||
+        _ranFrom->getSettings()->getShadowGlobal() == E_Setting::OFF ||
+        _shadowMaps.find(light.id()) == _shadowMaps.end())
+    {
+        return -1;
+    }
+    return static_cast<int>(lightIndex);
+}
+
+const ShadowMap* LightLibrary::getShadowMap(const LightSource& light) const
+{
+    auto shadowMap = _shadowMaps.find(light.id());
+    return shadowMap != _shadowMaps.end() ? &shadowMap->second : nullptr;
+}
+
 void LightLibrary::renderTextureShadowMap(std::shared_ptr<Scene> scene, std::shared_ptr<LightSource> light)
 {
     std::shared_ptr<ShaderLibrary> shaders = _ranFrom->getShaderLibrary();
@@ -464,21 +415,8 @@ void LightLibrary::renderTextureShadowMap(std::shared_ptr<Scene> scene, std::sha
     framebuffers->bindFBO(FBO_INDEX);
     framebuffers->clearDepth();
 
-    // Render loop
-    for (auto& model : scene->getModels())
-    {
-
-        shaders->setUniformMat4("shadowModel", model->getModelMatrix());
-
-        for (auto &one_mesh : model->getModel()->meshes)
-        {
-            glBindVertexArray(one_mesh->VAO);
-            int numVertexes = static_cast<int>(one_mesh->_indices.size());  // Avoids compiler warning
-            glDrawElements(GL_TRIANGLES, numVertexes, GL_UNSIGNED_INT, 0);
-            glBindVertexArray(0);
-        }
-    
-    }
+    // The shadow casters were queued by ShadowsSetupNode, model matrices come from the instance attributes
+    _ranFrom->getRenderQueue()->submitGeometry(E_RenderPass::SHADOW);
 
     framebuffers->unbindFBO();
 }
@@ -513,9 +451,7 @@ void LightLibrary::renderCubeShadowMap(std::shared_ptr<Scene> scene, std::shared
 
     ShadowMap& shaMap = _shadowMaps[light->id()];
 
-    auto light_point_position = light->getPosition();
-
-    shaders->setUniformVec3("lightPos", conversion::toVec3(light->getPosition()));
+    shaders->setUniformVec3("lightPos", light->getWorldPosition());
     shaders->setUniformFloat("far_plane", shaMap._farPlane);
     
     for(unsigned int i(0); i<6; ++i)
@@ -528,19 +464,8 @@ void LightLibrary::renderCubeShadowMap(std::shared_ptr<Scene> scene, std::shared
     framebuffers->bindFBO(FBO_INDEX);
     framebuffers->clearDepth();
 
-    // Render loop
-    for (auto& model : scene->getModels())
-    {
-        shaders->setUniformMat4("model", model->getModelMatrix());
-
-        for (auto &one_mesh : model->getModel()->meshes)
-        {   
-            glBindVertexArray(one_mesh->VAO);
-            int numVertexes = static_cast<int>(one_mesh->_indices.size());  // Avoids compiler warning
-            glDrawElements(GL_TRIANGLES, numVertexes, GL_UNSIGNED_INT, 0);  
-            glBindVertexArray(0);
-        }
-    }
+    // The shadow casters were queued by ShadowsSetupNode, model matrices come from the instance attributes
+    _ranFrom->getRenderQueue()->submitGeometry(E_RenderPass::SHADOW);
     framebuffers->unbindFBO();
 
 }   
\ No newline at end of file
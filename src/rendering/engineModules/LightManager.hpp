@@ -9,6 +9,8 @@
 //First party headers
 #include "scene/Scene.hpp"
 #include "rendering/engineModules/LightMap.hpp"
+#include "rendering/engineModules/LightBuffer.hpp"
+#include "rendering/engineModules/LightClusters.hpp"
 
 // STL headers
 #include <unordered_map>
@@ -29,6 +31,7 @@ public:
 
 	std::shared_ptr<FBO> getShadowMap() const;
 	const glm::mat4& getLightSpaceMatrix(unsigned int index = 0) const;
+	float getFarPlane() const;
 	void setDimensions(unsigned int width, unsigned int height = 0);
 private:
 	void setLightType(E_LightType type);
@@ -43,21 +46,30 @@ private:
 class LightLibrary
 {
 public:
+	// Only the first lights of each type get a shadow map, the shaders have that many shadow samplers
+	static constexpr unsigned int maxShadowCasters = 10;
+
 	LightLibrary(GraphicalEngine* engine);
 
 	GraphicalEngine* engine() const;
 
-    bool prepare(const LightContents& lights);
+	// Rewrites the light buffer when a light changed and binds the shadow maps, true when the buffer was rewritten
+	bool prepare(const LightContents& lights);
 
 	void alignShadowMaps(std::shared_ptr<Scene> scene);
 	void renderShadowMaps(std::shared_ptr<Scene> scene);
 
 	LightMap& getLightMap();
+	LightBuffer& getLightBuffer();
+	LightClusters& getLightClusters();
+
+	// Shadow sampler slot of the light at that index of its type, -1 when it has no shadow map
+	int getShadowSlot(const LightSource& light, unsigned int lightIndex) const;
+	// nullptr when the light has no shadow map
+	const ShadowMap* getShadowMap(const LightSource& light) const;
 
 private:
-	void lightSetup(unsigned int lightIndex, const DirectionalLight &light);
-	void lightSetup(unsigned int lightIndex, const PointLight &light);
-	void lightSetup(unsigned int lightIndex, const SpotLight &light);
+	void bindShadowMaps(const LightContents& lights);
 
 	void renderTextureShadowMap(std::shared_ptr<Scene> scene, std::shared_ptr<LightSource> light);
 	void renderCubeShadowMap(std::shared_ptr<Scene> scene, std::shared_ptr<LightSource> light);
@@ -65,6 +77,8 @@ private:
 	std::unordered_map<boost::uuids::uuid, ShadowMap,  boost::hash<boost::uuids::uuid>> _shadowMaps;
 	
 	LightMap _lightMap;
+	LightBuffer _lightBuffer;
+	LightClusters _lightClusters;
 
     // The engine currently running this manager
     GraphicalEngine* _ranFrom;
@@ -4,6 +4,8 @@
 #include "rendering/engineModules/LightManager.hpp"
 #include "rendering/framebuffer/Framebuffer_Manager.hpp"
 #include "rendering/shader/ShaderLibrary.hpp"
+#include "rendering/RenderStatistics.hpp"
+#include "rendering/GLStateCache.hpp"
 
 #include "util/VertexShapes.hpp"
 
@@ -83,13 +85,13 @@ unsigned int LightMap::bakeFromTexture(std::shared_ptr<TextureHDR> texture)
 
     shaderPrograms->use("Flat2Cube");
     shaderPrograms->setUniformInt("textureMap", 1);
-    glActiveTexture(GL_TEXTURE0 + 1);
-    glBindTexture(GL_TEXTURE_2D, texture->_id);
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 1);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, texture->_id);
 
     shaderPrograms->setUniformMat4("projectionMatrix", captureProjection);
 
     glViewport(0,0,_size,_size);
-    glBindVertexArray(shapes::cube::VAO());
+    GLStateCache::Instance().bindVertexArray(shapes::cube::VAO());
 
     for(int i(0); i < 6 ; ++i)
     {
@@ -99,10 +101,11 @@ unsigned int LightMap::bakeFromTexture(std::shared_ptr<TextureHDR> texture)
         framebufferManager->clearAll();
 
         glDrawArrays(GL_TRIANGLES, 0, 36);  
+        RenderStatistics::Instance().addDrawCall();
     }
 
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-    glBindVertexArray(0);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    GLStateCache::Instance().bindVertexArray(0);
     framebufferManager->unbindFBO();
 
     // Rendering lightmaps changed the viewport size, so we reset it
@@ -121,13 +124,13 @@ unsigned int LightMap::PBR_Diffuse_convoluteLightMap()
 
     shaderPrograms->use("PBR_Cubemap_Diffuse_Convolution");
     shaderPrograms->setUniformInt("inputCubemap", 1);
-    glActiveTexture(GL_TEXTURE0 + 1);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, _lightMapFBO->getColorAttachmentID(0));
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 1);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_CUBE_MAP, _lightMapFBO->getColorAttachmentID(0));
     
     shaderPrograms->setUniformMat4("projectionMatrix", captureProjection);
 
     glViewport(0,0,_size/_scale,_size/_scale);
-    glBindVertexArray(shapes::cube::VAO());
+    GLStateCache::Instance().bindVertexArray(shapes::cube::VAO());
 
     for(int i(0); i < 6 ; ++i)
     {
@@ -137,10 +140,11 @@ unsigned int LightMap::PBR_Diffuse_convoluteLightMap()
         framebufferManager->clearAll();
 
         glDrawArrays(GL_TRIANGLES, 0, 36);  
+        RenderStatistics::Instance().addDrawCall();
     }
 
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-    glBindVertexArray(0);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    GLStateCache::Instance().bindVertexArray(0);
     framebufferManager->unbindFBO();
 
     // Rendering irradiance maps changed the viewport size, so we reset it
@@ -160,14 +164,14 @@ unsigned int LightMap::PBR_Specular_convoluteLightMap()
     shaderPrograms->use("PBR_Cubemap_Specular_Convolution");
 
     shaderPrograms->setUniformInt("inputCubemap", 1);
-    glActiveTexture(GL_TEXTURE0 + 1);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, _lightMapFBO->getColorAttachmentID(0));
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 1);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_CUBE_MAP, _lightMapFBO->getColorAttachmentID(0));
 
     shaderPrograms->setUniformMat4("projectionMatrix", captureProjection);
 
     unsigned int mipLevels = 5u;
 
-    glBindVertexArray(shapes::cube::VAO());
+    GLStateCache::Instance().bindVertexArray(shapes::cube::VAO());
 
     for(unsigned int mip(0); mip < mipLevels; ++mip)
     {
@@ -189,10 +193,11 @@ unsigned int LightMap::PBR_Specular_convoluteLightMap()
             framebufferManager->clearAll();
 
             glDrawArrays(GL_TRIANGLES, 0, 36);  
+            RenderStatistics::Instance().addDrawCall();
         }
     }
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-    glBindVertexArray(0);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    GLStateCache::Instance().bindVertexArray(0);
     framebufferManager->unbindFBO();
 
     // Rendering irradiance maps changed the viewport size, so we reset it
@@ -213,10 +218,11 @@ unsigned int LightMap::PBR_Specular_BRDF_LUT()
     glViewport(0,0,512u,512u);
     shaderPrograms->use("PBR_BRDF_LUT_generator");
     
-    glBindVertexArray(shapes::quad::VAO());
+    GLStateCache::Instance().bindVertexArray(shapes::quad::VAO());
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    RenderStatistics::Instance().addDrawCall();
 
-    glBindVertexArray(0);
+    GLStateCache::Instance().bindVertexArray(0);
     framebufferManager->unbindFBO();
 
     // Rendering the LUT changed the viewport size, so we reset it
@@ -1,5 +1,7 @@
 #include "rendering/framebuffer/FBO.hpp"
 
+#include "rendering/GLStateCache.hpp"
+
 FBO::FBO(E_AttachmentTemplate format, unsigned int width, unsigned int height) : 
     _id(-1),
     _originalSize({width, height}),
@@ -119,7 +121,7 @@ ColorAttachment FBO::addColorAttachment(E_AttachmentTypes type,  E_ColorFormat c
         case E_AttachmentTypes::CUBEMAP:
 
             glGenTextures(1, &_textureId);
-            glBindTexture(GL_TEXTURE_CUBE_MAP, _textureId);
+            GLStateCache::Instance().bindTexture(GL_TEXTURE_CUBE_MAP, _textureId);
 
             for (unsigned int i = 0; i < 6 ; ++i)
             {
@@ -141,14 +143,14 @@ ColorAttachment FBO::addColorAttachment(E_AttachmentTypes type,  E_ColorFormat c
             glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-            glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+            GLStateCache::Instance().bindTexture(GL_TEXTURE_CUBE_MAP, 0);
             break;
 
         case E_AttachmentTypes::TEXTURE:
         default:
 
             glGenTextures(1, &_textureId);
-            glBindTexture(GL_TEXTURE_2D, _textureId);
+            GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, _textureId);
 
             glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, getOriginalSize()[0], getOriginalSize()[1], 0, format, dataType, NULL);
             
@@ -160,7 +162,7 @@ ColorAttachment FBO::addColorAttachment(E_AttachmentTypes type,  E_ColorFormat c
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE); 
 
-            glBindTexture(GL_TEXTURE_2D, 0);
+            GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, 0);
             break;
     }
 
@@ -175,11 +177,11 @@ Attachment FBO::addDepthAttachment(E_AttachmentTypes type)
         case E_AttachmentTypes::TEXTURE:
             if(_depthAttachment.id != -1)
             {
-                glDeleteTextures(1, &_depthAttachment.id);
+                GLStateCache::Instance().deleteTextures(1, &_depthAttachment.id);
             }
             
             glGenTextures(1, &attachment_id);
-            glBindTexture(GL_TEXTURE_2D, attachment_id);
+            GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, attachment_id);
 
             glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, getOriginalSize()[0], getOriginalSize()[1], 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
 
@@ -202,7 +204,7 @@ Attachment FBO::addDepthAttachment(E_AttachmentTypes type)
 
             glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, attachment_id, 0);
 
-            glBindTexture(GL_TEXTURE_2D, 0);
+            GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, 0);
             break;
         case E_AttachmentTypes::RENDERBUFFER:
             if(_depthAttachment.id != -1)
@@ -221,10 +223,10 @@ Attachment FBO::addDepthAttachment(E_AttachmentTypes type)
         case E_AttachmentTypes::CUBEMAP:
             if(_depthAttachment.id != -1)
             {
-                glDeleteTextures(1, &_depthAttachment.id);
+                GLStateCache::Instance().deleteTextures(1, &_depthAttachment.id);
             }
             glGenTextures(1, &attachment_id);
-            glBindTexture(GL_TEXTURE_CUBE_MAP, attachment_id);
+            GLStateCache::Instance().bindTexture(GL_TEXTURE_CUBE_MAP, attachment_id);
 
             for(unsigned int i = 0; i < 6; ++i)
             {
@@ -242,7 +244,7 @@ Attachment FBO::addDepthAttachment(E_AttachmentTypes type)
             glDrawBuffer(GL_NONE);  // Framebuffers have a colorbuffer requirement, but we don't need it. In order to guarantee that at least a Depth buffer is created, we need to specify GL_NONE as the colorbuffer inside this function.
             glReadBuffer(GL_NONE);
 
-            glBindTexture(GL_TEXTURE_2D, 0);
+            GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, 0);
             break;
         case E_AttachmentTypes::NONE:
         default:
@@ -261,11 +263,11 @@ Attachment FBO::addStencilAttachment(E_AttachmentTypes type)
 
             if(_stencilAttachment.id != -1)
             {
-                glDeleteTextures(1, &_stencilAttachment.id);
+                GLStateCache::Instance().deleteTextures(1, &_stencilAttachment.id);
             }
 
             glGenTextures(1, &id);
-            glBindTexture(GL_TEXTURE_2D, id);
+            GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, id);
 
             glTexImage2D(GL_TEXTURE_2D, 0, GL_STENCIL_INDEX, getOriginalSize()[0], getOriginalSize()[1], 0, GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, NULL);
 
@@ -274,7 +276,7 @@ Attachment FBO::addStencilAttachment(E_AttachmentTypes type)
 
             glFramebufferTexture2D(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_TEXTURE_2D, id, 0);
 
-            glBindTexture(GL_TEXTURE_2D, 0);
+            GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, 0);
             break;
 
         case E_AttachmentTypes::RENDERBUFFER:
@@ -304,7 +306,7 @@ void FBO::reset()
     // Color attachments
     for(auto texture : _colorAttachments)
     {
-        glDeleteTextures(1, &texture.id);
+        GLStateCache::Instance().deleteTextures(1, &texture.id);
     }
     _colorAttachments.clear();
 
@@ -314,7 +316,7 @@ void FBO::reset()
         switch(_framebufferTemplate[1])
         {
             case E_AttachmentTypes::TEXTURE:
-                glDeleteTextures(1, &_depthAttachment.id);
+                GLStateCache::Instance().deleteTextures(1, &_depthAttachment.id);
                 break;
             case E_AttachmentTypes::RENDERBUFFER:
                 glDeleteRenderbuffers(1, &_depthAttachment.id);
@@ -331,7 +333,7 @@ void FBO::reset()
         switch(_framebufferTemplate[2])
         {
             case E_AttachmentTypes::TEXTURE:
-                glDeleteTextures(1, &_stencilAttachment.id);
+                GLStateCache::Instance().deleteTextures(1, &_stencilAttachment.id);
                 break;
             case E_AttachmentTypes::RENDERBUFFER:
                 glDeleteRenderbuffers(1, &_stencilAttachment.id);
@@ -2,9 +2,10 @@
 
 #include "GraphicalEngine.hpp"
 #include "rendering/Settings.hpp"
-#include "rendering/engineModules/InstancingManager.hpp"
 #include "rendering/libraries/TextureLibrary.hpp"
 #include "rendering/shader/ShaderLibrary.hpp"
+#include "rendering/RenderStatistics.hpp"
+#include "rendering/GLStateCache.hpp"
 
 
 FBOManager::FBOManager(GraphicalEngine *engine) : 
@@ -115,19 +116,37 @@ void FBOManager::parseNewScene(std::shared_ptr<Scene> scene)
     {
         std::shared_ptr<FBO> fbo = addFBO(E_AttachmentTemplate::TEXTURE, _ranFrom->getViewportSize()[0], _ranFrom->getViewportSize()[1]);
         fbo->bindToViewportSize(true);
-        fbo->addAttachment(E_AttachmentSlot::COLOR, E_ColorFormat::RGBA16F);
-        if(_ranFrom->getSettings()->getBloom() == E_Setting::ON)
-        {
-            fbo->addAttachment(E_AttachmentSlot::COLOR, E_ColorFormat::RGBA16F);
-        }
-        fbo->addAttachment(E_AttachmentSlot::DEPTH);
-        //fbo->addAttachment(E_AttachmentSlot::STENCIL);
 
         bindSceneToFBO(scene, fbo);
+        resetSceneFBO(scene);
         bindProperFBOFromScene(scene);
     }
 }
 
+void FBOManager::resetSceneFBO(std::shared_ptr<Scene> scene)
+{
+    std::shared_ptr<FBO> fbo = getSceneFBO(scene);
+    if(fbo == nullptr)
+    {
+        return;
+    }
+
+    fbo->reset();
+    fbo->addAttachment(E_AttachmentSlot::COLOR, E_ColorFormat::RGBA16F);
+    if(_ranFrom->getSettings()->getBloom() == E_Setting::ON)
+    {
+        fbo->addAttachment(E_AttachmentSlot::COLOR, E_ColorFormat::RGBA16F);
+    }
+    // Always the last two, weighted blended transparency accumulates its color and revealage there
+    if(_ranFrom->getSettings()->getOrderIndependentTransparency() == E_Setting::ON)
+    {
+        fbo->addAttachment(E_AttachmentSlot::COLOR, E_ColorFormat::RGBA16F);
+        fbo->addAttachment(E_AttachmentSlot::COLOR, E_ColorFormat::RED);
+    }
+    fbo->addAttachment(E_AttachmentSlot::DEPTH);
+    //fbo->addAttachment(E_AttachmentSlot::STENCIL);
+}
+
 bool FBOManager::bindSceneToFBO(std::shared_ptr<Scene> scene, std::shared_ptr<FBO> fbo)
 {
     if(fbo == nullptr)
@@ -222,51 +241,35 @@ void FBOManager::renderModel(ModelObject &model)
 {
     std::shared_ptr<ShaderLibrary> shaderLibrary = _ranFrom->getShaderLibrary();
 
-    shaderLibrary->setUniformMat4("model", model.getModelMatrix());
-
-    for (auto &one_mesh : model.getModel()->meshes)
+    const auto& meshes = model.getModel()->meshes;
+    for (size_t i = 0; i < meshes.size(); ++i)
     {
+        const std::shared_ptr<Mesh>& one_mesh = meshes[i];
+        shaderLibrary->setUniformMat4("model", model.getMeshMatrix(i));
         _ranFrom->getTextureLibrary()->bindTextures(one_mesh);
-        glBindVertexArray(one_mesh->VAO);
+        GLStateCache::Instance().bindVertexArray(one_mesh->VAO);
         int vertexCount = static_cast<int>(one_mesh->_indices.size());
-        glDrawElements(GL_TRIANGLES, vertexCount, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-
-        glBindTexture(GL_TEXTURE_2D, 0); // Unbind texture
-    }
-}
-
-void FBOManager::renderInstancedMeshes()
-{
-    std::shared_ptr<InstancingManager> instancingManager = _ranFrom->getInstancingManager();
-
-    for(auto& instancingGroup : instancingManager->getInstancingGroups())
-    {
-        _ranFrom->getTextureLibrary()->bindTextures(instancingGroup.second.mesh); 
-        glBindVertexArray(instancingGroup.second.mesh->VAO);
-        int vertexCount = static_cast<int>(instancingGroup.second.mesh->_indices.size());
-        int instanceCount = static_cast<int>(instancingGroup.second.modelObjects.size());
-        glDrawElementsInstanced(GL_TRIANGLES, vertexCount, GL_UNSIGNED_INT, 0, instanceCount);
+        glDrawElementsBaseVertex(GL_TRIANGLES, vertexCount, GL_UNSIGNED_INT, (void*)(one_mesh->firstIndex * sizeof(unsigned int)), static_cast<int>(one_mesh->baseVertex));
+        RenderStatistics::Instance().addDrawCall();
     }
-    // Unbind the VAO
-    glBindVertexArray(0);
 }
 
 void FBOManager::renderSkybox(Cubemap& cubemap)
 {
     std::shared_ptr<ShaderLibrary> shaderLibrary = _ranFrom->getShaderLibrary();
 
-    glDepthFunc(GL_LEQUAL);
+    GLStateCache::Instance().depthFunc(GL_LEQUAL);
 
     shaderLibrary->setUniformInt("skyboxCube", 0);
-    glActiveTexture(GL_TEXTURE0 + 0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap.getTexture()._id);
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_CUBE_MAP, cubemap.getTexture()._id);
 
-    glBindVertexArray(cubemap.VAO);
+    GLStateCache::Instance().bindVertexArray(cubemap.VAO);
     glDrawArrays(GL_TRIANGLES, 0, 36);
+    RenderStatistics::Instance().addDrawCall();
 
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-    glActiveTexture(GL_TEXTURE0);
-    glDepthFunc(GL_LESS);
+    GLStateCache::Instance().bindVertexArray(0);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0);
+    GLStateCache::Instance().depthFunc(GL_LESS);
 }
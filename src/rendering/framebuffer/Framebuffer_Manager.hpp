@@ -32,6 +32,8 @@ public:
     unsigned int getFBOIndex(std::shared_ptr<FBO> fbo) const;
 
     void parseNewScene(std::shared_ptr<Scene> scene);
+    // Restore the default forward layout of the scene FBO, according to the current Settings
+    void resetSceneFBO(std::shared_ptr<Scene> scene);
     bool bindSceneToFBO(std::shared_ptr<Scene> scene, std::shared_ptr<FBO> fbo);
     bool unbindSceneFromFBO(std::shared_ptr<Scene> scene);
 
@@ -49,7 +51,6 @@ public:
 
     // Render Calls
     void renderModel(ModelObject &model);
-	void renderInstancedMeshes();
 	void renderSkybox(Cubemap& cubemap);
 
 private:
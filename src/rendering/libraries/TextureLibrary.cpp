@@ -3,6 +3,7 @@
 #include "GraphicalEngine.hpp"
 #include "rendering/shader/ShaderLibrary.hpp"
 #include "rendering/Settings.hpp"
+#include "rendering/GLStateCache.hpp"
 
 #include "util/VertexShapes.hpp"
 
@@ -18,7 +19,7 @@ std::shared_ptr<Texture> TextureLibrary::generate_GL_texture(Texture &texture)
 
     // load and create a texture
     glGenTextures(1, &texture._id);
-    glBindTexture(GL_TEXTURE_2D, texture._id);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, texture._id);
     // set the texture wrapping parameters
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -45,7 +46,7 @@ std::shared_ptr<TextureHDR> TextureLibrary::generate_GL_textureHDR(TextureHDR& t
 
     // load and create a texture
     glGenTextures(1, &texture._id);
-    glBindTexture(GL_TEXTURE_2D, texture._id);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, texture._id);
     // set the texture wrapping parameters
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);	
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);	
@@ -75,7 +76,7 @@ std::shared_ptr<Cubemap> TextureLibrary::generate_GL_cubemap(Cubemap &cubemap, c
 
     Texture& cubemapTexture = cubemap.getTexture();
     glGenTextures(1, &cubemapTexture._id);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture._id);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture._id);
 
     // load and create a texture
     for (int i(0); i < textures.size() ; ++i)
@@ -89,7 +90,7 @@ std::shared_ptr<Cubemap> TextureLibrary::generate_GL_cubemap(Cubemap &cubemap, c
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0); // Unbind texture
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_CUBE_MAP, 0); // Unbind texture
 
     std::shared_ptr<Cubemap> texturePtr = std::make_shared<Cubemap>(cubemap);
 
@@ -98,6 +99,11 @@ std::shared_ptr<Cubemap> TextureLibrary::generate_GL_cubemap(Cubemap &cubemap, c
 }
 
 void TextureLibrary::bindTextures(std::shared_ptr<Mesh> mesh)
+{
+    bindTextures(*mesh);
+}
+
+void TextureLibrary::bindTextures(const Mesh& mesh)
 {
     std::shared_ptr<ShaderLibrary> shaderLibrary = _ranFrom->getShaderLibrary();
     std::shared_ptr<Settings> settings = _ranFrom->getSettings();
@@ -109,35 +115,35 @@ void TextureLibrary::bindTextures(std::shared_ptr<Mesh> mesh)
 
     shaderLibrary->setUniformFloat("material.shininess", 4.5f);
 
-    if (mesh->_textures.size() == 0)
+    if (mesh._textures.size() == 0)
     {
         return;
     }
 
-    for (int i = 0; i < mesh->_textures.size(); i++)
+    for (int i = 0; i < mesh._textures.size(); i++)
     {
 
-        switch (mesh->_textures[i]._type)
+        switch (mesh._textures[i]._type)
         {
         case DIFFUSE:
             shaderLibrary->setUniformInt("sampleFromDiffuse", 1);
             shaderLibrary->setUniformInt("material.diffuse", 1);
-            glActiveTexture(GL_TEXTURE0 + 1);
-            glBindTexture(GL_TEXTURE_2D, mesh->_textures[i]._id);
+            GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 1);
+            GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, mesh._textures[i]._id);
             break;
         case SPECULAR:
             shaderLibrary->setUniformInt("sampleFromSpecular", 1);
             shaderLibrary->setUniformInt("material.specular", 2);
-            glActiveTexture(GL_TEXTURE0 + 2);
-            glBindTexture(GL_TEXTURE_2D, mesh->_textures[i]._id);
+            GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 2);
+            GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, mesh._textures[i]._id);
             break;
         case NORMAL:
             if(settings->getNormalMapping() == E_Setting::ON)
             {
                 shaderLibrary->setUniformInt("sampleFromNormal", 1);
                 shaderLibrary->setUniformInt("material.normal", 3);
-                glActiveTexture(GL_TEXTURE0 + 3);
-                glBindTexture(GL_TEXTURE_2D, mesh->_textures[i]._id);
+                GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 3);
+                GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, mesh._textures[i]._id);
             }
             break;
         case HEIGHT:
@@ -145,26 +151,26 @@ void TextureLibrary::bindTextures(std::shared_ptr<Mesh> mesh)
             {
                 shaderLibrary->setUniformInt("sampleFromHeight", 1);
                 shaderLibrary->setUniformInt("material.height", 4);
-                glActiveTexture(GL_TEXTURE0 + 4);
-                glBindTexture(GL_TEXTURE_2D, mesh->_textures[i]._id);
+                GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 4);
+                GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, mesh._textures[i]._id);
             }
             break;
         case ROUGHNESS:
             shaderLibrary->setUniformInt("sampleFromRoughness", 1);
             shaderLibrary->setUniformInt("material.roughness", 5);
-            glActiveTexture(GL_TEXTURE0 + 5);
-            glBindTexture(GL_TEXTURE_2D, mesh->_textures[i]._id);
+            GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 5);
+            GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, mesh._textures[i]._id);
             break;
         case LIGHTMAP:
             shaderLibrary->setUniformInt("sampleFromLightmap", 1);
             shaderLibrary->setUniformInt("material.lightmap", 6);
-            glActiveTexture(GL_TEXTURE0 + 6);
-            glBindTexture(GL_TEXTURE_2D, mesh->_textures[i]._id);
+            GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 6);
+            GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, mesh._textures[i]._id);
             break;
         case CUBEMAP:
             shaderLibrary->setUniformInt("cubemap", 5);
-            glActiveTexture(GL_TEXTURE0 + 5);
-            glBindTexture(GL_TEXTURE_CUBE_MAP, mesh->_textures[i]._id);
+            GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 5);
+            GLStateCache::Instance().bindTexture(GL_TEXTURE_CUBE_MAP, mesh._textures[i]._id);
             break;
         default:
             break;
@@ -21,6 +21,7 @@ public:
     std::shared_ptr<Cubemap> generate_GL_cubemap(Cubemap &cubemap, const std::array<Texture, 6>& textures);
 
     void bindTextures(std::shared_ptr<Mesh> mesh);
+    void bindTextures(const Mesh& mesh);
 
 private:
 
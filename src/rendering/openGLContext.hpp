@@ -15,6 +15,11 @@
 // Third-party includes
 #include <stb_image.h>
 
+#ifdef FLUXLUMINA_HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
 namespace openGLContext
 {
     GLFWwindow* window;
@@ -25,6 +30,12 @@ namespace openGLContext
     int CreateOpenGLWindow();
     int InitializeOpenGLContext();
 
+#ifdef FLUXLUMINA_HEADLESS_EGL
+    // The headless context is shared by every engine instance of the process
+    EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+    EGLContext eglContext = EGL_NO_CONTEXT;
+#endif
+
     std::array<float, 100> deltaFrameTimes = {0.0f};
     unsigned int deltaFrameTimeIndex = 0;
 
@@ -100,4 +111,84 @@ GLFWwindow *InitializeOpenGLContext()
     stbi_image_free(images[0].pixels);
 
     return window;
+}
+
+bool InitializeHeadlessOpenGLContext()
+{
+#ifdef FLUXLUMINA_HEADLESS_EGL
+    using namespace openGLContext;
+
+    // Context already exists, just make sure it is the current one
+    if(eglContext != EGL_NO_CONTEXT)
+    {
+        return eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext) == EGL_TRUE;
+    }
+
+    // Prefer Mesa's surfaceless platform, it needs neither a display server nor a GPU (llvmpipe)
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if(getPlatformDisplay)
+    {
+        eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if(eglDisplay == EGL_NO_DISPLAY)
+    {
+        eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major, minor;
+    if(eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor))
+    {
+        std::cout << "Failed to initialize EGL display" << std::endl;
+        return false;
+    }
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint configCount = 0;
+    if(!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0)
+    {
+        std::cout << "Failed to find a suitable EGL config" << std::endl;
+        return false;
+    }
+
+    eglBindAPI(EGL_OPENGL_API);
+
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+
+    eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+    if(eglContext == EGL_NO_CONTEXT)
+    {
+        std::cout << "Failed to create EGL context" << std::endl;
+        return false;
+    }
+
+    // No surface at all, everything is rendered into FBOs (EGL_KHR_surfaceless_context)
+    if(!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext))
+    {
+        std::cout << "Failed to make the EGL context current" << std::endl;
+        return false;
+    }
+
+    /* Initialize glad */
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return false;
+    }
+
+    return true;
+#else
+    std::cout << "Headless rendering is not available, FluxLumina was built without EGL" << std::endl;
+    return false;
+#endif
 }
\ No newline at end of file
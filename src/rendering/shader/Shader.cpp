@@ -1,5 +1,7 @@
 #include "rendering/shader/Shader.hpp"
 
+#include "rendering/GLStateCache.hpp"
+
 #include <glm\gtc\type_ptr.hpp>
 #include <fstream>
 #include <string>
@@ -9,22 +11,25 @@ Shader::Shader(const std::string & vertexShaderFilename,
                const std::string & fragmentShaderFilename,
                const std::string & geometryShaderFilename, 
                const std::string & tessellationControlShaderFilename, 
-               const std::string & tessellationEvaluationShaderFilename) 
+               const std::string & tessellationEvaluationShaderFilename,
+               const std::string & computeShaderFilename) 
                : program_id(0), 
                  isLinked(false),
                  _name("")
 {
-    const std::string shaderCodes[5] = { loadFile(vertexShaderFilename), 
+    const std::string shaderCodes[6] = { loadFile(vertexShaderFilename), 
                                          loadFile(fragmentShaderFilename), 
                                          loadFile(geometryShaderFilename),
                                          loadFile(tessellationControlShaderFilename),
-                                         loadFile(tessellationEvaluationShaderFilename) };
+                                         loadFile(tessellationEvaluationShaderFilename),
+                                         loadFile(computeShaderFilename) };
 
-    const std::string filenames[5] = { vertexShaderFilename, 
+    const std::string filenames[6] = { vertexShaderFilename, 
                                        fragmentShaderFilename, 
                                        geometryShaderFilename,
                                        tessellationControlShaderFilename,
-                                       tessellationEvaluationShaderFilename };
+                                       tessellationEvaluationShaderFilename,
+                                       computeShaderFilename };
 
     program_id = glCreateProgram();
 
@@ -59,6 +64,9 @@ Shader::Shader(const std::string & vertexShaderFilename,
         else
         if (i == 4)
             shaderType = GL_TESS_EVALUATION_SHADER;
+        else
+        if (i == 5)
+            shaderType = GL_COMPUTE_SHADER;
 
         if (shaderType == 0)
         {
@@ -114,7 +122,7 @@ Shader::~Shader()
 {
     if (program_id != 0)
     {
-        glDeleteProgram(program_id);
+        GLStateCache::Instance().deleteProgram(program_id);
         program_id = 0;
     }
 }
@@ -146,6 +154,18 @@ bool Shader::link()
     else
     {
         isLinked = true;
+
+        // Programs reading the per-instance matrix are drawn in instancing groups, the attribute is only active when used
+        if(glGetAttribLocation(program_id, "instanceMatrix") == instanceMatrixLocation)
+        {
+            addSupportedFeature(E_ShaderProgramFeatures::E_AUTO_INSTANCING);
+        }
+
+        // Only programs walking the cluster lists get them rebuilt, the tiled deferred pass culls the light buffer itself
+        if(glGetProgramResourceIndex(program_id, GL_SHADER_STORAGE_BLOCK, "ClusterGrid") != GL_INVALID_INDEX)
+        {
+            addSupportedFeature(E_ShaderProgramFeatures::E_CLUSTERED_LIGHTING);
+        }
     }
 
     return isLinked;
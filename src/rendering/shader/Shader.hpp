@@ -11,19 +11,24 @@
 
 enum class E_ShaderProgramFeatures
 {
-    E_AUTO_INSTANCING,
-    E_TRANSPARENCY
+    E_AUTO_INSTANCING,  // Set on link for every program reading the instanceMatrix attribute
+    E_TRANSPARENCY,
+    E_CLUSTERED_LIGHTING    // Set on link for every program reading the cluster grid of LightClusters
 };
 
 
 class Shader
 {
 public:
+    // First of the four locations of the per-instance mat4 fed by the indirect draws
+    static constexpr GLint instanceMatrixLocation = 5;
+
     Shader(const std::string & vertexShaderFilename,
            const std::string & fragmentShaderFilename,
            const std::string & geometryShaderFilename               = "",
            const std::string & tessellationControlShaderFilename    = "",
-           const std::string & tessellationEvaluationShaderFilename = "");
+           const std::string & tessellationEvaluationShaderFilename = "",
+           const std::string & computeShaderFilename                = "");
 
     virtual ~Shader();
 
@@ -1,5 +1,6 @@
 #include "rendering/shader/ShaderLibrary.hpp"
 #include "helpers/RootDir.hpp"
+#include "rendering/GLStateCache.hpp"
 
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
@@ -18,7 +19,15 @@ ShaderLibrary::~ShaderLibrary()
 {
     for(auto& shader : _shaders)
     {
-        glDeleteProgram(shader->getProgramId());
+        GLStateCache::Instance().deleteProgram(shader->getProgramId());
+    }
+
+    // Binding points are shared by every library of the process, give them back
+    for(auto& buffer : _uniformBuffers)
+    {
+        buffer.removeBindingPoint();
+        unsigned int UBO = buffer.id();
+        glDeleteBuffers(1, &UBO);
     }
 }
 
@@ -79,7 +88,7 @@ std::shared_ptr<Shader> ShaderLibrary::getShader(unsigned int index)
     }
 }
 
-std::vector<std::shared_ptr<Shader>> ShaderLibrary::getShaders()
+const std::vector<std::shared_ptr<Shader>>& ShaderLibrary::getShaders() const
 {
     return _shaders;
 }
@@ -135,19 +144,19 @@ size_t ShaderLibrary::size() const
 void ShaderLibrary::use(unsigned int index)
 {
     _activeShader = index;
-    glUseProgram(_shaders[_activeShader]->getProgramId());
+    GLStateCache::Instance().useProgram(_shaders[_activeShader]->getProgramId());
 }
 
 void ShaderLibrary::use(const std::string &name)
 {
     _activeShader = getShaderIndex(name);
-    glUseProgram(_shaders[_activeShader]->getProgramId());
+    GLStateCache::Instance().useProgram(_shaders[_activeShader]->getProgramId());
 }
 
 void ShaderLibrary::use(const std::shared_ptr<Shader> &shader)
 {
     _activeShader = getShaderIndex(shader->getName());
-    glUseProgram(_shaders[_activeShader]->getProgramId());
+    GLStateCache::Instance().useProgram(_shaders[_activeShader]->getProgramId());
 }
 
 unsigned int ShaderLibrary::scan(const std::string &foldername)
@@ -195,6 +204,7 @@ unsigned int ShaderLibrary::recursiveScanFolder(const std::string& folderName, u
     std::string geometryShaderFilename = "";
     std::string tessellationControlShaderFilename = "";
     std::string tessellationEvaluationShaderFilename = "";
+    std::string computeShaderFilename = "";
 
     // Iterate through the entire folder content
     for(auto& item : boost::filesystem::directory_iterator(folderName))
@@ -252,6 +262,14 @@ unsigned int ShaderLibrary::recursiveScanFolder(const std::string& folderName, u
                 }
                 tessellationEvaluationShaderFilename = folderName + "/" + filename + ".tese";
             }
+            else if (extension == ".comp")
+            {
+                if(computeShaderFilename != "")
+                {
+                    return 0; //Multiple compute shaders found for shader program name
+                }
+                computeShaderFilename = folderName + "/" + filename + ".comp";
+            }
             else
             {
                 continue;
@@ -259,7 +277,8 @@ unsigned int ShaderLibrary::recursiveScanFolder(const std::string& folderName, u
         }
     }
 
-    if(vertexShaderFilename == "" || fragmentShaderFilename == "")
+    // Compute programs stand alone, every other program needs at least a vertex and a fragment shader
+    if(computeShaderFilename == "" && (vertexShaderFilename == "" || fragmentShaderFilename == ""))
     {
         return importedShaderPrograms; // No vertex or fragment shader found for shader program name
     }
@@ -268,7 +287,8 @@ unsigned int ShaderLibrary::recursiveScanFolder(const std::string& folderName, u
                                                             fragmentShaderFilename,
                                                             geometryShaderFilename,
                                                             tessellationControlShaderFilename,
-                                                            tessellationEvaluationShaderFilename);
+                                                            tessellationEvaluationShaderFilename,
+                                                            computeShaderFilename);
     shader->setName(shaderProgramName);
 
     _shaders.emplace_back(shader);
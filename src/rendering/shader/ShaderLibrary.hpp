@@ -34,7 +34,7 @@ public:
     // Shader management
     std::shared_ptr<Shader> getShader(unsigned int index);
     std::shared_ptr<Shader> getShader(const std::string &name);
-    std::vector<std::shared_ptr<Shader>> getShaders();
+    const std::vector<std::shared_ptr<Shader>>& getShaders() const;
     unsigned int getShaderIndex(const std::string &name) const;
     std::set<unsigned int> getShaderIndexesPerFeature() const;
     std::set<unsigned int> getShaderIndexesPerFeature(E_ShaderProgramFeatures feature) const;
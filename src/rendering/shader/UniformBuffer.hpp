@@ -15,6 +15,7 @@
 
 // First party includes
 #include "util/Arithmetic.hpp"
+#include "util/Profiler.hpp"
 #include "rendering/shader/ShaderLibraryContents.hpp"
 
 
@@ -220,6 +221,8 @@ public:
     template <typename... Types>
     void update(const std::tuple<Types...> &object)
     {
+        FLUX_PROFILE_ZONE("UniformBuffer::update");
+
         if(!_shaderUniformSize)
         {
             createBuffer(object);
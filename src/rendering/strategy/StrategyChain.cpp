@@ -4,11 +4,16 @@
 #include "rendering/Settings.hpp"
 #include "rendering/framebuffer/Framebuffer_Manager.hpp"
 #include "rendering/engineModules/InstancingManager.hpp"
+#include "rendering/engineModules/CullingManager.hpp"
 #include "rendering/shader/ShaderLibrary.hpp"
 #include "rendering/engineModules/LightManager.hpp"
+#include "rendering/GLStateCache.hpp"
+#include "rendering/RenderQueue.hpp"
+#include "scene/Scene.hpp"
 
 
 #include "util/VertexShapes.hpp"
+#include "util/Profiler.hpp"
 
 StrategyChain::StrategyChain(GraphicalEngine* engine) : 
     _ranFrom(engine),
@@ -20,12 +25,15 @@ StrategyChain::StrategyChain(GraphicalEngine* engine) :
 bool StrategyChain::add(std::shared_ptr<StrategyNode> node)
 {
     _nodes.push_back(node);
+    _profilerPasses.push_back(_gpuProfiler.registerPass(node->name()));
     return true;
 }
 
 void StrategyChain::clear()
 {
     _nodes.clear();
+    _profilerPasses.clear();
+    _gpuProfiler.clear();
 }
 
 void StrategyChain::run()
@@ -37,10 +45,48 @@ void StrategyChain::run()
         _firstRun = false;
     }
 
+    // Gather the draw packets of every node, then sort them all at once
+    {
+        FLUX_PROFILE_ZONE("RenderQueue::build");
+        std::shared_ptr<Scene> scene = _ranFrom->getScene();
+
+        // Culling needs this frame's frustum, CameraSetupNode only runs after the packets are emitted
+        scene->getActiveCamera()->recalculateMVP();
+        _ranFrom->getCullingManager()->update(*scene);
+        // Models added, removed or given another shader since the last frame
+        _ranFrom->getInstancingManager()->update(*scene, *_ranFrom->getShaderLibrary());
+
+        std::shared_ptr<RenderQueue> renderQueue = _ranFrom->getRenderQueue();
+        renderQueue->clear(scene->getActiveCamera()->getFarPlane());
+        for (auto& node : _nodes)
+        {
+            node->emit(*renderQueue);
+        }
+        renderQueue->sort();
+    }
+
+    if(_ranFrom->getSettings()->getGPUProfiling() == E_Setting::OFF)
+    {
+        for (auto& node : _nodes)
+        {
+            FLUX_PROFILE_ZONE(node->name());
+            node->run();
+        }
+        return;
+    }
+
+    _gpuProfiler.beginFrame();
+
+    unsigned int passIndex = 0;
     for (auto& node : _nodes)
     {
+        FLUX_PROFILE_ZONE(node->name());
+        _gpuProfiler.beginPass(_profilerPasses[passIndex++]);
         node->run();
+        _gpuProfiler.endPass();
     }
+
+    _gpuProfiler.endFrame();
 }
 
 GraphicalEngine* StrategyChain::engine() const
@@ -63,7 +109,14 @@ ForwardShadingStrategyChain::ForwardShadingStrategyChain(GraphicalEngine* engine
         // Rendering
         add(std::make_shared<RenderSkyboxNode>(this));
         add(std::make_shared<RenderOpaqueNode>(this));
-        add(std::make_shared<RenderTransparentNode>(this));
+        if(_ranFrom->getSettings()->getOrderIndependentTransparency() == E_Setting::ON)
+        {
+            add(std::make_shared<WeightedBlendedTransparencyNode>(this));
+        }
+        else
+        {
+            add(std::make_shared<RenderTransparentNode>(this));
+        }
         // Post-processing
         if(_ranFrom->getSettings()->getBloom() == E_Setting::ON)
         {
@@ -82,7 +135,10 @@ bool ForwardShadingStrategyChain::reserveResources()
     std::shared_ptr<InstancingManager> instancingManager = _ranFrom->getInstancingManager();
     std::shared_ptr<ShaderLibrary> shaderLibrary = _ranFrom->getShaderLibrary();
 
-    instancingManager->setupInstancing(shaderLibrary->getShader("Basic")->getProgramId(), _ranFrom->getScene(0));
+    // Another strategy may have left a different layout behind, bloom also needs its extra attachment
+    _ranFrom->getFBOManager()->resetSceneFBO(_ranFrom->getScene());
+
+    instancingManager->setupInstancing(_ranFrom->getScene(0), *shaderLibrary);
 
     return true;
 }
@@ -96,7 +152,7 @@ DeferredShadingStrategyChain::DeferredShadingStrategyChain(GraphicalEngine* engi
 {   
     // Setupsa
     add(std::make_shared<CameraSetupNode>(this));
-    add(std::make_shared<LightsSetupNode>(this, "deferred_light_volumes"));
+    add(std::make_shared<LightsSetupNode>(this, "deferred_tiled_lighting"));
     add(std::make_shared<FramebufferNode>(this));
 
     // Rendering
@@ -108,7 +164,7 @@ DeferredShadingStrategyChain::DeferredShadingStrategyChain(GraphicalEngine* engi
         add(std::make_shared<SSAONode>(this));
     }
     add(std::make_shared<LightPassNode>(this));
-    add(std::make_shared<LightVolumeNode>(this));
+    add(std::make_shared<TiledLightingNode>(this));
 
     // Post-processing
     if(_ranFrom->getSettings()->getHighDynamicRange() == E_Setting::ON)
@@ -176,6 +232,8 @@ bool PBSShadingStrategyChain::reserveResources()
     std::shared_ptr<LightLibrary> lightLibrary = _ranFrom->getLightLibrary();
     std::shared_ptr<FBOManager> framebufferManager = _ranFrom->getFBOManager();
 
+    framebufferManager->resetSceneFBO(_ranFrom->getScene());
+
     int cubemapSize = 2048;
 
     // Create lightmap
@@ -183,7 +241,7 @@ bool PBSShadingStrategyChain::reserveResources()
     unsigned int skyboxTextureID = lightLibrary->getLightMap().bakeFromTexture(_ranFrom->getScene()->getSkybox().getIBLmap());
 
    // Generate environment cubemap mipmaps to facilitate artifact-free filtering
-    glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxTextureID);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_CUBE_MAP, skyboxTextureID);
     glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
 
     // Create diffuse irradiance map
@@ -4,9 +4,11 @@
 #include <list>
 #include <memory>
 #include <tuple>
+#include <vector>
 
 // First-party headers
 #include "rendering/strategy/StrategyNode.hpp"
+#include "rendering/engineModules/GPUProfiler.hpp"
 
 
 class GraphicalEngine;
@@ -23,6 +25,9 @@ public:
 
     GraphicalEngine* engine() const;
 
+    // Per node GPU timings, results lag a few frames behind
+    const GPUProfiler& getGPUProfiler() const { return _gpuProfiler; }
+
     template<typename T>
     std::shared_ptr<T> getNode() const
     {
@@ -45,6 +50,10 @@ protected:
 
 private:
     bool _firstRun;
+
+    // Times each node with GL_TIME_ELAPSED queries, indexed in the same order as _nodes
+    GPUProfiler _gpuProfiler;
+    std::vector<unsigned int> _profilerPasses;
 };
 
 class ForwardShadingStrategyChain : public StrategyChain
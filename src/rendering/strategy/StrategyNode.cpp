@@ -5,6 +5,9 @@
 #include "scene/Scene.hpp"
 
 #include "rendering/shader/ShaderLibrary.hpp"
+#include "rendering/RenderStatistics.hpp"
+#include "rendering/RenderQueue.hpp"
+#include "rendering/GLStateCache.hpp"
 #include "rendering/engineModules/LightManager.hpp"
 #include "rendering/engineModules/InstancingManager.hpp"
 #include "rendering/framebuffer/Framebuffer_Manager.hpp"
@@ -55,6 +58,33 @@ void CameraSetupNode::run()
 /////////////////////////// SHADOWS NODE
 ///////////////////////////////////////////////////////////////////////////////////////////
 
+void ShadowsSetupNode::emit(RenderQueue& queue)
+{
+    std::shared_ptr<Scene> scene = _chain->engine()->getScene();
+    std::shared_ptr<ShaderLibrary> shaderPrograms = _chain->engine()->getShaderLibrary();
+
+    if(_chain->engine()->getSettings()->getShadowGlobal() != E_Setting::ON)
+    {
+        return;
+    }
+
+    // One instance per model, meshes shared by several models are merged into a single instanced command
+    unsigned int shadowShader = shaderPrograms->getShaderIndex("Shadowmap");
+    for (auto& model : scene->getModels())
+    {
+        if(!model->castsShadow())
+        {
+            continue;
+        }
+
+        const auto& meshes = model->getModel()->meshes;
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            queue.add(E_RenderPass::SHADOW, shadowShader, *meshes[i], &model->getMeshMatrix(i), 0.0f, 1);
+        }
+    }
+}
+
 void ShadowsSetupNode::run()
 {
     std::shared_ptr<Scene> scene = _chain->engine()->getScene();
@@ -101,8 +131,15 @@ void LightsSetupNode::run()
     std::shared_ptr<LightLibrary> lightLibrary = _chain->engine()->getLightLibrary();
     std::shared_ptr<ShaderLibrary> shaderPrograms = _chain->engine()->getShaderLibrary();
 
+    const LightContents& lights = scene->getAllLights();
+
     shaderPrograms->use(_ShaderName);
-    lightLibrary->prepare(scene->getAllLights());
+    lightLibrary->prepare(lights);
+
+    if(shaderPrograms->getShader(_ShaderName)->isFeatureSupported(E_ShaderProgramFeatures::E_CLUSTERED_LIGHTING))
+    {
+        lightLibrary->getLightClusters().update(lightLibrary->getLightBuffer(), *scene->getActiveCamera());
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -132,43 +169,73 @@ void FramebufferNode::run()
 /////////////////////////// OPAQUES RENDER NODE
 ///////////////////////////////////////////////////////////////////////////////////////////
 
-void RenderOpaqueNode::run()
+void RenderOpaqueNode::emit(RenderQueue& queue)
 {
     std::shared_ptr<Scene> scene = _chain->engine()->getScene();
     std::shared_ptr<ShaderLibrary> shaderPrograms = _chain->engine()->getShaderLibrary();
-    std::shared_ptr<FBOManager> frameBuffers = _chain->engine()->getFBOManager();
-    //std::shared_ptr<InstancingManager> instancingManager = _chain->engine()->getInstancingManager();
+    std::shared_ptr<InstancingManager> instancingManager = _chain->engine()->getInstancingManager();
 
-    shaderPrograms->use("Basic");
-    frameBuffers->renderInstancedMeshes();
+    const glm::vec3& viewPosition = scene->getActiveCamera()->getPosition();
 
+    const auto& shaders = shaderPrograms->getShaders();
 
-    for(auto shader : shaderPrograms->getShaders())
+    // The GPU culls instanced meshes itself when asked to, it gets every instance
+    bool visibleOnly = _chain->engine()->getSettings()->getGPUCulling() != E_Setting::ON;
+    for(auto& instancingGroup : instancingManager->getInstancingGroups())
     {
-        std::vector<std::shared_ptr<ModelObject>> objectsForThisShader = scene->getModels(shader->getName());
+        unsigned int shaderIndex = instancingGroup.second.shader;
+        if(shaders[shaderIndex]->isFeatureSupported(E_ShaderProgramFeatures::E_TRANSPARENCY))
+        {
+            continue;
+        }
+
+        // One instanced draw per level of detail
+        const auto& levels = instancingGroup.second.transforms(visibleOnly);
+        for(size_t level = 0; level < levels.size(); ++level)
+        {
+            if(!levels[level].empty())
+            {
+                queue.add(E_RenderPass::FORWARD_OPAQUE, shaderIndex, instancingGroup.second.mesh->getLod(level), levels[level].data(), 0.0f, static_cast<unsigned int>(levels[level].size()));
+            }
+        }
+    }
 
+    for(unsigned int shaderIndex = 0; shaderIndex < shaders.size(); ++shaderIndex)
+    {
+        const auto& shader = shaders[shaderIndex];
         if(
-            objectsForThisShader.empty() || 
-            shader->isFeatureSupported(E_ShaderProgramFeatures::E_AUTO_INSTANCING) ||   // Instanced Objects were already rendered
+            shader->isFeatureSupported(E_ShaderProgramFeatures::E_AUTO_INSTANCING) ||   // Instanced Objects are drawn above
             shader->isFeatureSupported(E_ShaderProgramFeatures::E_TRANSPARENCY)         // And transparent ones will be rendered later
             )
         {
             continue;
         }
 
-        shaderPrograms->use(shader);
-
-        for(auto modelObject : objectsForThisShader)
+        for(const auto& modelObject : scene->getModels(shader->getName()))
         {
-            if(!modelObject->enabled())
+            if(!modelObject->isVisible())
             {
                 continue;
             }
-            frameBuffers->renderModel(*modelObject);
+
+            // World position, the object may have a parent
+            float distance = glm::length(viewPosition - glm::vec3(modelObject->getModelMatrix()[3]));
+            const auto& meshes = modelObject->getModel()->meshes;
+            for(size_t i = 0; i < meshes.size(); ++i)
+            {
+                queue.add(E_RenderPass::FORWARD_OPAQUE, shaderIndex, meshes[i]->getLod(modelObject->getMeshLod(i)), &modelObject->getMeshMatrix(i), distance);
+            }
         }
     }
 }
 
+void RenderOpaqueNode::run()
+{
+    std::shared_ptr<RenderQueue> renderQueue = _chain->engine()->getRenderQueue();
+    renderQueue->submit(E_RenderPass::FORWARD_OPAQUE);
+    renderQueue->submitOccluded(E_RenderPass::FORWARD_OPAQUE);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////// SKYBOX RENDER NODE
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -198,38 +265,209 @@ void RenderSkyboxNode::run()
 /////////////////////////// TRANSPARENTS RENDER NODE
 ///////////////////////////////////////////////////////////////////////////////////////////
 
+namespace
+{
+    // To the center of the mesh, submeshes of one model are ordered among themselves
+    float meshDistance(const glm::vec3& viewPosition, const Mesh& mesh, const glm::mat4& transform)
+    {
+        return glm::length(viewPosition - glm::vec3(transform * glm::vec4(mesh._boundingSphere.center, 1.0f)));
+    }
+}
+
+void RenderTransparentNode::emit(RenderQueue& queue)
+{
+    std::shared_ptr<Scene> scene = _chain->engine()->getScene();
+    std::shared_ptr<ShaderLibrary> shaderPrograms = _chain->engine()->getShaderLibrary();
+    std::shared_ptr<InstancingManager> instancingManager = _chain->engine()->getInstancingManager();
+
+    const glm::vec3& viewPosition = scene->getActiveCamera()->getPosition();
+    const auto& shaders = shaderPrograms->getShaders();
+
+    _transparentQueue.clear(scene->getActiveCamera()->getFarPlane());
+
+    // Every visible instance of the instanced groups is sorted on its own, runs of the same mesh are merged back afterwards
+    for(auto& instancingGroup : instancingManager->getInstancingGroups())
+    {
+        const InstancingGroup& group = instancingGroup.second;
+        if(!shaders[group.shader]->isFeatureSupported(E_ShaderProgramFeatures::E_TRANSPARENCY))
+        {
+            continue;
+        }
+
+        for(size_t i = 0; i < group.modelObjects.size(); ++i)
+        {
+            std::shared_ptr<ModelObject> modelObject = group.modelObjects[i].lock();
+            if(!modelObject || !modelObject->isVisible())
+            {
+                continue;
+            }
+
+            const glm::mat4& transform = modelObject->getMeshMatrix(group.meshIndices[i]);
+            _transparentQueue.add(group.shader, *group.mesh, &transform, meshDistance(viewPosition, *group.mesh, transform), true);
+        }
+    }
+
+    for(unsigned int shaderIndex = 0; shaderIndex < shaders.size(); ++shaderIndex)
+    {
+        if(
+            !shaders[shaderIndex]->isFeatureSupported(E_ShaderProgramFeatures::E_TRANSPARENCY) ||
+            shaders[shaderIndex]->isFeatureSupported(E_ShaderProgramFeatures::E_AUTO_INSTANCING)    // Instanced Objects are gathered above
+            )
+        {
+            continue;
+        }
+
+        for (const auto& model : scene->getTransparentModels(shaders[shaderIndex]->getName()))
+        {
+            if(!model->isVisible())
+            {
+                continue;
+            }
+
+            const auto& meshes = model->getModel()->meshes;
+            for(size_t i = 0; i < meshes.size(); ++i)
+            {
+                const glm::mat4& transform = model->getMeshMatrix(i);
+                _transparentQueue.add(shaderIndex, *meshes[i], &transform, meshDistance(viewPosition, *meshes[i], transform), false);
+            }
+        }
+    }
+
+    // The TRANSPARENT pass is sorted back to front, in decreasing distance to the camera
+    _transparentQueue.emit(queue);
+}
+
 void RenderTransparentNode::run()
+{
+    _chain->engine()->getRenderQueue()->submit(E_RenderPass::FORWARD_TRANSPARENT);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////// WEIGHTED BLENDED TRANSPARENCY NODE
+///////////////////////////////////////////////////////////////////////////////////////////
+
+void WeightedBlendedTransparencyNode::emit(RenderQueue& queue)
 {
     std::shared_ptr<Scene> scene = _chain->engine()->getScene();
     std::shared_ptr<ShaderLibrary> shaderPrograms = _chain->engine()->getShaderLibrary();
-    std::shared_ptr<FBOManager> frameBuffers = _chain->engine()->getFBOManager();
+    std::shared_ptr<InstancingManager> instancingManager = _chain->engine()->getInstancingManager();
 
+    // Every transparent mesh goes through the accumulation program, whatever transparent shader its model was given
+    unsigned int accumulationShader = shaderPrograms->getShaderIndex("WBOIT_accumulation");
+    const auto& shaders = shaderPrograms->getShaders();
 
-    for(unsigned int shaderIndex : shaderPrograms->getShaderIndexesPerFeature(E_ShaderProgramFeatures::E_TRANSPARENCY))
+    // No sorting needed, instanced draws keep their instances together
+    for(auto& instancingGroup : instancingManager->getInstancingGroups())
     {
-        // Activate shader
-        shaderPrograms->use(shaderIndex);
-        std::map<float, std::shared_ptr<ModelObject>> sortedTransparentModels;
-        
-        for (auto model : scene->getModels(shaderPrograms->getShader(shaderIndex)->getName()))
+        if(!shaders[instancingGroup.second.shader]->isFeatureSupported(E_ShaderProgramFeatures::E_TRANSPARENCY))
         {
-            if(model->getModel()->hasTransparency())
+            continue;
+        }
+
+        const auto& levels = instancingGroup.second.transforms();
+        for(size_t level = 0; level < levels.size(); ++level)
+        {
+            if(!levels[level].empty())
             {
-                float distance = glm::length(scene->getActiveCamera()->getPosition() - conversion::toVec3(model->getPosition()));
-                sortedTransparentModels[distance] = model;
+                queue.add(E_RenderPass::FORWARD_TRANSPARENT, accumulationShader, instancingGroup.second.mesh->getLod(level), levels[level].data(), 0.0f, static_cast<unsigned int>(levels[level].size()));
             }
         }
-        // Render all the transparent models (from in decreasing distance to the camera)
-        if(!sortedTransparentModels.empty())
+    }
+
+    // The models of other transparent shaders are single instances, the accumulation program only reads instanceMatrix
+    for(unsigned int shaderIndex = 0; shaderIndex < shaders.size(); ++shaderIndex)
+    {
+        if(
+            !shaders[shaderIndex]->isFeatureSupported(E_ShaderProgramFeatures::E_TRANSPARENCY) ||
+            shaders[shaderIndex]->isFeatureSupported(E_ShaderProgramFeatures::E_AUTO_INSTANCING)    // Instanced Objects are gathered above
+            )
+        {
+            continue;
+        }
+
+        for (const auto& model : scene->getTransparentModels(shaders[shaderIndex]->getName()))
         {
-            for (std::map<float, std::shared_ptr<ModelObject>>::reverse_iterator it = sortedTransparentModels.rbegin(); it != sortedTransparentModels.rend(); ++it)
+            if(!model->isVisible())
             {
-                frameBuffers->renderModel(*it->second);
+                continue;
+            }
+
+            const auto& meshes = model->getModel()->meshes;
+            for(size_t i = 0; i < meshes.size(); ++i)
+            {
+                queue.add(E_RenderPass::FORWARD_TRANSPARENT, accumulationShader, *meshes[i], &model->getMeshMatrix(i), 0.0f, 1);
             }
         }
     }
 }
 
+void WeightedBlendedTransparencyNode::run()
+{
+    std::shared_ptr<Scene> scene = _chain->engine()->getScene();
+    std::shared_ptr<ShaderLibrary> shaderPrograms = _chain->engine()->getShaderLibrary();
+    std::shared_ptr<FBOManager> frameBuffers = _chain->engine()->getFBOManager();
+    std::shared_ptr<Settings> settings = _chain->engine()->getSettings();
+
+    std::shared_ptr<FBO> fbo = frameBuffers->getSceneFBO(scene);
+    const auto& colorAttachments = fbo->getColorAttachments();
+    const ColorAttachment& accumulation = colorAttachments[colorAttachments.size() - 2];
+    const ColorAttachment& revealage = colorAttachments[colorAttachments.size() - 1];
+
+    // Only the two transparency targets, the opaque programs left them undefined
+    std::array<GLenum, 2> targets = {accumulation.slot, revealage.slot};
+    glDrawBuffers(static_cast<GLsizei>(targets.size()), targets.data());
+    const GLfloat noAccumulation[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    const GLfloat fullyRevealed[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    glClearBufferfv(GL_COLOR, 0, noAccumulation);
+    glClearBufferfv(GL_COLOR, 1, fullyRevealed);
+
+    // Tested against the opaque depth without writing it, so that hidden transparent surfaces still blend
+    GLStateCache::Instance().depthMask(GL_FALSE);
+    GLStateCache::Instance().enable(GL_BLEND);
+    GLStateCache::Instance().blendFunc(GL_ONE, GL_ONE);
+    glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+
+    _chain->engine()->getRenderQueue()->submit(E_RenderPass::FORWARD_TRANSPARENT);
+
+    // Back to the function the cache tracks for every buffer
+    glBlendFunci(1, GL_ONE, GL_ONE);
+
+    // Composite over the opaque color
+    glDrawBuffer(colorAttachments[0].slot);
+    shaderPrograms->use("WBOIT_composite");
+
+    shaderPrograms->setUniformInt("accumulation", 0);
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, accumulation.id);
+
+    shaderPrograms->setUniformInt("revealage", 1);
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 1);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, revealage.id);
+
+    GLStateCache::Instance().disable(GL_DEPTH_TEST);
+    GLStateCache::Instance().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    GLStateCache::Instance().bindVertexArray(shapes::quad::VAO());
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    RenderStatistics::Instance().addDrawCall();
+
+    // Return to normal settings
+    GLStateCache::Instance().bindVertexArray(0);
+    GLStateCache::Instance().enable(GL_DEPTH_TEST);
+    GLStateCache::Instance().depthMask(GL_TRUE);
+    if(settings->getTransparency() != E_Setting::ON)
+    {
+        GLStateCache::Instance().disable(GL_BLEND);
+    }
+
+    std::vector<GLenum> drawBuffers;
+    for(const auto& attachment : colorAttachments)
+    {
+        drawBuffers.push_back(attachment.slot);
+    }
+    glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////// BLOOM NODE
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -281,12 +519,13 @@ void BloomNode::run()
         horizontal_value = horizontal ? 1 : 0;
         frameBuffers->bindFBO(_pingPongFBOs[horizontal]);
         shaderPrograms->setUniformInt("horizontal", horizontal_value);
-        glActiveTexture(GL_TEXTURE0 + 1);
-        glBindTexture(GL_TEXTURE_2D, firstIteration ? frameBuffers->getSceneFBO(scene)->getColorAttachmentID(1) : _pingPongFBOs[!horizontal]->getColorAttachmentID(0));
+        GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 1);
+        GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, firstIteration ? frameBuffers->getSceneFBO(scene)->getColorAttachmentID(1) : _pingPongFBOs[!horizontal]->getColorAttachmentID(0));
 
-        glBindVertexArray(shapes::quad::VAO());
+        GLStateCache::Instance().bindVertexArray(shapes::quad::VAO());
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-        glBindVertexArray(0);
+        RenderStatistics::Instance().addDrawCall();
+        GLStateCache::Instance().bindVertexArray(0);
 
         horizontal = !horizontal;
         firstIteration = false;
@@ -299,16 +538,17 @@ void BloomNode::run()
     frameBuffers->bindProperFBOFromScene(scene);
 
     shaderPrograms->setUniformInt("material.diffuse", 1);
-    glActiveTexture(GL_TEXTURE0 + 1);
-    glBindTexture(GL_TEXTURE_2D, frameBuffers->getSceneFBO(scene)->getColorAttachmentID(0));
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 1);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, frameBuffers->getSceneFBO(scene)->getColorAttachmentID(0));
 
     shaderPrograms->setUniformInt("material.specular", 2);   
-    glActiveTexture(GL_TEXTURE0 + 2);
-    glBindTexture(GL_TEXTURE_2D, _pingPongFBOs[horizontal]->getColorAttachmentID(0));
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 2);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, _pingPongFBOs[horizontal]->getColorAttachmentID(0));
 
-    glBindVertexArray(shapes::quad::VAO());
+    GLStateCache::Instance().bindVertexArray(shapes::quad::VAO());
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    glBindVertexArray(0);
+    RenderStatistics::Instance().addDrawCall();
+    GLStateCache::Instance().bindVertexArray(0);
 
     // Remove binds
     frameBuffers->unbindFBO();
@@ -353,12 +593,13 @@ void HighDynamicRangeNode::run()
 
     shaderPrograms->use(quadShader);
     shaderPrograms->setUniformInt("material.diffuse", 1);
-    glActiveTexture(GL_TEXTURE0 + 1);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 1);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, textureID);
 
-    glBindVertexArray(shapes::quad::VAO());
+    GLStateCache::Instance().bindVertexArray(shapes::quad::VAO());
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    glBindVertexArray(0);
+    RenderStatistics::Instance().addDrawCall();
+    GLStateCache::Instance().bindVertexArray(0);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -367,6 +608,12 @@ void HighDynamicRangeNode::run()
 
 void DefaultFramebufferNode::run()
 {
+    // Without a window there is no default framebuffer, the frame stays in the scene FBO
+    if(_chain->engine()->isHeadless())
+    {
+        return;
+    }
+
     std::shared_ptr<Scene> scene = _chain->engine()->getScene();
     std::shared_ptr<FBOManager> frameBuffers = _chain->engine()->getFBOManager();
 
@@ -402,18 +649,39 @@ void DefaultFramebufferNode::run()
 /////////////////////////// GEOMETRY PASS NODE
 ///////////////////////////////////////////////////////////////////////////////////////////
 
-void GeometryPassNode::run()
+void GeometryPassNode::emit(RenderQueue& queue)
 {
-    std::shared_ptr<Scene> scene = _chain->engine()->getScene();
     std::shared_ptr<ShaderLibrary> shaderPrograms = _chain->engine()->getShaderLibrary();
-    //std::shared_ptr<InstancingManager> instancingManager = _chain->engine()->getInstancingManager();
-    std::shared_ptr<FBOManager> frameBuffers = _chain->engine()->getFBOManager();
+    std::shared_ptr<InstancingManager> instancingManager = _chain->engine()->getInstancingManager();
 
-    // Activate proper shader program
-    auto& geometryShaderProgram = shaderPrograms->getShader("deferred_geometry");
-    shaderPrograms->use(geometryShaderProgram);
+    unsigned int geometryShader = shaderPrograms->getShaderIndex("deferred_geometry");
+    // The GPU culls instanced meshes itself when asked to, it gets every instance
+    bool visibleOnly = _chain->engine()->getSettings()->getGPUCulling() != E_Setting::ON;
+    for(auto& instancingGroup : instancingManager->getInstancingGroups())
+    {
+        // Every opaque group fills the G-Buffer, whatever forward shader its models were given
+        if(shaderPrograms->getShader(instancingGroup.second.shader)->isFeatureSupported(E_ShaderProgramFeatures::E_TRANSPARENCY))
+        {
+            continue;
+        }
+
+        // One instanced draw per level of detail
+        const auto& levels = instancingGroup.second.transforms(visibleOnly);
+        for(size_t level = 0; level < levels.size(); ++level)
+        {
+            if(!levels[level].empty())
+            {
+                queue.add(E_RenderPass::DEFERRED_GEOMETRY, geometryShader, instancingGroup.second.mesh->getLod(level), levels[level].data(), 0.0f, static_cast<unsigned int>(levels[level].size()));
+            }
+        }
+    }
+}
 
-    frameBuffers->renderInstancedMeshes();
+void GeometryPassNode::run()
+{
+    std::shared_ptr<RenderQueue> renderQueue = _chain->engine()->getRenderQueue();
+    renderQueue->submit(E_RenderPass::DEFERRED_GEOMETRY);
+    renderQueue->submitOccluded(E_RenderPass::DEFERRED_GEOMETRY);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -435,145 +703,82 @@ void LightPassNode::run()
     frameBuffers->bindProperFBOFromScene(scene);
 
     shaderPrograms->setUniformInt("gData.position", 0);
-    glActiveTexture(GL_TEXTURE0 + 0);
-    glBindTexture(GL_TEXTURE_2D, _chain->engine()->getFBOManager()->getSceneFBO(scene)->getColorAttachmentID(1));
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, _chain->engine()->getFBOManager()->getSceneFBO(scene)->getColorAttachmentID(1));
  
     shaderPrograms->setUniformInt("gData.normal", 1);
-    glActiveTexture(GL_TEXTURE0 + 1);
-    glBindTexture(GL_TEXTURE_2D, _chain->engine()->getFBOManager()->getSceneFBO(scene)->getColorAttachmentID(2));
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 1);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, _chain->engine()->getFBOManager()->getSceneFBO(scene)->getColorAttachmentID(2));
  
     shaderPrograms->setUniformInt("gData.albedo", 2);
-    glActiveTexture(GL_TEXTURE0 + 2);
-    glBindTexture(GL_TEXTURE_2D, _chain->engine()->getFBOManager()->getSceneFBO(scene)->getColorAttachmentID(3));
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 2);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, _chain->engine()->getFBOManager()->getSceneFBO(scene)->getColorAttachmentID(3));
 
     shaderPrograms->setUniformInt("ssaoOcclusion", 3);
-    glActiveTexture(GL_TEXTURE0 + 3);
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 3);
     auto occlusionTextureID = _chain->getNode<SSAONode>()->getFBO()->getColorAttachmentID(1);
-    glBindTexture(GL_TEXTURE_2D, occlusionTextureID);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, occlusionTextureID);
 
 
     glDrawBuffer(GL_COLOR_ATTACHMENT0);
-    glDepthMask(GL_FALSE);  // Prevents depth buffer writes    
+    GLStateCache::Instance().depthMask(GL_FALSE);  // Prevents depth buffer writes    
 
-    glBindVertexArray(shapes::quad::VAO());
+    GLStateCache::Instance().bindVertexArray(shapes::quad::VAO());
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    glBindVertexArray(0);
+    RenderStatistics::Instance().addDrawCall();
+    GLStateCache::Instance().bindVertexArray(0);
 
-    glDepthMask(GL_TRUE);   // Re-enable depth buffer writes
-    glActiveTexture(GL_TEXTURE0);        
+    GLStateCache::Instance().depthMask(GL_TRUE);   // Re-enable depth buffer writes
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0);        
 
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////// LIGHT VOLUMES NODE
+/////////////////////////// TILED LIGHTING NODE
 ///////////////////////////////////////////////////////////////////////////////////////////
 
 namespace
 {
-    void bindLightUniforms(const std::shared_ptr<LightSource> light, std::shared_ptr<ShaderLibrary> shaderPrograms)
-    {
-        glm::mat4 model = glm::mat4(1.0f);
-        glm::vec3 position = conversion::toVec3(light->getPosition());
-        model = glm::translate(model, position);
-        float range = light->calculateMaxRange();
-        model = glm::scale(model, range * glm::vec3(1.0f));
-        shaderPrograms->setUniformMat4("model", model);
-        shaderPrograms->setUniformFloat("pointLight.maxRange", range);
-        shaderPrograms->setUniformVec3("pointLight.position", position);
-        shaderPrograms->setUniformVec3("pointLight.diffuse", conversion::toVec3(light->getColor()));
-
-        // Attenuation factors
-        const std::array<float, 3>& attFactors = light->getAttenuationFactors();
-        shaderPrograms->setUniformFloat("pointLight.constant", attFactors[0]);
-        shaderPrograms->setUniformFloat("pointLight.linear", attFactors[1]);
-        shaderPrograms->setUniformFloat("pointLight.quadratic", attFactors[2]);
-    }
+    // Screen tile edge of the deferred_tiled_lighting work groups
+    constexpr GLuint lightingTileSize = 16;
 }
 
-LightVolumeNode::LightVolumeNode(const StrategyChain* chain) : 
-    StrategyNode(chain) 
-{
-    std::shared_ptr<FBOManager> frameBuffers = _chain->engine()->getFBOManager();
-    
-    _fbo = frameBuffers->addFBO(E_AttachmentTemplate::TEXTURE, _chain->engine()->getViewportSize()[0], _chain->engine()->getViewportSize()[1]);
-    _fbo->bindToViewportSize(true);
-
-    _fbo->addAttachment(E_AttachmentSlot::COLOR, E_ColorFormat::RGBA16F);
-}
-
-void LightVolumeNode::run()
+void TiledLightingNode::run()
 {
     std::shared_ptr<Scene> scene = _chain->engine()->getScene();
     std::shared_ptr<ShaderLibrary> shaderPrograms = _chain->engine()->getShaderLibrary();
-    std::shared_ptr<FBOManager> frameBuffers = _chain->engine()->getFBOManager();    
-
-    // Bind the proper FBO
-    frameBuffers->bindFBO(_fbo);
-    frameBuffers->clearColor();
+    std::shared_ptr<FBO> sceneFBO = _chain->engine()->getFBOManager()->getSceneFBO(scene);
 
-    // Activate proper shader program
-    auto& lightShaderProgram = shaderPrograms->getShader("deferred_light_volumes");
+    // The lights were streamed by LightsSetupNode, this pass only reads the G-Buffer and the scene color
+    auto& lightShaderProgram = shaderPrograms->getShader("deferred_tiled_lighting");
     shaderPrograms->use(lightShaderProgram);
 
     shaderPrograms->setUniformInt("gData.position", 0);
-    glActiveTexture(GL_TEXTURE0 + 0);
-    glBindTexture(GL_TEXTURE_2D, _chain->engine()->getFBOManager()->getSceneFBO(scene)->getColorAttachmentID(1));
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, sceneFBO->getColorAttachmentID(1));
 
     shaderPrograms->setUniformInt("gData.normal", 1);
-    glActiveTexture(GL_TEXTURE0 + 1);
-    glBindTexture(GL_TEXTURE_2D, _chain->engine()->getFBOManager()->getSceneFBO(scene)->getColorAttachmentID(2));
- 
-    shaderPrograms->setUniformInt("gData.albedo", 2);
-    glActiveTexture(GL_TEXTURE0 + 2);
-    glBindTexture(GL_TEXTURE_2D, _chain->engine()->getFBOManager()->getSceneFBO(scene)->getColorAttachmentID(3));
-
-    // Lights are additively blended
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_ONE, GL_ONE);
-
-    // Draw Light Volumes back faces
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_FRONT);
-    glDisable(GL_DEPTH_TEST);
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 1);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, sceneFBO->getColorAttachmentID(2));
 
-    glDrawBuffer(GL_COLOR_ATTACHMENT0);
-
-    glBindVertexArray(shapes::sphere::VAO());
-    // Light Volumes: Draw Light Sources as geometry, calculate lighting
-    const std::vector<std::shared_ptr<PointLight>>& pointLights = scene->getAllLights().pointLights;
-    for(auto& pointLight : pointLights)
-    {
-        bindLightUniforms(pointLight, shaderPrograms);
-        glDrawElements(GL_TRIANGLES, shapes::sphere::indexCount(), GL_UNSIGNED_INT, 0);
-    }   
-
-    // Return to normal settings
-    glCullFace(GL_BACK);
-
-    // Blend the light volumes with the scene
-    // Re-enable the default scene FBO again
-    frameBuffers->bindProperFBOFromScene(scene);
-    // Switch shaders
-    auto quadShader = shaderPrograms->getShader("Quad_Texture");
-    shaderPrograms->use(quadShader);
+    shaderPrograms->setUniformInt("gData.albedo", 2);
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 2);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, sceneFBO->getColorAttachmentID(3));
 
-    glDrawBuffer(GL_COLOR_ATTACHMENT0);    
-    shaderPrograms->setUniformInt("tex.color", 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _fbo->getColorAttachmentID(0));
+    shaderPrograms->setUniformInt("depthTexture", 3);
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 3);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, sceneFBO->getDepthTextureID());
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0);
 
-    glDepthMask(GL_FALSE);  // Prevents depth buff}er writes
+    // The lights are added to the ambient term LightPassNode left in the color attachment
+    glBindImageTexture(0, sceneFBO->getColorAttachmentID(0), 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA16F);
 
-    glBindVertexArray(shapes::quad::VAO());    
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-    // Return to normal settings
-    glEnable(GL_DEPTH_TEST);
-    glBindVertexArray(0);
-    glDisable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDepthMask(GL_TRUE);  // Prevents depth buffer writes      
+    const GLuint width = static_cast<GLuint>(sceneFBO->getOriginalSize()[0]);
+    const GLuint height = static_cast<GLuint>(sceneFBO->getOriginalSize()[1]);
+    glDispatchCompute((width + lightingTileSize - 1) / lightingTileSize, (height + lightingTileSize - 1) / lightingTileSize, 1);
 
+    // Later passes sample or draw over the color attachment
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -624,7 +829,7 @@ SSAONode::SSAONode(const StrategyChain* chain) :
     }  
 
     glGenTextures(1, &_noiseTexture);
-    glBindTexture(GL_TEXTURE_2D, _noiseTexture);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, _noiseTexture);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, 4, 4, 0, GL_RGB, GL_FLOAT, &_ssaoNoise[0]);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -649,17 +854,17 @@ void SSAONode::run()
 
     // Update the Geometry Pass outputs to the uniform slots
     shaderPrograms->setUniformInt("gData.position", 0);
-    glActiveTexture(GL_TEXTURE0 + 0);
-    glBindTexture(GL_TEXTURE_2D, _chain->engine()->getFBOManager()->getSceneFBO(scene)->getColorAttachmentID(4));
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 0);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, _chain->engine()->getFBOManager()->getSceneFBO(scene)->getColorAttachmentID(4));
 
     shaderPrograms->setUniformInt("gData.normal", 1);
-    glActiveTexture(GL_TEXTURE0 + 1);
-    glBindTexture(GL_TEXTURE_2D, _chain->engine()->getFBOManager()->getSceneFBO(scene)->getColorAttachmentID(5));
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 1);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, _chain->engine()->getFBOManager()->getSceneFBO(scene)->getColorAttachmentID(5));
  
     shaderPrograms->setUniformInt("noiseTex", 2);
-    glActiveTexture(GL_TEXTURE0 + 2);
-    glBindTexture(GL_TEXTURE_2D, _noiseTexture);
-    glActiveTexture(GL_TEXTURE0);
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 2);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, _noiseTexture);
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0);
 
     for (unsigned int i = 0; i < 64; ++i)
     {
@@ -667,18 +872,20 @@ void SSAONode::run()
     }
  
     glDrawBuffer(GL_COLOR_ATTACHMENT0);
-    glBindVertexArray(shapes::quad::VAO());
+    GLStateCache::Instance().bindVertexArray(shapes::quad::VAO());
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);   
+    RenderStatistics::Instance().addDrawCall();
 
     // Blur the SSAO texture
     shaderPrograms->use("deferred_SSAO_blur");
 
     shaderPrograms->setUniformInt("screenTexture", 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _occlusionFBO->getColorAttachmentID(0));
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, _occlusionFBO->getColorAttachmentID(0));
 
     glDrawBuffer(GL_COLOR_ATTACHMENT1);   
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);   
+    RenderStatistics::Instance().addDrawCall();
 
     frameBuffers->unbindFBO();
 }
@@ -707,16 +914,16 @@ void PBS_IBLSetupNode::run()
 
     shaderPrograms->use(_ShaderName);
     shaderPrograms->setUniformInt("irradianceMap", 20);
-    glActiveTexture(GL_TEXTURE0 + 20);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, lightLibrary->getLightMap().getDiffuseIrradianceFBO()->getColorAttachmentID(0));
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 20);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_CUBE_MAP, lightLibrary->getLightMap().getDiffuseIrradianceFBO()->getColorAttachmentID(0));
 
     shaderPrograms->setUniformInt("prefilterMap", 21);
-    glActiveTexture(GL_TEXTURE0 + 21);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, lightLibrary->getLightMap().getSpecularPreFilterFBO()->getColorAttachmentID(0));
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 21);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_CUBE_MAP, lightLibrary->getLightMap().getSpecularPreFilterFBO()->getColorAttachmentID(0));
 
     shaderPrograms->setUniformInt("brdfLUT", 22);
-    glActiveTexture(GL_TEXTURE0 + 22);
-    glBindTexture(GL_TEXTURE_2D, lightLibrary->getLightMap().getSpecularBRDFLUT()->getColorAttachmentID(0));
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 22);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D, lightLibrary->getLightMap().getSpecularBRDFLUT()->getColorAttachmentID(0));
 }
 
 
@@ -736,13 +943,13 @@ void LightSourceCubeDebugNode::run()
     std::shared_ptr<Scene> scene = _chain->engine()->getScene();
     std::shared_ptr<ShaderLibrary> shaderPrograms = _chain->engine()->getShaderLibrary();
 
-    glDisable(GL_CULL_FACE);
+    GLStateCache::Instance().disable(GL_CULL_FACE);
 
-    glDepthMask(GL_FALSE);  // Prevents depth buffer writes
+    GLStateCache::Instance().depthMask(GL_FALSE);  // Prevents depth buffer writes
 
     if(!_depthTest)
     {
-        glDisable(GL_DEPTH_TEST);
+        GLStateCache::Instance().disable(GL_DEPTH_TEST);
     }
     else
     {
@@ -753,32 +960,33 @@ void LightSourceCubeDebugNode::run()
 
     const std::vector<std::shared_ptr<PointLight>>& pointLights = scene->getAllLights().pointLights;
 
-    glBindVertexArray(shapes::sphere::VAO());
+    GLStateCache::Instance().bindVertexArray(shapes::sphere::VAO());
 
     for(const auto& pointLight : pointLights)
     {
         glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, conversion::toVec3(pointLight->getPosition()));
+        model = glm::translate(model, pointLight->getWorldPosition());
         model = glm::scale(model, pointLight->calculateMaxRange() * glm::vec3(1.0f));
         shaderPrograms->setUniformMat4("model", model);
         glm::vec4 color = glm::vec4(conversion::toVec3(pointLight->getColor()), 1.0f);
         shaderPrograms->setUniformVec4("outputColor", color);
 
         glDrawElements(GL_TRIANGLES, shapes::sphere::indexCount(), GL_UNSIGNED_INT, 0);
+        RenderStatistics::Instance().addDrawCall();
     }
-    glBindVertexArray(0);
+    GLStateCache::Instance().bindVertexArray(0);
     
     if(!_depthTest)
     {
-        glEnable(GL_DEPTH_TEST);
+        GLStateCache::Instance().enable(GL_DEPTH_TEST);
     }
     else
     {
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     }
 
-    glDepthMask(GL_TRUE);  // Prevents depth buffer writes
-    glEnable(GL_CULL_FACE);
+    GLStateCache::Instance().depthMask(GL_TRUE);  // Prevents depth buffer writes
+    GLStateCache::Instance().enable(GL_CULL_FACE);
 }
 
 void RenderCubeMapNode::run()
@@ -792,12 +1000,13 @@ void RenderCubeMapNode::run()
     shaderPrograms->use("Cube_Shaper");
     
     shaderPrograms->setUniformInt("textureMap", 1);
-    glActiveTexture(GL_TEXTURE0 + 1);
-    glBindTexture(GL_TEXTURE_2D , lightmap->_id);
+    GLStateCache::Instance().activeTexture(GL_TEXTURE0 + 1);
+    GLStateCache::Instance().bindTexture(GL_TEXTURE_2D , lightmap->_id);
     
-    glBindVertexArray(shapes::cube::VAO());
+    GLStateCache::Instance().bindVertexArray(shapes::cube::VAO());
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
+    RenderStatistics::Instance().addDrawCall();
+    GLStateCache::Instance().bindVertexArray(0);
 
     // Rendering shadowmaps might have changed the viewport size, so we reset it
     std::array<int, 2> viewportSize = _chain->engine()->getViewportSize();
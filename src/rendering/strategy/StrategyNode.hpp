@@ -9,14 +9,22 @@
 // Third-party includes
 #include <glm/glm.hpp>
 
+// First-party includes
+#include "rendering/TransparentQueue.hpp"
+
 class StrategyChain;
 class FBO;
+class RenderQueue;
 
 class StrategyNode
 {
 public:
     StrategyNode(const StrategyChain* chain);
     virtual void run() = 0;
+    // Called on every node before any of them runs, nodes drawing meshes add their packets to the queue here
+    virtual void emit(RenderQueue& queue) {}
+    // Used to identify the node in profiling results
+    virtual const char* name() const = 0;
 protected:
     const StrategyChain* _chain;
 };
@@ -26,6 +34,7 @@ class ViewportUpdateNote : public StrategyNode
 public:
     ViewportUpdateNote(const StrategyChain* chain) : StrategyNode(chain) {}
     void run() override;
+    const char* name() const override { return "ViewportUpdateNote"; }
 };
 
 
@@ -34,6 +43,7 @@ class CameraSetupNode : public StrategyNode
 public:
     CameraSetupNode(const StrategyChain* chain) : StrategyNode(chain) {}
     void run() override;
+    const char* name() const override { return "CameraSetupNode"; }
 };
 
 class ShadowsSetupNode : public StrategyNode
@@ -41,6 +51,8 @@ class ShadowsSetupNode : public StrategyNode
 public:
     ShadowsSetupNode(const StrategyChain* chain) : StrategyNode(chain) {}
     void run() override;
+    void emit(RenderQueue& queue) override;
+    const char* name() const override { return "ShadowsSetupNode"; }
 };
 
 class LightsSetupNode : public StrategyNode
@@ -48,6 +60,7 @@ class LightsSetupNode : public StrategyNode
 public:
     LightsSetupNode(const StrategyChain* chain, const std::string& shader);
     void run() override;
+    const char* name() const override { return "LightsSetupNode"; }
 private:
     std::string _ShaderName;
 };
@@ -57,6 +70,7 @@ class FramebufferNode : public StrategyNode
 public:
     FramebufferNode(const StrategyChain* chain) : StrategyNode(chain) {}
     void run() override;
+    const char* name() const override { return "FramebufferNode"; }
 };
 
 class RenderOpaqueNode : public StrategyNode
@@ -64,6 +78,8 @@ class RenderOpaqueNode : public StrategyNode
 public:
     RenderOpaqueNode(const StrategyChain* chain) : StrategyNode(chain) {}
     void run() override;
+    void emit(RenderQueue& queue) override;
+    const char* name() const override { return "RenderOpaqueNode"; }
 };
 
 class RenderSkyboxNode : public StrategyNode
@@ -71,6 +87,7 @@ class RenderSkyboxNode : public StrategyNode
 public:
     RenderSkyboxNode(const StrategyChain* chain) : StrategyNode(chain) {}
     void run() override;
+    const char* name() const override { return "RenderSkyboxNode"; }
 };
 
 class RenderTransparentNode : public StrategyNode
@@ -78,6 +95,22 @@ class RenderTransparentNode : public StrategyNode
 public:
     RenderTransparentNode(const StrategyChain* chain) : StrategyNode(chain) {}
     void run() override;
+    void emit(RenderQueue& queue) override;
+    const char* name() const override { return "RenderTransparentNode"; }
+private:
+    TransparentQueue _transparentQueue;
+};
+
+// Weighted blended order-independent transparency, replaces RenderTransparentNode when the setting is on.
+// Transparent meshes are drawn unsorted and instanced into the last two color attachments of the scene FBO,
+// then composited over the opaque color
+class WeightedBlendedTransparencyNode : public StrategyNode
+{
+public:
+    WeightedBlendedTransparencyNode(const StrategyChain* chain) : StrategyNode(chain) {}
+    void run() override;
+    void emit(RenderQueue& queue) override;
+    const char* name() const override { return "WeightedBlendedTransparencyNode"; }
 };
 
 class BloomNode : public StrategyNode
@@ -86,6 +119,7 @@ public:
     BloomNode(const StrategyChain* chain);
     ~BloomNode();
     void run() override;
+    const char* name() const override { return "BloomNode"; }
 private:
     std::array<std::shared_ptr<FBO>, 2> _pingPongFBOs;
 };
@@ -95,6 +129,7 @@ class HighDynamicRangeNode : public StrategyNode
 public:
     HighDynamicRangeNode(const StrategyChain* chain);
     void run() override;
+    const char* name() const override { return "HighDynamicRangeNode"; }
 private:
     std::shared_ptr<FBO> _HDRfbo;
 };
@@ -104,6 +139,7 @@ class DefaultFramebufferNode : public StrategyNode
 public:
     DefaultFramebufferNode(const StrategyChain* chain) : StrategyNode(chain) {}
     void run() override;
+    const char* name() const override { return "DefaultFramebufferNode"; }
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -115,6 +151,8 @@ class GeometryPassNode : public StrategyNode
 public:
     GeometryPassNode(const StrategyChain* chain) : StrategyNode(chain) {}
     void run() override;
+    void emit(RenderQueue& queue) override;
+    const char* name() const override { return "GeometryPassNode"; }
 };
 
 class LightPassNode : public StrategyNode
@@ -122,15 +160,16 @@ class LightPassNode : public StrategyNode
 public:
     LightPassNode(const StrategyChain* chain) : StrategyNode(chain) {}
     void run() override;
+    const char* name() const override { return "LightPassNode"; }
 };
 
-class LightVolumeNode : public StrategyNode
+// Compute shaded point and spot lights, one work group per screen tile culling the lights against its depth range
+class TiledLightingNode : public StrategyNode
 {
 public:
-    LightVolumeNode(const StrategyChain* chain);
+    TiledLightingNode(const StrategyChain* chain) : StrategyNode(chain) {}
     void run() override;
-private:    
-    std::shared_ptr<FBO> _fbo;
+    const char* name() const override { return "TiledLightingNode"; }
 };
 
 class SSAONode : public StrategyNode
@@ -138,6 +177,7 @@ class SSAONode : public StrategyNode
 public:
     SSAONode(const StrategyChain* chain);
     void run() override;
+    const char* name() const override { return "SSAONode"; }
     std::shared_ptr<FBO> getFBO() const;
 private:
     unsigned int _noiseTexture;
@@ -155,6 +195,7 @@ class PBS_renderOpaqueNode : public StrategyNode
 public:
     PBS_renderOpaqueNode(const StrategyChain* chain) : StrategyNode(chain) {}
     void run() override;
+    const char* name() const override { return "PBS_renderOpaqueNode"; }
 };
 
 class PBS_IBLSetupNode : public StrategyNode
@@ -162,6 +203,7 @@ class PBS_IBLSetupNode : public StrategyNode
 public:
     PBS_IBLSetupNode(const StrategyChain* chain, const std::string& shaderName);
     void run() override;
+    const char* name() const override { return "PBS_IBLSetupNode"; }
 private:
     std::string _ShaderName;
 };
@@ -175,6 +217,7 @@ class LightSourceCubeDebugNode : public StrategyNode
 public:
     LightSourceCubeDebugNode(const StrategyChain* chain, bool depthTest = true);
     void run() override;
+    const char* name() const override { return "LightSourceCubeDebugNode"; }
 private:
     const bool _depthTest;
 };
@@ -184,4 +227,5 @@ class RenderCubeMapNode : public StrategyNode
 public:
     RenderCubeMapNode(const StrategyChain* chain) : StrategyNode(chain) {}
     void run() override;
+    const char* name() const override { return "RenderCubeMapNode"; }
 };
\ No newline at end of file
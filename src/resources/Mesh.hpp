@@ -1,10 +1,13 @@
 ﻿#pragma once
 
 // STL headers
+#include <algorithm>
+#include <memory>
 #include <vector>
 
 // First-party headers
 #include <resources/Texture.hpp>
+#include <util/Culling.hpp>
 
 // Third-party headers
 #include <glm/glm.hpp>
@@ -37,6 +40,7 @@ public:
         _hasTransparency(hasTransparency)
     {
         _id = boost::uuids::random_generator()();
+        computeBounds();
     }
 
     void attachTexture(std::vector<Texture> textures)
@@ -44,6 +48,35 @@ public:
         _textures.insert(_textures.end(), textures.begin(), textures.end());
     }
 
+    // Box around the vertices, and the sphere centered on it
+    void computeBounds()
+    {
+        if(_vertices.empty())
+        {
+            return;
+        }
+
+        _aabbMin = _aabbMax = _vertices[0].Position;
+        for(const Vertex& vertex : _vertices)
+        {
+            _aabbMin = glm::min(_aabbMin, vertex.Position);
+            _aabbMax = glm::max(_aabbMax, vertex.Position);
+        }
+
+        _boundingSphere.center = (_aabbMin + _aabbMax) * 0.5f;
+        float radius2 = 0.0f;
+        for(const Vertex& vertex : _vertices)
+        {
+            glm::vec3 offset = vertex.Position - _boundingSphere.center;
+            radius2 = glm::max(radius2, glm::dot(offset, offset));
+        }
+        _boundingSphere.radius = glm::sqrt(radius2);
+    }
+
+    // Level 0 is the mesh itself, past the last level the coarsest one is returned
+    size_t getLodCount() const { return _lods.size() + 1; }
+    const Mesh& getLod(size_t level) const { return level == 0 || _lods.empty() ? *this : *_lods[std::min(level, _lods.size()) - 1]; }
+
     // Structural Data
     boost::uuids::uuid _id;
 
@@ -51,8 +84,26 @@ public:
     std::vector<Vertex> _vertices;
     std::vector<unsigned int> _indices;
     std::vector<Texture> _textures;
+    // Meshes with the same texture set share it, assigned by the MeshLibrary
+    unsigned int _material = 0;
+    // Small id of the mesh, assigned by the MeshLibrary and reused once the mesh is removed
+    unsigned int _index = 0;
     bool _hasTransparency = false;
+    // Accumulated transform of the node the mesh was imported from
+    glm::mat4 _localTransform = glm::mat4(1.0f);
+
+    // Bounds in mesh space
+    glm::vec3 _aabbMin = glm::vec3(0.0f);
+    glm::vec3 _aabbMax = glm::vec3(0.0f);
+    BoundingSphere _boundingSphere;
+
+    // Simplified copies generated at import, from the finest to the coarsest
+    std::vector<std::shared_ptr<Mesh>> _lods;
+    // Of a level of detail, how far its surface may be from the original one, in mesh units
+    float _lodError = 0.0f;
 
-    // Rendering Data
+    // Rendering Data, the buffers are shared with the other meshes of the same GeometryBuffer
     unsigned int VAO, VBO, EBO;
+    unsigned int baseVertex = 0;
+    unsigned int firstIndex = 0;
 };
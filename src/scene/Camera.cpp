@@ -44,6 +44,7 @@ glm::mat4 Camera::recalculateMVP()
 	);
 	
 	_MVP = (_projM * _viewM *_modelM);
+	_frustum = Frustum(_projM * _viewM);
 	
 	return _MVP;
 }
@@ -71,6 +72,21 @@ void Camera::setRotation(const std::array<float, 2>& rotation)
 	_rotation = glm::make_vec2(rotation_adjusted_for_speed.data());
 }
 
+void Camera::lookAt(const std::array<float, 3>& target)
+{
+	glm::vec3 direction = glm::vec3(target[0], target[1], target[2]) - _position;
+	if(glm::length(direction) < 1e-6f)
+	{
+		return;
+	}
+	direction = glm::normalize(direction);
+
+	// Inverse of the direction computed in recalculateMVP()
+	_rotation = { std::atan2(-direction.z, direction.x), std::asin(direction.y) };
+
+	truncateRotation();
+}
+
 void Camera::addRotationDelta(const std::array<float, 2>& rotationDelta)
 {
 	glm::vec2 speed_adjusted_rotation = {-rotationDelta[0] * _rotationSpeed, -rotationDelta[1] * _rotationSpeed};
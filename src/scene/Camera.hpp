@@ -14,6 +14,7 @@
 // First-party includes
 #include <scene/sceneObject.hpp>
 #include <util/Arithmetic.hpp>
+#include <util/Culling.hpp>
 
 enum class relativeDirections : unsigned int
 {
@@ -36,6 +37,8 @@ public:
 	const glm::vec3& getPosition() const;
 
 	void setRotation(const std::array<float, 2>& rotation);
+	// Points the camera at a world position
+	void lookAt(const std::array<float, 3>& target);
 	void addRotationDelta(const std::array<float, 2>& rotationDelta);
 
 	void resizeCameraPlane(const float& width, const float& height);
@@ -46,6 +49,10 @@ public:
 	glm::mat4 getModelMatrix() const;
 	glm::mat4 getViewMatrix() const;
 	glm::mat4 getProjectionMatrix() const;
+	float getNearPlane() const { return _nearPlane; }
+	float getFarPlane() const { return _farPlane; }
+	// Planes of the last recalculateMVP()
+	const Frustum& getFrustum() const { return _frustum; }
 
 private:
 	bool _debugMode;
@@ -57,6 +64,7 @@ private:
 	void truncateRotation();
 
 	glm::mat4 _MVP, _modelM, _viewM, _projM;
+	Frustum _frustum;
 	glm::vec3 _cameraRight, _cameraUp, _up;
 
 	float _fov;
@@ -9,7 +9,8 @@
 LightSource::LightSource(float intensity, const std::array<float, 3>& color, const std::array<float, 3>& attenuationFactors)  :
     _intensity(intensity),
     _color(color),
-    _attenuationFactors(attenuationFactors)
+    _attenuationFactors(attenuationFactors),
+    _version(0)
 {
     ;
 }
@@ -17,6 +18,7 @@ LightSource::LightSource(float intensity, const std::array<float, 3>& color, con
 void LightSource::setIntensity(float intensity)
 {
     _intensity = intensity;
+    markChanged();
 }
 
 float LightSource::getIntensity() const 
@@ -27,6 +29,7 @@ float LightSource::getIntensity() const
 void LightSource::setColor(const std::array<float, 3>& color)
 {
     _color = color;
+    markChanged();
 }
 
 const std::array<float, 3>& LightSource::getColor() const
@@ -37,6 +40,7 @@ const std::array<float, 3>& LightSource::getColor() const
 void LightSource::setAttenuationFactors(std::array<float, 3> attenuationFactors)
 {
     _attenuationFactors = attenuationFactors;
+    markChanged();
 }
 
 const std::array<float, 3>& LightSource::getAttenuationFactors() const
@@ -98,6 +102,7 @@ SpotLight::SpotLight(float intensity, std::array<float, 3> color,const std::arra
 void SpotLight::setDirection(std::array<float, 3> direction)
 {
     _direction = direction;
+    markChanged();
 }
 
 const std::array<float, 3>& SpotLight::getDirection() const
@@ -107,17 +112,20 @@ const std::array<float, 3>& SpotLight::getDirection() const
 
 void SpotLight::pointAt(const std::array<float, 3>& point)
 {
-    float x = point[0] - getPosition()[0];
-    float y = point[1] - getPosition()[1];
-    float z = point[2] - getPosition()[2];
+    const glm::vec3 position = getWorldPosition();
+    float x = point[0] - position.x;
+    float y = point[1] - position.y;
+    float z = point[2] - position.z;
 
     _direction = Math::normalize({x, y, z});
+    markChanged();
 }
 
 void SpotLight::setCutoff(float cutoff, float delta)
 {
     _cutoff[0] = std::min(std::max(cutoff, 0.0f), 45.0f);
     _cutoff[1] = _cutoff[0] + delta;
+    markChanged();
 }
 
 
@@ -1,6 +1,7 @@
 #pragma once
 
 // STL headers
+#include <cstdint>
 #include <memory>
 
 // First-party headers
@@ -37,10 +38,17 @@ public:
 
     float calculateMaxRange() const;
 
+    // Changes whenever one of its properties is set, moves show in getTransformVersion()
+    uint32_t getVersion() const { return _version; }
+
+protected:
+    void markChanged() { ++_version; }
+
 private:
     float _intensity;
     std::array<float, 3> _color;
     std::array<float, 3> _attenuationFactors;
+    uint32_t _version;
 };
 
 
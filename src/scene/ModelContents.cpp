@@ -1,26 +1,54 @@
 #include "scene/ModelContents.hpp"
 
+#include <algorithm>
+
+namespace
+{
+    void eraseModel(std::vector<std::shared_ptr<ModelObject>>& models, const ModelObject* model)
+    {
+        auto it = std::find_if(models.begin(), models.end(),
+            [model](const std::shared_ptr<ModelObject>& candidate) { return candidate.get() == model; });
+
+        if(it != models.end())
+        {
+            models.erase(it);
+        }
+    }
+}
+
+ModelContents::~ModelContents()
+{
+    for(auto &model : _models)
+    {
+        model->_contents = nullptr;
+    }
+}
 
 void ModelContents::addModel(std::shared_ptr<ModelObject> model)
 {
     _models.push_back(model);
+    model->_contents = this;
+    addToBuckets(model);
 }
 
 
-bool ModelContents::removeModel(std::shared_ptr<ModelObject> modelToRemove)
+void ModelContents::reserve(size_t modelCount)
 {
+    _models.reserve(modelCount);
+}
 
-
-    for(auto &model : _models)
+bool ModelContents::removeModel(std::shared_ptr<ModelObject> modelToRemove)
+{
+    auto it = std::find(_models.begin(), _models.end(), modelToRemove);
+    if(it == _models.end())
     {
-        if(model == modelToRemove)
-        {
-            _models.erase(std::remove(_models.begin(), _models.end(), modelToRemove), _models.end());
-            return true;
-        }
+        return false;
     }
 
-    return false;
+    removeFromBuckets(modelToRemove.get());
+    modelToRemove->_contents = nullptr;
+    _models.erase(it);
+    return true;
 }
 
 const std::vector<std::shared_ptr<ModelObject>> &ModelContents::getModels() const
@@ -28,17 +56,49 @@ const std::vector<std::shared_ptr<ModelObject>> &ModelContents::getModels() cons
     return _models;
 }
 
-std::vector<std::shared_ptr<ModelObject>> ModelContents::getModels(const std::string& shader) const
+const std::vector<std::shared_ptr<ModelObject>> &ModelContents::getModels(const std::string& shader) const
 {
-    std::vector<std::shared_ptr<ModelObject>> models;
+    auto bucket = _shaderBuckets.find(shader);
+    if(bucket == _shaderBuckets.end())
+    {
+        return _emptyBucket;
+    }
 
-    for(auto &model : _models)
+    return bucket->second.models;
+}
+
+const std::vector<std::shared_ptr<ModelObject>> &ModelContents::getTransparentModels(const std::string& shader) const
+{
+    auto bucket = _shaderBuckets.find(shader);
+    if(bucket == _shaderBuckets.end())
     {
-        if(model->getShaderName() == shader)
-        {
-            models.push_back(model);
-        }
+        return _emptyBucket;
     }
 
-    return models;
-}
\ No newline at end of file
+    return bucket->second.transparentModels;
+}
+
+void ModelContents::addToBuckets(const std::shared_ptr<ModelObject>& model)
+{
+    ++_version;
+    ShaderBucket& bucket = _shaderBuckets[model->getShaderName()];
+    bucket.models.push_back(model);
+
+    if(model->getModel()->hasTransparency())
+    {
+        bucket.transparentModels.push_back(model);
+    }
+}
+
+void ModelContents::removeFromBuckets(const ModelObject* model)
+{
+    ++_version;
+    auto bucket = _shaderBuckets.find(model->getShaderName());
+    if(bucket == _shaderBuckets.end())
+    {
+        return;
+    }
+
+    eraseModel(bucket->second.models, model);
+    eraseModel(bucket->second.transparentModels, model);
+}
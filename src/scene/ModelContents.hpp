@@ -1,6 +1,8 @@
 #pragma once
 
 //	STD includes
+#include <cstdint>
+#include <string>
 #include <vector>
 #include <memory>
 #include <unordered_map>
@@ -8,16 +10,42 @@
 //	First Party includes
 #include "scene/ModelObject.hpp"
 
+// Models of a scene, also sorted into per-shader buckets kept up to date as models are added,
+// removed or change shader, so the render nodes can walk them every frame without allocating
 class ModelContents
 {
 public:
+    ~ModelContents();
+
     void addModel(std::shared_ptr<ModelObject> modelToAdd);
+    void reserve(size_t modelCount);
     bool removeModel(std::shared_ptr<ModelObject> modelToRemove);
     const std::vector<std::shared_ptr<ModelObject>> &getModels() const;
-    std::vector<std::shared_ptr<ModelObject>> getModels(const std::string& shader) const;
+    // The returned vectors belong to the buckets and change with them
+    const std::vector<std::shared_ptr<ModelObject>> &getModels(const std::string& shader) const;
+    const std::vector<std::shared_ptr<ModelObject>> &getTransparentModels(const std::string& shader) const;
+    // Bumped whenever a bucket changes, lets the InstancingManager skip frames where nothing did
+    uint64_t getVersion() const { return _version; }
 
 
 private:
+    // ModelObject moves itself between buckets when its shader or model changes
+    friend class ModelObject;
+
+    struct ShaderBucket
+    {
+        std::vector<std::shared_ptr<ModelObject>> models;
+        // Subset of models with at least one transparent mesh
+        std::vector<std::shared_ptr<ModelObject>> transparentModels;
+    };
+
+    void addToBuckets(const std::shared_ptr<ModelObject>& model);
+    void removeFromBuckets(const ModelObject* model);
+
     std::vector<std::shared_ptr<ModelObject>> _models;
+    std::unordered_map<std::string, ShaderBucket> _shaderBuckets;
+    uint64_t _version = 0;
+
+    inline static const std::vector<std::shared_ptr<ModelObject>> _emptyBucket;
 
-};
\ No newline at end of file
+};
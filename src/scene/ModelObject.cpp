@@ -1,17 +1,40 @@
 #include "ModelObject.hpp"
 
+#include "scene/ModelContents.hpp"
+
 ModelObject::ModelObject()  :
     _model(std::make_shared<Model>()),
     _shaderIndex(0),
-    _modelMatrixProvider(_properties),
     _id(boost::uuids::random_generator()())
 {
 
 }
 
+ModelObject::~ModelObject()
+{
+    for(unsigned int meshTransform : _meshTransforms)
+    {
+        if(meshTransform != TransformStore::none)
+        {
+            TransformStore::Instance().release(meshTransform);
+        }
+    }
+}
+
 void ModelObject::setModel(const std::shared_ptr<Model> &model)
 {
+    // Transparency decides the bucket too
+    if(_contents)
+    {
+        _contents->removeFromBuckets(this);
+    }
+
     _model = model;
+
+    if(_contents)
+    {
+        _contents->addToBuckets(shared_from_this());
+    }
 }
 
 std::shared_ptr<Model> ModelObject::getModel()
@@ -26,7 +49,17 @@ void ModelObject::setShaderIndex(unsigned int shaderIndex)
 
 void ModelObject::setShaderName(const std::string& shaderName)
 {
+    if(_contents)
+    {
+        _contents->removeFromBuckets(this);
+    }
+
     _assignedShader = shaderName;
+
+    if(_contents)
+    {
+        _contents->addToBuckets(shared_from_this());
+    }
 }
 
 const std::string& ModelObject::getShaderName() const
@@ -41,7 +74,55 @@ unsigned int ModelObject::getShaderIndex() const
 
 const glm::mat4& ModelObject::getModelMatrix()
 {
-    return _modelMatrixProvider.getModelMatrix();
+    return TransformStore::Instance().getWorldMatrix(_transform);
+}
+
+const glm::mat4& ModelObject::getMeshMatrix(size_t meshIndex)
+{
+    if(meshIndex >= _meshTransforms.size() || _meshTransforms[meshIndex] == TransformStore::none)
+    {
+        return getModelMatrix();
+    }
+
+    return TransformStore::Instance().getWorldMatrix(_meshTransforms[meshIndex]);
+}
+
+void ModelObject::bindMeshTransforms()
+{
+    TransformStore& transforms = TransformStore::Instance();
+    for(unsigned int meshTransform : _meshTransforms)
+    {
+        if(meshTransform != TransformStore::none)
+        {
+            transforms.release(meshTransform);
+        }
+    }
+    _meshTransforms.assign(_model->meshes.size(), TransformStore::none);
+    _meshLods.assign(_model->meshes.size(), 0);
+
+    const glm::mat4 identity(1.0f);
+    for(size_t i = 0; i < _model->meshes.size(); ++i)
+    {
+        const glm::mat4& local = _model->meshes[i]->_localTransform;
+
+        BoundingSphere meshBounds = _model->meshes[i]->_boundingSphere.transformed(local);
+        _localBounds = (i == 0) ? meshBounds : BoundingSphere::merge(_localBounds, meshBounds);
+
+        if(local == identity)
+        {
+            continue;
+        }
+
+        unsigned int meshTransform = transforms.allocate();
+        transforms.setOffset(meshTransform, local);
+        transforms.setParent(meshTransform, _transform);
+        _meshTransforms[i] = meshTransform;
+    }
+}
+
+BoundingSphere ModelObject::getWorldBounds()
+{
+    return _localBounds.transformed(getModelMatrix());
 }
 
 const boost::uuids::uuid& ModelObject::uuid() const
@@ -5,31 +5,55 @@
 #include "resources/Texture.hpp"
 #include "resources/Model.hpp"
 // #include "util/Listener.hpp"
-#include "scene/ModelMatrixProvider.hpp"
 
 // Third-party headers
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 
+class ModelContents;
 
 class ModelObject : public SceneObject, public std::enable_shared_from_this<ModelObject>
 {
 public:
     ModelObject();
+    ModelObject(const ModelObject&) = delete;
+    ModelObject& operator=(const ModelObject&) = delete;
+    ~ModelObject();
 
     void setModel(const std::shared_ptr<Model> &model);
     std::shared_ptr<Model> getModel();
 
     void setShaderIndex(unsigned int shaderIndex);
     unsigned int getShaderIndex() const;
+    // Moves the model to the matching bucket of the scene it belongs to
     void setShaderName(const std::string& shaderName);
     const std::string& getShaderName() const;
 
+    // Rebuilt by TransformStore::update() at the start of each frame
     const glm::mat4& getModelMatrix();
+    // Model matrix times the imported transform of the mesh
+    const glm::mat4& getMeshMatrix(size_t meshIndex);
+    // Give every mesh with an imported transform its own child entry in the TransformStore,
+    // and gather the bounds of the meshes in model space
+    void bindMeshTransforms();
+
+    BoundingSphere getWorldBounds() override;
+
+    // Written by the CullingManager before the render queue is built
+    void setVisible(bool visible) { _visible = visible; }
+    void setCastsShadow(bool castsShadow) { _castsShadow = castsShadow; }
+    bool isVisible() const { return _visible; }
+    bool castsShadow() const { return _castsShadow; }
+    // Level of detail of each mesh, 0 is the full mesh
+    void setMeshLod(size_t meshIndex, unsigned int level) { _meshLods[meshIndex] = static_cast<uint8_t>(level); }
+    unsigned int getMeshLod(size_t meshIndex) const { return meshIndex < _meshLods.size() ? _meshLods[meshIndex] : 0; }
+    size_t getMeshLodCount() const { return _meshLods.size(); }
 
     const boost::uuids::uuid& uuid() const;
 
 private:
+    friend class ModelContents;
+
     // Structural Data
     boost::uuids::uuid _id;
     
@@ -37,7 +61,17 @@ private:
 
     std::shared_ptr<Model> _model;
     unsigned int _shaderIndex;
-    ModelMatrixProvider _modelMatrixProvider;
+    // One entry per mesh, TransformStore::none when the mesh uses the model matrix as is
+    std::vector<unsigned int> _meshTransforms;
+
+    // Scene contents holding the model, nullptr until it is added to a scene
+    ModelContents* _contents = nullptr;
+
+    BoundingSphere _localBounds;
+    bool _visible = true;
+    bool _castsShadow = true;
+    // Kept from one frame to the next, a mesh only changes level once its error is clearly past the threshold
+    std::vector<uint8_t> _meshLods;
 
 };
 
@@ -1,8 +1,19 @@
 #include "Scene.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 #include <boost/uuid/uuid_io.hpp>
 
+namespace
+{
+	template <typename T>
+	void eraseObject(std::vector<std::shared_ptr<T>>& objects, const std::shared_ptr<SceneObject>& object)
+	{
+		objects.erase(std::remove_if(objects.begin(), objects.end(),
+			[&object](const std::shared_ptr<T>& candidate) { return candidate == object; }), objects.end());
+	}
+}
+
 Scene::Scene() : activeCameraID(0),
 				 _ambientLight(0.2f, {1.0f, 1.0f, 1.0f}),
 				 _id(boost::uuids::random_generator()())
@@ -18,6 +29,18 @@ void Scene::addCamera(std::shared_ptr<Camera> cameraToAdd)
 void Scene::addModel(std::shared_ptr<ModelObject> modelToAdd)
 {
 	_objects.models.addModel(modelToAdd);
+	addToIndex(modelToAdd, E_SceneObjectType::MODEL);
+}
+
+void Scene::addModels(const std::vector<std::shared_ptr<ModelObject>>& modelsToAdd)
+{
+	_objects.models.reserve(_objects.models.getModels().size() + modelsToAdd.size());
+	_index.reserve(_index.size() + modelsToAdd.size());
+
+	for (const auto& model : modelsToAdd)
+	{
+		addModel(model);
+	}
 }
 
 void Scene::addLightSource(std::shared_ptr<LightSource> lightSourceToAdd)
@@ -48,16 +71,59 @@ void Scene::addLightSource(std::shared_ptr<LightSource> lightSourceToAdd)
 void Scene::addDirectionalLight(std::shared_ptr<DirectionalLight> directionalLightToAdd)
 {
 	_objects.lights.directionalLights.push_back(directionalLightToAdd);
+	addToIndex(directionalLightToAdd, E_SceneObjectType::DIRECTIONAL_LIGHT);
 }
 
 void Scene::addPointLight(std::shared_ptr<PointLight> pointLightToAdd)
 {
 	_objects.lights.pointLights.push_back(pointLightToAdd);
+	addToIndex(pointLightToAdd, E_SceneObjectType::POINT_LIGHT);
 }
 
 void Scene::addSpotLight(std::shared_ptr<SpotLight> spotLightToAdd)
 {
 	_objects.lights.spotLights.push_back(spotLightToAdd);
+	addToIndex(spotLightToAdd, E_SceneObjectType::SPOT_LIGHT);
+}
+
+void Scene::addToIndex(const std::shared_ptr<SceneObject>& object, E_SceneObjectType type)
+{
+	SceneObjectSlot& slot = _index[object->id()];
+	slot.type = type;
+	slot.object = object;
+
+	if (type != E_SceneObjectType::DIRECTIONAL_LIGHT)
+	{
+		// Bounds first, they may rebuild the world matrix and bump the version
+		AABB bounds = AABB::fromSphere(object->getWorldBounds());
+		slot.transformVersion = object->getTransformVersion();
+		slot.proxy = _spatialIndex.insert(object.get(), bounds, sceneObjectMask(type));
+	}
+}
+
+const SpatialIndex &Scene::getSpatialIndex() const
+{
+	return _spatialIndex;
+}
+
+void Scene::refreshSpatialIndex()
+{
+	for (auto &entry : _index)
+	{
+		SceneObjectSlot &slot = entry.second;
+		if (slot.proxy == SpatialIndex::null)
+		{
+			continue;
+		}
+
+		// Bounds are only recomputed for the objects that moved
+		if (slot.object->getTransformVersion() != slot.transformVersion)
+		{
+			AABB bounds = AABB::fromSphere(slot.object->getWorldBounds());
+			slot.transformVersion = slot.object->getTransformVersion();
+			_spatialIndex.move(slot.proxy, bounds);
+		}
+	}
 }
 
 const SceneContents &Scene::getAllObjects() const
@@ -75,11 +141,16 @@ const std::vector<std::shared_ptr<ModelObject>> &Scene::getModels() const
 	return _objects.models.getModels();
 }
 
-std::vector<std::shared_ptr<ModelObject>> Scene::getModels(const std::string& shader) const
+const std::vector<std::shared_ptr<ModelObject>> &Scene::getModels(const std::string& shader) const
 {
 	return _objects.models.getModels(shader);
 }
 
+const std::vector<std::shared_ptr<ModelObject>> &Scene::getTransparentModels(const std::string& shader) const
+{
+	return _objects.models.getTransparentModels(shader);
+}
+
 const LightContents &Scene::getAllLights() const
 {
 	return _objects.lights;
@@ -102,30 +173,91 @@ Skybox &Scene::getSkybox()
 
 std::shared_ptr<SceneObject> Scene::get(const boost::uuids::uuid &id)
 {
+	auto slot = _index.find(id);
+	if (slot == _index.end())
+	{
+		return nullptr;
+	}
 
-	for (auto &model : _objects.models.getModels())
+	return slot->second.object;
+}
+
+const SceneObjectSlot* Scene::findSlot(const boost::uuids::uuid &id, E_SceneObjectType type) const
+{
+	auto slot = _index.find(id);
+	if (slot == _index.end() || slot->second.type != type)
 	{
-		if (model->id() == id)
-		{
-			return std::dynamic_pointer_cast<SceneObject>(model);
-		}
+		return nullptr;
 	}
 
-	for (auto &pointLight : _objects.lights.pointLights)
+	return &slot->second;
+}
+
+std::shared_ptr<ModelObject> Scene::getModel(const boost::uuids::uuid &id)
+{
+	const SceneObjectSlot* slot = findSlot(id, E_SceneObjectType::MODEL);
+	return slot ? std::static_pointer_cast<ModelObject>(slot->object) : nullptr;
+}
+
+std::shared_ptr<LightSource> Scene::getLight(const boost::uuids::uuid &id)
+{
+	auto slot = _index.find(id);
+	if (slot == _index.end() || slot->second.type == E_SceneObjectType::MODEL)
 	{
-		if (pointLight->id() == id)
-		{
-			return std::dynamic_pointer_cast<SceneObject>(pointLight);
-		}
+		return nullptr;
+	}
+
+	return std::static_pointer_cast<LightSource>(slot->second.object);
+}
+
+std::shared_ptr<DirectionalLight> Scene::getDirectionalLight(const boost::uuids::uuid &id)
+{
+	const SceneObjectSlot* slot = findSlot(id, E_SceneObjectType::DIRECTIONAL_LIGHT);
+	return slot ? std::static_pointer_cast<DirectionalLight>(slot->object) : nullptr;
+}
+
+std::shared_ptr<PointLight> Scene::getPointLight(const boost::uuids::uuid &id)
+{
+	const SceneObjectSlot* slot = findSlot(id, E_SceneObjectType::POINT_LIGHT);
+	return slot ? std::static_pointer_cast<PointLight>(slot->object) : nullptr;
+}
+
+std::shared_ptr<SpotLight> Scene::getSpotLight(const boost::uuids::uuid &id)
+{
+	const SceneObjectSlot* slot = findSlot(id, E_SceneObjectType::SPOT_LIGHT);
+	return slot ? std::static_pointer_cast<SpotLight>(slot->object) : nullptr;
+}
+
+bool Scene::remove(const boost::uuids::uuid &id)
+{
+	auto slot = _index.find(id);
+	if (slot == _index.end())
+	{
+		return false;
 	}
 
-	for (auto &spotLight : _objects.lights.spotLights)
+	const std::shared_ptr<SceneObject>& object = slot->second.object;
+	switch (slot->second.type)
 	{
-		if (spotLight->id() == id)
-		{
-			return std::dynamic_pointer_cast<SceneObject>(spotLight);
-		}
+	case E_SceneObjectType::MODEL:
+		_objects.models.removeModel(std::static_pointer_cast<ModelObject>(object));
+		break;
+	case E_SceneObjectType::DIRECTIONAL_LIGHT:
+		eraseObject(_objects.lights.directionalLights, object);
+		break;
+	case E_SceneObjectType::POINT_LIGHT:
+		eraseObject(_objects.lights.pointLights, object);
+		break;
+	case E_SceneObjectType::SPOT_LIGHT:
+		eraseObject(_objects.lights.spotLights, object);
+		break;
 	}
 
-	return nullptr;
-}
\ No newline at end of file
+	if (slot->second.proxy != SpatialIndex::null)
+	{
+		_spatialIndex.remove(slot->second.proxy);
+	}
+
+	_index.erase(slot);
+	return true;
+}
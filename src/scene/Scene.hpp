@@ -11,10 +11,37 @@
 #include "scene\LightSource.hpp"
 #include "scene\ModelContents.hpp"
 #include "scene\Skybox.hpp"
+#include "scene\SpatialIndex.hpp"
 
 // Third-party headers
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
+#include <boost/functional/hash.hpp>
+
+enum class E_SceneObjectType
+{
+	MODEL,
+	DIRECTIONAL_LIGHT,
+	POINT_LIGHT,
+	SPOT_LIGHT
+};
+
+// SpatialIndex mask bit of a type
+inline uint32_t sceneObjectMask(E_SceneObjectType type)
+{
+	return uint32_t(1) << static_cast<unsigned int>(type);
+}
+
+// Entry of the uuid index, the type tag spares a dynamic cast on typed lookups
+struct SceneObjectSlot
+{
+	E_SceneObjectType type;
+	std::shared_ptr<SceneObject> object;
+	// Leaf in the SpatialIndex, and the transform version its bounds were taken at
+	int proxy = SpatialIndex::null;
+	uint32_t transformVersion = 0;
+};
+
 struct LightContents
 {
 	std::vector<std::shared_ptr<DirectionalLight>> directionalLights;
@@ -36,30 +63,53 @@ public:
 
 	void addCamera(std::shared_ptr<Camera> cameraToAdd);
 	void addModel(std::shared_ptr<ModelObject> modelToAdd);
+	// Grows the containers once for the whole batch
+	void addModels(const std::vector<std::shared_ptr<ModelObject>>& modelsToAdd);
 	void addLightSource(std::shared_ptr<LightSource> lightSourceToAdd);
 
 	const SceneContents &getAllObjects() const;
 	const std::vector<std::shared_ptr<Camera>> &getAllCameras() const;
 	const std::vector<std::shared_ptr<ModelObject>> &getModels() const;
-	std::vector<std::shared_ptr<ModelObject>> getModels(const std::string& shader) const;
+	const std::vector<std::shared_ptr<ModelObject>> &getModels(const std::string& shader) const;
+	const std::vector<std::shared_ptr<ModelObject>> &getTransparentModels(const std::string& shader) const;
 	const LightContents &getAllLights() const;
 
 	AmbientLight& getAmbientLight();
 	std::shared_ptr<Camera> &getActiveCamera();
 	Skybox& getSkybox();
 
+	// Constant time lookups, nullptr if the id is unknown or of another type
 	std::shared_ptr<SceneObject> get(const boost::uuids::uuid& id);
+	std::shared_ptr<ModelObject> getModel(const boost::uuids::uuid& id);
+	std::shared_ptr<LightSource> getLight(const boost::uuids::uuid& id);
+	std::shared_ptr<DirectionalLight> getDirectionalLight(const boost::uuids::uuid& id);
+	std::shared_ptr<PointLight> getPointLight(const boost::uuids::uuid& id);
+	std::shared_ptr<SpotLight> getSpotLight(const boost::uuids::uuid& id);
+
+	// Remove a model or a light, returns false if the id is unknown
+	bool remove(const boost::uuids::uuid& id);
+
+	// Models, point lights and spot lights. Directional lights have no position and are left out.
+	const SpatialIndex& getSpatialIndex() const;
+	// Moves the objects whose transform changed since the last call, once per frame
+	void refreshSpatialIndex();
 
 private:
 	void addDirectionalLight(std::shared_ptr<DirectionalLight> directionalLightToAdd);
 	void addPointLight(std::shared_ptr<PointLight> pointLightToAdd);
 	void addSpotLight(std::shared_ptr<SpotLight> spotLightToAdd);
 
+	const SceneObjectSlot* findSlot(const boost::uuids::uuid& id, E_SceneObjectType type) const;
+	void addToIndex(const std::shared_ptr<SceneObject>& object, E_SceneObjectType type);
+
 	unsigned int activeCameraID;
 
 	boost::uuids::uuid _id;
 
 	SceneContents _objects;
+	// Every model and light of _objects, by id
+	std::unordered_map<boost::uuids::uuid, SceneObjectSlot, boost::hash<boost::uuids::uuid>> _index;
+	SpatialIndex _spatialIndex;
 
 	AmbientLight _ambientLight;
 	Skybox _skybox;
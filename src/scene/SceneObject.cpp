@@ -1,5 +1,7 @@
 #include "scene/SceneObject.hpp"
 
+#include "util/Rotation.hpp"
+
 namespace
 {
     const float M_PI = 3.14159265358979323846f;
@@ -7,46 +9,90 @@ namespace
 }
 
 SceneObject::SceneObject()  :
+    _transform(TransformStore::Instance().allocate()),
     _toRender(true),
-    _properties(),
     _id(boost::uuids::random_generator()())
 {
     ;
 }
 
+SceneObject::SceneObject(const SceneObject& other)  :
+    _transform(TransformStore::Instance().allocate()),
+    _toRender(other._toRender),
+    _id(other._id)
+{
+    *this = other;
+}
+
+SceneObject& SceneObject::operator=(const SceneObject& other)
+{
+    // Each object keeps its own slot, only the values are copied
+    TransformStore& transforms = TransformStore::Instance();
+    transforms.setPosition(_transform, transforms.getPosition(other._transform));
+    transforms.setRotation(_transform, transforms.getRotation(other._transform));
+    transforms.setScale(_transform, transforms.getScale(other._transform));
+
+    _toRender = other._toRender;
+    _id = other._id;
+    return *this;
+}
+
 SceneObject::~SceneObject()
 {
-    ;
+    TransformStore::Instance().release(_transform);
 }
 
 void SceneObject::setPosition(const std::array<float, 3>& coords)
 {
-    _properties.coordinates = coords;
+    TransformStore::Instance().setPosition(_transform, coords);
 }
 
 const std::array<float, 3> &SceneObject::getPosition() const
 {
-    return _properties.coordinates;
+    return TransformStore::Instance().getPosition(_transform);
+}
+
+glm::vec3 SceneObject::getWorldPosition() const
+{
+    return glm::vec3(TransformStore::Instance().getWorldMatrix(_transform)[3]);
 }
 
 void SceneObject::setScale(float scale)
 {
-    _properties.scale = scale;
+    TransformStore::Instance().setScale(_transform, scale);
 }
 
 float SceneObject::getScale()
 {
-    return _properties.scale;
+    return TransformStore::Instance().getScale(_transform);
 }
 
 const glm::fquat &SceneObject::getRotation()
 {
-    return _properties.rotation.getRotation();
+    return TransformStore::Instance().getRotation(_transform);
 }   
 
 void SceneObject::rotate(float x, float y, float z)
 {
-    _properties.rotation.rotate(x, y, z);
+    TransformStore& transforms = TransformStore::Instance();
+    transforms.setRotation(_transform, Rotation::rotated(transforms.getRotation(_transform), x, y, z));
+}
+
+void SceneObject::setParent(const SceneObject* parent)
+{
+    TransformStore::Instance().setParent(_transform, parent ? parent->_transform : TransformStore::none);
+}
+
+BoundingSphere SceneObject::getWorldBounds()
+{
+    BoundingSphere bounds;
+    bounds.center = getWorldPosition();
+    return bounds;
+}
+
+uint32_t SceneObject::getTransformVersion() const
+{
+    return TransformStore::Instance().getVersion(_transform);
 }
 
 bool SceneObject::enabled() const
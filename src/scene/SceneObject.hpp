@@ -5,7 +5,8 @@
 #include <array>
 
 // First-party headers
-#include "scene/SceneObjectProperties.hpp"
+#include "scene/TransformStore.hpp"
+#include "util/Culling.hpp"
 
 // Third-party headers
 #include <boost/uuid/uuid.hpp>
@@ -15,10 +16,14 @@ class SceneObject
 {
 public:
     SceneObject();
+    SceneObject(const SceneObject& other);
+    SceneObject& operator=(const SceneObject& other);
     virtual ~SceneObject();
 
     virtual void setPosition(const std::array<float, 3>& coords);
     virtual const std::array<float, 3>& getPosition() const;
+    // Position once the parents are applied, getPosition() is relative to the parent
+    glm::vec3 getWorldPosition() const;
 
     void setScale (float scale);
     float getScale();
@@ -27,19 +32,28 @@ public:
 
     void rotate(float x, float y, float z);
 
+    // The object then moves with its parent, nullptr detaches it
+    void setParent(const SceneObject* parent);
+
+    // A point at the world position, objects with a volume override it
+    virtual BoundingSphere getWorldBounds();
+    // Changes whenever the world transform is rebuilt
+    uint32_t getTransformVersion() const;
+
     bool enabled() const;
 
+    // Slot of the object in the TransformStore, for bulk updates
+    unsigned int getTransformHandle() const { return _transform; }
+
     boost::uuids::uuid id() const;
 
 protected:
-    // Renderable object properties
-    SceneObjectProperties _properties;
+    // Position, rotation and scale live in the TransformStore
+    unsigned int _transform;
 
 private:
     
     bool _toRender;
 
     boost::uuids::uuid _id;
-    // std::weak_ptr<SceneObject> _parent;
-    // std::vector<std::weak_ptr<SceneObject>> _children;
 };
@@ -1,8 +1,11 @@
 #include "scene/SceneObjectFactory.hpp"
 
 #include "rendering/libraries/TextureLibrary.hpp"
+#include "rendering/Settings.hpp"
 
 #include "helpers/RootDir.hpp"
+#include "util/MeshSimplifier.hpp"
+#include "util/Profiler.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -132,6 +135,12 @@ namespace
         texture._useLinear = true;
     }
 
+    // Assimp matrices are row major
+    glm::mat4 toMat4(const aiMatrix4x4& matrix)
+    {
+        return glm::transpose(glm::make_mat4(&matrix.a1));
+    }
+
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -174,6 +183,7 @@ ModelObject &SceneObjectFactory::create_Model(const std::string &modelPath, cons
     externalTextureLocations = textureLocations;
 
     load_ModelMeshes(model, modelPath);
+    model_object->bindMeshTransforms();
 
     _boundScene->addModel(model_object);
 
@@ -181,6 +191,37 @@ ModelObject &SceneObjectFactory::create_Model(const std::string &modelPath, cons
     return *model_object;
 }
 
+std::vector<std::shared_ptr<ModelObject>> SceneObjectFactory::create_Models(const std::string &modelPath, size_t count, const std::string& shader, bool flipUVs, TextureLocations textureLocations)
+{
+    FLUX_PROFILE_FUNCTION();
+
+    std::vector<std::shared_ptr<ModelObject>> models;
+    if(count == 0)
+    {
+        return models;
+    }
+    models.reserve(count);
+
+    ModelObject& first = create_Model(modelPath, shader, flipUVs, textureLocations);
+    models.push_back(first.shared_from_this());
+
+    const std::shared_ptr<Model> model = first.getModel();
+    for(size_t i = 1; i < count; ++i)
+    {
+        std::shared_ptr<ModelObject> model_object = std::make_shared<ModelObject>();
+        model_object->setShaderName(shader);
+        model_object->setModel(model);
+        model_object->bindMeshTransforms();
+        models.push_back(model_object);
+    }
+
+    _boundEngine->getMeshLibrary()->addMeshUsers(modelPath, static_cast<unsigned int>(count - 1));
+
+    // The first one is already in the scene
+    _boundScene->addModels(std::vector<std::shared_ptr<ModelObject>>(models.begin() + 1, models.end()));
+    return models;
+}
+
 void SceneObjectFactory::load_ModelMeshes(Model& model, const std::string& path)
 {
     // check if model is already loaded
@@ -209,12 +250,14 @@ void SceneObjectFactory::load_ModelMeshes(Model& model, const std::string& path)
 
     model.directory = path;
     model.meshes = _boundEngine->getMeshLibrary()->getMeshes(path);
+    _boundEngine->getMeshLibrary()->addMeshUsers(path);
 }
 
 // processes nodes recursively
-void SceneObjectFactory::processNode(const std::string &path, aiNode *node, const aiScene *scene)
+void SceneObjectFactory::processNode(const std::string &path, aiNode *node, const aiScene *scene, const glm::mat4& parentTransform)
 {
     std::vector<std::shared_ptr<Mesh>> newMeshes;
+    glm::mat4 nodeTransform = parentTransform * toMat4(node->mTransformation);
 
     // process each mesh located at the current node
     for (unsigned int i = 0; i < node->mNumMeshes; i++)
@@ -222,6 +265,7 @@ void SceneObjectFactory::processNode(const std::string &path, aiNode *node, cons
         aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
 
         newMeshes.push_back(processMesh(path, mesh, scene));
+        newMeshes.back()->_localTransform = nodeTransform;
     }
 
     // Update mesh library
@@ -230,13 +274,15 @@ void SceneObjectFactory::processNode(const std::string &path, aiNode *node, cons
     // after we've processed all of the meshes (if any) we then recursively process each of the children nodes
     for (unsigned int i = 0; i < node->mNumChildren; i++)
     {
-        processNode(path, node->mChildren[i], scene);
+        processNode(path, node->mChildren[i], scene, nodeTransform);
     }
 
 }
 
 std::shared_ptr<Mesh> SceneObjectFactory::processMesh(const std::string &path, aiMesh *mesh, const aiScene *scene)
 {
+    FLUX_PROFILE_FUNCTION();
+
     // data to fill
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
@@ -359,7 +405,75 @@ std::shared_ptr<Mesh> SceneObjectFactory::processMesh(const std::string &path, a
     textures.insert(textures.end(), externalMaps.begin(), externalMaps.end());
 
     // return a mesh object created from the extracted mesh data
-    return std::make_shared<Mesh>(Mesh(vertices, indices, textures, hasTransparency));
+    std::shared_ptr<Mesh> newMesh = std::make_shared<Mesh>(Mesh(vertices, indices, textures, hasTransparency));
+    if(_boundEngine->getSettings()->getLevelOfDetail() == E_Setting::ON)
+    {
+        generateLods(*newMesh);
+    }
+    return newMesh;
+}
+
+void SceneObjectFactory::generateLods(Mesh& mesh) const
+{
+    FLUX_PROFILE_FUNCTION();
+
+    constexpr size_t maxLevels = 4;
+    // Below this the draw costs more than the triangles
+    constexpr size_t minIndexCount = 3 * 128;
+    // A level saving less than this over the previous one is not worth its memory
+    constexpr float minReduction = 0.8f;
+
+    // Transparent meshes are sorted and drawn one by one, they always use the full mesh
+    if(mesh._hasTransparency)
+    {
+        return;
+    }
+
+    std::vector<size_t> targets;
+    for(size_t indexCount = mesh._indices.size() / 2; indexCount >= minIndexCount && targets.size() < maxLevels; indexCount /= 2)
+    {
+        targets.push_back(indexCount - indexCount % 3);
+    }
+    if(targets.empty())
+    {
+        return;
+    }
+
+    std::vector<glm::vec3> positions(mesh._vertices.size());
+    for(size_t i = 0; i < positions.size(); ++i)
+    {
+        positions[i] = mesh._vertices[i].Position;
+    }
+
+    std::vector<simplification::Level> levels = simplification::simplify(positions, mesh._indices, targets);
+
+    // Each level only keeps the vertices its triangles still use
+    std::vector<unsigned int> remap(mesh._vertices.size());
+    size_t previousCount = mesh._indices.size();
+    for(simplification::Level& level : levels)
+    {
+        if(level.indices.size() > previousCount * minReduction)
+        {
+            continue;
+        }
+        previousCount = level.indices.size();
+
+        std::fill(remap.begin(), remap.end(), ~0u);
+        std::vector<Vertex> vertices;
+        for(unsigned int& index : level.indices)
+        {
+            if(remap[index] == ~0u)
+            {
+                remap[index] = static_cast<unsigned int>(vertices.size());
+                vertices.push_back(mesh._vertices[index]);
+            }
+            index = remap[index];
+        }
+
+        std::shared_ptr<Mesh> lod = std::make_shared<Mesh>(Mesh(vertices, level.indices, mesh._textures, mesh._hasTransparency));
+        lod->_lodError = level.error;
+        mesh._lods.push_back(lod);
+    }
 }
 
 std::vector<Texture> SceneObjectFactory::loadMaterialTextures(const aiScene* scene, const std::string &path, aiMaterial *mat, aiTextureType type)
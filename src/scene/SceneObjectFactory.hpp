@@ -16,6 +16,7 @@
 //Third-party includes
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
@@ -48,9 +49,14 @@ public:
 
     // Importing models
     ModelObject &create_Model(const std::string &modelPath, const std::string& shader = "Basic", bool flipUVs = false, TextureLocations textureLocations = {});
+    // Instances of one model, the file is looked up and loaded once and they all share the same Model
+    std::vector<std::shared_ptr<ModelObject>> create_Models(const std::string &modelPath, size_t count, const std::string& shader = "Basic", bool flipUVs = false, TextureLocations textureLocations = {});
     void load_ModelMeshes(Model& model, std::string const &path);
-    void processNode(const std::string &path, aiNode* node, const aiScene* scene);
+    // Meshes keep the transform of their node, accumulated from the root
+    void processNode(const std::string &path, aiNode* node, const aiScene* scene, const glm::mat4& parentTransform = glm::mat4(1.0f));
     std::shared_ptr<Mesh> processMesh(const std::string &path, aiMesh *mesh, const aiScene *scene);
+    // Simplified copies of the mesh, each level keeping about half the triangles of the previous one
+    void generateLods(Mesh& mesh) const;
     std::vector<Texture> loadMaterialTextures(const aiScene* scene, const std::string &path, aiMaterial *mat, aiTextureType type);
     std::vector<Texture> loadExternalTextures(const std::string &path, const TextureLocations & textures) const;
 
@@ -0,0 +1,487 @@
+#include "scene/SpatialIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // Entry distance of a ray into a box, negative if it misses it
+    float rayBoxDistance(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, const AABB& box)
+    {
+        float entry = 0.0f;
+        float exit = maxDistance;
+
+        for(int axis = 0; axis < 3; ++axis)
+        {
+            float near = (box.min[axis] - origin[axis]) * inverseDirection[axis];
+            float far = (box.max[axis] - origin[axis]) * inverseDirection[axis];
+            if(near > far)
+            {
+                std::swap(near, far);
+            }
+
+            // NaN when the origin lies on a slab of a parallel ray, the comparisons then keep the previous values
+            entry = near > entry ? near : entry;
+            exit = far < exit ? far : exit;
+            if(entry > exit)
+            {
+                return -1.0f;
+            }
+        }
+        return entry;
+    }
+
+    BoundingSphere enclosingSphere(const AABB& box)
+    {
+        BoundingSphere sphere;
+        sphere.center = (box.min + box.max) * 0.5f;
+        sphere.radius = glm::length(box.max - sphere.center);
+        return sphere;
+    }
+}
+
+SpatialIndex::SpatialIndex(float margin) :
+    _root(null),
+    _freeList(null),
+    _leafCount(0),
+    _margin(margin)
+{
+    ;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////// NODES
+///////////////////////////////////////////////////////////////////////////////////////////
+
+int SpatialIndex::allocateNode()
+{
+    int index;
+    if(_freeList != null)
+    {
+        index = _freeList;
+        _freeList = _nodes[index].parent;
+    }
+    else
+    {
+        index = static_cast<int>(_nodes.size());
+        _nodes.emplace_back();
+    }
+
+    Node& node = _nodes[index];
+    node.parent = null;
+    node.left = null;
+    node.right = null;
+    node.height = 0;
+    node.object = nullptr;
+    node.mask = 0;
+    return index;
+}
+
+void SpatialIndex::freeNode(int index)
+{
+    // Free nodes are chained through their parent field
+    _nodes[index].parent = _freeList;
+    _nodes[index].height = -1;
+    _freeList = index;
+}
+
+int SpatialIndex::insert(SceneObject* object, const AABB& bounds, uint32_t mask)
+{
+    int leaf = allocateNode();
+    _nodes[leaf].bounds = bounds.grown(_margin);
+    _nodes[leaf].object = object;
+    _nodes[leaf].mask = mask;
+
+    insertLeaf(leaf);
+    ++_leafCount;
+    return leaf;
+}
+
+void SpatialIndex::remove(int proxy)
+{
+    removeLeaf(proxy);
+    freeNode(proxy);
+    --_leafCount;
+}
+
+bool SpatialIndex::move(int proxy, const AABB& bounds)
+{
+    if(_nodes[proxy].bounds.contains(bounds))
+    {
+        return false;
+    }
+
+    removeLeaf(proxy);
+    _nodes[proxy].bounds = bounds.grown(_margin);
+    insertLeaf(proxy);
+    return true;
+}
+
+int SpatialIndex::getHeight() const
+{
+    return _root == null ? 0 : _nodes[_root].height;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////// TREE MAINTENANCE
+///////////////////////////////////////////////////////////////////////////////////////////
+
+void SpatialIndex::insertLeaf(int leaf)
+{
+    if(_root == null)
+    {
+        _root = leaf;
+        _nodes[leaf].parent = null;
+        return;
+    }
+
+    // Walk down to the sibling whose merge with the leaf costs the least surface
+    const AABB leafBounds = _nodes[leaf].bounds;
+    int index = _root;
+    while(!_nodes[index].isLeaf())
+    {
+        const Node& node = _nodes[index];
+        float area = node.bounds.perimeter();
+        float combinedArea = AABB::merge(node.bounds, leafBounds).perimeter();
+
+        // Pairing with this node, or pushing the leaf further down, which grows this node anyway
+        float cost = 2.0f * combinedArea;
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto descendCost = [&](int child)
+        {
+            const Node& childNode = _nodes[child];
+            float merged = AABB::merge(leafBounds, childNode.bounds).perimeter();
+            return (childNode.isLeaf() ? merged : merged - childNode.bounds.perimeter()) + inheritanceCost;
+        };
+
+        float leftCost = descendCost(node.left);
+        float rightCost = descendCost(node.right);
+
+        if(cost < leftCost && cost < rightCost)
+        {
+            break;
+        }
+        index = leftCost < rightCost ? node.left : node.right;
+    }
+
+    const int sibling = index;
+    const int oldParent = _nodes[sibling].parent;
+    const int newParent = allocateNode();
+
+    _nodes[newParent].parent = oldParent;
+    _nodes[newParent].left = sibling;
+    _nodes[newParent].right = leaf;
+    _nodes[sibling].parent = newParent;
+    _nodes[leaf].parent = newParent;
+
+    if(oldParent == null)
+    {
+        _root = newParent;
+    }
+    else if(_nodes[oldParent].left == sibling)
+    {
+        _nodes[oldParent].left = newParent;
+    }
+    else
+    {
+        _nodes[oldParent].right = newParent;
+    }
+
+    for(index = newParent; index != null; index = _nodes[index].parent)
+    {
+        index = balance(index);
+        refit(index);
+    }
+}
+
+void SpatialIndex::removeLeaf(int leaf)
+{
+    if(leaf == _root)
+    {
+        _root = null;
+        return;
+    }
+
+    const int parent = _nodes[leaf].parent;
+    const int grandParent = _nodes[parent].parent;
+    const int sibling = _nodes[parent].left == leaf ? _nodes[parent].right : _nodes[parent].left;
+
+    _nodes[leaf].parent = null;
+    freeNode(parent);
+
+    if(grandParent == null)
+    {
+        _root = sibling;
+        _nodes[sibling].parent = null;
+        return;
+    }
+
+    if(_nodes[grandParent].left == parent)
+    {
+        _nodes[grandParent].left = sibling;
+    }
+    else
+    {
+        _nodes[grandParent].right = sibling;
+    }
+    _nodes[sibling].parent = grandParent;
+
+    for(int index = grandParent; index != null; index = _nodes[index].parent)
+    {
+        index = balance(index);
+        refit(index);
+    }
+}
+
+void SpatialIndex::refit(int index)
+{
+    Node& node = _nodes[index];
+    const Node& left = _nodes[node.left];
+    const Node& right = _nodes[node.right];
+
+    node.bounds = AABB::merge(left.bounds, right.bounds);
+    node.height = 1 + std::max(left.height, right.height);
+    node.mask = left.mask | right.mask;
+}
+
+int SpatialIndex::balance(int a)
+{
+    if(_nodes[a].isLeaf() || _nodes[a].height < 2)
+    {
+        return a;
+    }
+
+    const int b = _nodes[a].left;
+    const int c = _nodes[a].right;
+    const int difference = _nodes[c].height - _nodes[b].height;
+
+    if(difference >= -1 && difference <= 1)
+    {
+        return a;
+    }
+
+    // The taller child takes the place of a, a keeps the shorter grandchild
+    const bool rightIsTaller = difference > 1;
+    const int up = rightIsTaller ? c : b;
+    const int f = _nodes[up].left;
+    const int g = _nodes[up].right;
+
+    _nodes[up].left = a;
+    _nodes[up].parent = _nodes[a].parent;
+    _nodes[a].parent = up;
+
+    const int parent = _nodes[up].parent;
+    if(parent == null)
+    {
+        _root = up;
+    }
+    else if(_nodes[parent].left == a)
+    {
+        _nodes[parent].left = up;
+    }
+    else
+    {
+        _nodes[parent].right = up;
+    }
+
+    const int kept = _nodes[f].height > _nodes[g].height ? f : g;
+    const int given = kept == f ? g : f;
+
+    _nodes[up].right = kept;
+    if(rightIsTaller)
+    {
+        _nodes[a].right = given;
+    }
+    else
+    {
+        _nodes[a].left = given;
+    }
+    _nodes[given].parent = a;
+
+    refit(a);
+    refit(up);
+    return up;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////// QUERIES
+///////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename Test>
+void SpatialIndex::traverse(uint32_t mask, Test test, std::vector<SceneObject*>& results) const
+{
+    if(_root == null)
+    {
+        return;
+    }
+
+    _stack.clear();
+    _stack.push_back(_root);
+
+    while(!_stack.empty())
+    {
+        int index = _stack.back();
+        _stack.pop_back();
+
+        const Node& node = _nodes[index];
+        if((node.mask & mask) == 0 || !test(node.bounds))
+        {
+            continue;
+        }
+
+        if(node.isLeaf())
+        {
+            results.push_back(node.object);
+            continue;
+        }
+
+        _stack.push_back(node.left);
+        _stack.push_back(node.right);
+    }
+}
+
+void SpatialIndex::collectSubtree(int index, uint32_t mask, std::vector<SceneObject*>& results) const
+{
+    _subtreeStack.clear();
+    _subtreeStack.push_back(index);
+
+    while(!_subtreeStack.empty())
+    {
+        const Node& node = _nodes[_subtreeStack.back()];
+        _subtreeStack.pop_back();
+
+        if((node.mask & mask) == 0)
+        {
+            continue;
+        }
+
+        if(node.isLeaf())
+        {
+            results.push_back(node.object);
+            continue;
+        }
+
+        _subtreeStack.push_back(node.left);
+        _subtreeStack.push_back(node.right);
+    }
+}
+
+void SpatialIndex::queryFrustum(const Frustum& frustum, std::vector<SceneObject*>& results, uint32_t mask) const
+{
+    if(_root == null)
+    {
+        return;
+    }
+
+    _stack.clear();
+    _stack.push_back(_root);
+
+    while(!_stack.empty())
+    {
+        int index = _stack.back();
+        _stack.pop_back();
+
+        const Node& node = _nodes[index];
+        if((node.mask & mask) == 0)
+        {
+            continue;
+        }
+
+        E_Containment containment = frustum.classify(node.bounds);
+        if(containment == E_Containment::OUTSIDE)
+        {
+            continue;
+        }
+
+        // Everything below a node fully inside the frustum is visible, no need to test it
+        if(containment == E_Containment::INSIDE || node.isLeaf())
+        {
+            collectSubtree(index, mask, results);
+            continue;
+        }
+
+        _stack.push_back(node.left);
+        _stack.push_back(node.right);
+    }
+}
+
+void SpatialIndex::querySphere(const BoundingSphere& sphere, std::vector<SceneObject*>& results, uint32_t mask) const
+{
+    const float radius2 = sphere.radius * sphere.radius;
+
+    traverse(mask, [&](const AABB& box)
+    {
+        glm::vec3 closest = glm::clamp(sphere.center, box.min, box.max);
+        glm::vec3 offset = closest - sphere.center;
+        return glm::dot(offset, offset) <= radius2;
+    }, results);
+}
+
+void SpatialIndex::queryCone(const glm::vec3& apex, const glm::vec3& direction, float angle, float range, std::vector<SceneObject*>& results, uint32_t mask) const
+{
+    const glm::vec3 axis = glm::normalize(direction);
+    const float cosine = std::cos(angle);
+    const float sine = std::sin(angle);
+
+    // Tested on the sphere around each box, conservative but cheap
+    traverse(mask, [&](const AABB& box)
+    {
+        BoundingSphere sphere = enclosingSphere(box);
+        glm::vec3 offset = sphere.center - apex;
+
+        float along = glm::dot(offset, axis);
+        if(along > range + sphere.radius || along < -sphere.radius)
+        {
+            return false;
+        }
+
+        float across = std::sqrt(std::max(glm::dot(offset, offset) - along * along, 0.0f));
+        return cosine * across - sine * along <= sphere.radius;
+    }, results);
+}
+
+void SpatialIndex::queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<RayHit>& hits, uint32_t mask) const
+{
+    if(_root == null)
+    {
+        return;
+    }
+
+    const glm::vec3 unit = glm::normalize(direction);
+    const glm::vec3 inverseDirection(1.0f / unit.x, 1.0f / unit.y, 1.0f / unit.z);
+    const size_t firstHit = hits.size();
+
+    _stack.clear();
+    _stack.push_back(_root);
+
+    while(!_stack.empty())
+    {
+        int index = _stack.back();
+        _stack.pop_back();
+
+        const Node& node = _nodes[index];
+        if((node.mask & mask) == 0)
+        {
+            continue;
+        }
+
+        float distance = rayBoxDistance(origin, inverseDirection, maxDistance, node.bounds);
+        if(distance < 0.0f)
+        {
+            continue;
+        }
+
+        if(node.isLeaf())
+        {
+            hits.push_back({node.object, distance});
+            continue;
+        }
+
+        _stack.push_back(node.left);
+        _stack.push_back(node.right);
+    }
+
+    std::sort(hits.begin() + firstHit, hits.end(), [](const RayHit& a, const RayHit& b) { return a.distance < b.distance; });
+}
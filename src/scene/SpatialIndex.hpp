@@ -0,0 +1,91 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// First-party includes
+#include "util/Culling.hpp"
+
+// Third-party includes
+#include <glm/glm.hpp>
+
+class SceneObject;
+
+struct RayHit
+{
+    SceneObject* object;
+    // Along the ray, to the entry point of the object's box
+    float distance;
+};
+
+// Dynamic bounding volume hierarchy over the objects of a Scene.
+// Leaves keep a box slightly larger than their object, moving inside it costs nothing,
+// leaving it reinserts the leaf where it grows the tree the least and rebalances the path to the root.
+// Every object carries a mask, queries skip the subtrees holding none of the requested bits.
+class SpatialIndex
+{
+public:
+    static constexpr int null = -1;
+
+    SpatialIndex(float margin = 0.5f);
+
+    int insert(SceneObject* object, const AABB& bounds, uint32_t mask);
+    void remove(int proxy);
+    // Returns true if the leaf had to be reinserted
+    bool move(int proxy, const AABB& bounds);
+
+    SceneObject* getObject(int proxy) const { return _nodes[proxy].object; }
+    const AABB& getFatBounds(int proxy) const { return _nodes[proxy].bounds; }
+    size_t size() const { return _leafCount; }
+    int getHeight() const;
+
+    // Results are appended, without clearing the vectors first
+    void queryFrustum(const Frustum& frustum, std::vector<SceneObject*>& results, uint32_t mask = ~0u) const;
+    void querySphere(const BoundingSphere& sphere, std::vector<SceneObject*>& results, uint32_t mask = ~0u) const;
+    // Half angle in radians, the cone ends at range from the apex
+    void queryCone(const glm::vec3& apex, const glm::vec3& direction, float angle, float range, std::vector<SceneObject*>& results, uint32_t mask = ~0u) const;
+    // Hits are sorted from the closest one
+    void queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<RayHit>& hits, uint32_t mask = ~0u) const;
+
+private:
+    struct Node
+    {
+        AABB bounds;
+        int parent;
+        int left;
+        int right;
+        int height;
+        // Leaves only, inner nodes combine the masks of their children
+        SceneObject* object;
+        uint32_t mask;
+
+        bool isLeaf() const { return left == null; }
+    };
+
+    int allocateNode();
+    void freeNode(int index);
+
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    // Recompute bounds, height and mask of an inner node from its children
+    void refit(int index);
+    // Rotate the taller child up when the heights differ by more than one, returns the new subtree root
+    int balance(int index);
+
+    // Visits the leaves whose box passes the test, subtrees failing it are skipped
+    template <typename Test>
+    void traverse(uint32_t mask, Test test, std::vector<SceneObject*>& results) const;
+    void collectSubtree(int index, uint32_t mask, std::vector<SceneObject*>& results) const;
+
+    std::vector<Node> _nodes;
+    int _root;
+    int _freeList;
+    size_t _leafCount;
+    float _margin;
+
+    // Traversal stacks of the queries
+    mutable std::vector<int> _stack;
+    mutable std::vector<int> _subtreeStack;
+};
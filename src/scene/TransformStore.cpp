@@ -0,0 +1,304 @@
+#include "scene/TransformStore.hpp"
+
+#include "util/Profiler.hpp"
+
+#include <algorithm>
+
+TransformStore& TransformStore::Instance()
+{
+    if (instance == nullptr)
+    {
+        instance = new TransformStore();
+    }
+    return *instance;
+}
+
+unsigned int TransformStore::allocate()
+{
+    unsigned int index;
+    if(!_freeSlots.empty())
+    {
+        index = _freeSlots.back();
+        _freeSlots.pop_back();
+    }
+    else
+    {
+        index = static_cast<unsigned int>(_positions.size());
+        _positions.emplace_back();
+        _rotations.emplace_back();
+        _scales.emplace_back();
+        _worldMatrices.emplace_back();
+        _versions.emplace_back();
+        _offsets.emplace_back();
+        _hasOffset.emplace_back();
+        _parents.emplace_back();
+        _firstChildren.emplace_back();
+        _nextSiblings.emplace_back();
+        _generations.emplace_back();
+        if((index >> 6) >= _dirty.size())
+        {
+            _dirty.push_back(0);
+        }
+    }
+
+    _positions[index] = {0.0f, 0.0f, 0.0f};
+    _rotations[index] = glm::fquat(1.0f, 0.0f, 0.0f, 0.0f);
+    _scales[index] = 1.0f;
+    ++_versions[index];
+    _hasOffset[index] = 0;
+    _parents[index] = none;
+    _firstChildren[index] = none;
+    _nextSiblings[index] = none;
+    markDirty(index);
+
+    return index;
+}
+
+void TransformStore::release(unsigned int index)
+{
+    unlink(index);
+
+    for(unsigned int child = _firstChildren[index]; child != none; )
+    {
+        unsigned int next = _nextSiblings[child];
+        _parents[child] = none;
+        _nextSiblings[child] = none;
+        markDirty(child);
+        child = next;
+    }
+    _firstChildren[index] = none;
+
+    clearDirty(index);
+    ++_generations[index];
+    _freeSlots.push_back(index);
+}
+
+unsigned int TransformStore::getHandle(unsigned int index) const
+{
+    // The last index would read as none
+    if(index >= handleIndexMask)
+    {
+        return none;
+    }
+    return (static_cast<unsigned int>(_generations[index]) << handleIndexBits) | index;
+}
+
+unsigned int TransformStore::resolve(unsigned int handle) const
+{
+    unsigned int index = handle & handleIndexMask;
+    if(handle == none || index >= _generations.size() || _generations[index] != (handle >> handleIndexBits))
+    {
+        return none;
+    }
+    return index;
+}
+
+void TransformStore::unlink(unsigned int index)
+{
+    unsigned int parent = _parents[index];
+    if(parent == none)
+    {
+        return;
+    }
+
+    if(_firstChildren[parent] == index)
+    {
+        _firstChildren[parent] = _nextSiblings[index];
+    }
+    else
+    {
+        unsigned int sibling = _firstChildren[parent];
+        while(_nextSiblings[sibling] != index)
+        {
+            sibling = _nextSiblings[sibling];
+        }
+        _nextSiblings[sibling] = _nextSiblings[index];
+    }
+
+    _parents[index] = none;
+    _nextSiblings[index] = none;
+}
+
+void TransformStore::setParent(unsigned int index, unsigned int parent)
+{
+    // Refuse cycles
+    for(unsigned int ancestor = parent; ancestor != none; ancestor = _parents[ancestor])
+    {
+        if(ancestor == index)
+        {
+            return;
+        }
+    }
+
+    unlink(index);
+
+    if(parent != none)
+    {
+        _parents[index] = parent;
+        _nextSiblings[index] = _firstChildren[parent];
+        _firstChildren[parent] = index;
+    }
+
+    markDirty(index);
+}
+
+void TransformStore::setOffset(unsigned int index, const glm::mat4& offset)
+{
+    _offsets[index] = offset;
+    _hasOffset[index] = offset != glm::mat4(1.0f);
+    markDirty(index);
+}
+
+void TransformStore::setPosition(unsigned int index, const std::array<float, 3>& position)
+{
+    _positions[index] = position;
+    markDirty(index);
+}
+
+void TransformStore::setRotation(unsigned int index, const glm::fquat& rotation)
+{
+    _rotations[index] = rotation;
+    markDirty(index);
+}
+
+void TransformStore::setScale(unsigned int index, float scale)
+{
+    _scales[index] = scale;
+    markDirty(index);
+}
+
+const glm::mat4& TransformStore::getWorldMatrix(unsigned int index)
+{
+    unsigned int root = dirtyRoot(index);
+    if(root != none)
+    {
+        updateSubtree(root);
+    }
+    return _worldMatrices[index];
+}
+
+unsigned int TransformStore::dirtyRoot(unsigned int index) const
+{
+    unsigned int root = none;
+    for(unsigned int entry = index; entry != none; entry = _parents[entry])
+    {
+        if(isDirty(entry))
+        {
+            root = entry;
+        }
+    }
+    return root;
+}
+
+void TransformStore::updateSubtree(unsigned int index)
+{
+    _subtreeStack.clear();
+    _subtreeStack.push_back(index);
+
+    // Parents are always popped before their children
+    while(!_subtreeStack.empty())
+    {
+        unsigned int entry = _subtreeStack.back();
+        _subtreeStack.pop_back();
+
+        compose(entry);
+        clearDirty(entry);
+
+        for(unsigned int child = _firstChildren[entry]; child != none; child = _nextSiblings[child])
+        {
+            _subtreeStack.push_back(child);
+        }
+    }
+}
+
+void TransformStore::composeLocal(unsigned int index)
+{
+    const std::array<float, 3>& p = _positions[index];
+    const glm::fquat& q = _rotations[index];
+    const float s = _scales[index];
+
+    const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    ++_versions[index];
+
+    glm::mat4& m = _worldMatrices[index];
+    m[0] = glm::vec4(s * (1.0f - 2.0f * (yy + zz)), s * 2.0f * (xy + wz), s * 2.0f * (xz - wy), 0.0f);
+    m[1] = glm::vec4(s * 2.0f * (xy - wz), s * (1.0f - 2.0f * (xx + zz)), s * 2.0f * (yz + wx), 0.0f);
+    m[2] = glm::vec4(s * 2.0f * (xz + wy), s * 2.0f * (yz - wx), s * (1.0f - 2.0f * (xx + yy)), 0.0f);
+    m[3] = glm::vec4(p[0], p[1], p[2], 1.0f);
+}
+
+void TransformStore::compose(unsigned int index)
+{
+    composeLocal(index);
+
+    glm::mat4& m = _worldMatrices[index];
+    if(_hasOffset[index])
+    {
+        m = m * _offsets[index];
+    }
+    if(_parents[index] != none)
+    {
+        m = _worldMatrices[_parents[index]] * m;
+    }
+}
+
+void TransformStore::update()
+{
+    FLUX_PROFILE_FUNCTION();
+
+    const unsigned int count = static_cast<unsigned int>(_positions.size());
+
+    for(unsigned int word = 0; word < _dirty.size(); ++word)
+    {
+        if(_dirty[word] == 0)
+        {
+            continue;
+        }
+
+        const unsigned int first = word << 6;
+        const unsigned int last = std::min(first + 64, count);
+
+        // A whole block of flat objects changed, as when every object moves each frame.
+        // One straight loop over the arrays, which the compiler can vectorize.
+        if(_dirty[word] == ~uint64_t(0))
+        {
+            bool flat = true;
+            for(unsigned int index = first; index < last; ++index)
+            {
+                flat &= _parents[index] == none && _firstChildren[index] == none && !_hasOffset[index];
+            }
+
+            if(flat)
+            {
+                for(unsigned int index = first; index < last; ++index)
+                {
+                    composeLocal(index);
+                }
+                _dirty[word] = 0;
+                continue;
+            }
+        }
+
+        for(unsigned int index = first; index < last; ++index)
+        {
+            // Rebuilding a subtree may have cleared later bits already
+            if(!isDirty(index))
+            {
+                continue;
+            }
+
+            // Flat objects, the common case, skip the hierarchy walk
+            if(_parents[index] == none && _firstChildren[index] == none)
+            {
+                compose(index);
+                clearDirty(index);
+                continue;
+            }
+
+            updateSubtree(dirtyRoot(index));
+        }
+    }
+}
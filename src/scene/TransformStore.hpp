@@ -0,0 +1,112 @@
+#pragma once
+
+// STL includes
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Third-party includes
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Position, rotation and scale of every SceneObject, one array per field.
+// Writes only flag the entry as dirty, world matrices are rebuilt in one batch by update().
+// Entries can have a parent, world = parent world * translate * scale * rotate * offset,
+// and a changed entry rebuilds its own subtree only.
+class TransformStore
+{
+public:
+    static constexpr unsigned int none = static_cast<unsigned int>(-1);
+
+    static TransformStore& Instance();
+
+    // Identity transform without parent
+    unsigned int allocate();
+    // Children of a released entry become roots
+    void release(unsigned int index);
+
+    // Index and generation of an entry in one value, for handles given out of the engine.
+    // Releasing an entry bumps its generation, handles kept past that no longer resolve.
+    unsigned int getHandle(unsigned int index) const;
+    // Entry of a handle, none when the handle is unknown or its entry was released since
+    unsigned int resolve(unsigned int handle) const;
+
+    // none detaches the entry
+    void setParent(unsigned int index, unsigned int parent);
+    unsigned int getParent(unsigned int index) const { return _parents[index]; }
+
+    // Fixed matrix applied before the entry's own transform, used for imported node transforms
+    void setOffset(unsigned int index, const glm::mat4& offset);
+
+    void setPosition(unsigned int index, const std::array<float, 3>& position);
+    void setRotation(unsigned int index, const glm::fquat& rotation);
+    void setScale(unsigned int index, float scale);
+    // All three at once, in the header so that bulk updates inline it
+    void set(unsigned int index, const std::array<float, 3>& position, const glm::fquat& rotation, float scale)
+    {
+        _positions[index] = position;
+        _rotations[index] = rotation;
+        _scales[index] = scale;
+        markDirty(index);
+    }
+
+    const std::array<float, 3>& getPosition(unsigned int index) const { return _positions[index]; }
+    const glm::fquat& getRotation(unsigned int index) const { return _rotations[index]; }
+    float getScale(unsigned int index) const { return _scales[index]; }
+
+    // Rebuilt on the spot if the entry or one of its ancestors changed since the last update()
+    const glm::mat4& getWorldMatrix(unsigned int index);
+
+    // Bumped every time the world matrix is rebuilt, lets callers skip entries that did not move
+    uint32_t getVersion(unsigned int index) const { return _versions[index]; }
+
+    // Rebuild the world matrix of every dirty entry, once per frame
+    void update();
+
+    size_t size() const { return _positions.size(); }
+
+private:
+    TransformStore() = default;
+    TransformStore(const TransformStore&) = delete;
+    TransformStore& operator=(const TransformStore&) = delete;
+
+    void markDirty(unsigned int index) { _dirty[index >> 6] |= uint64_t(1) << (index & 63); }
+    void clearDirty(unsigned int index) { _dirty[index >> 6] &= ~(uint64_t(1) << (index & 63)); }
+    bool isDirty(unsigned int index) const { return (_dirty[index >> 6] >> (index & 63)) & 1; }
+
+    void unlink(unsigned int index);
+
+    // Low bits of a handle, the generation takes the rest and wraps after 256 releases of a slot
+    static constexpr unsigned int handleIndexBits = 24;
+    static constexpr unsigned int handleIndexMask = (1u << handleIndexBits) - 1;
+
+    // translate * scale * rotate, as in glm but without the intermediate matrices
+    void composeLocal(unsigned int index);
+    // Local transform, then offset and parent
+    void compose(unsigned int index);
+    // Highest dirty entry among the index and its ancestors
+    unsigned int dirtyRoot(unsigned int index) const;
+    // Rebuild an entry and all of its descendants
+    void updateSubtree(unsigned int index);
+
+    std::vector<std::array<float, 3>> _positions;
+    std::vector<glm::fquat> _rotations;
+    std::vector<float> _scales;
+    std::vector<glm::mat4> _worldMatrices;
+    std::vector<uint32_t> _versions;
+    std::vector<glm::mat4> _offsets;
+    std::vector<uint8_t> _hasOffset;
+
+    // Hierarchy, children are kept as a linked list
+    std::vector<unsigned int> _parents;
+    std::vector<unsigned int> _firstChildren;
+    std::vector<unsigned int> _nextSiblings;
+    std::vector<unsigned int> _subtreeStack;
+
+    // One bit per entry
+    std::vector<uint64_t> _dirty;
+    std::vector<unsigned int> _freeSlots;
+    std::vector<uint8_t> _generations;
+
+    inline static TransformStore* instance = nullptr;
+};
@@ -0,0 +1,212 @@
+#include "util/Culling.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FLUX_CULLING_SSE
+#include <xmmintrin.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////// BOUNDING SPHERE
+///////////////////////////////////////////////////////////////////////////////////////////
+
+BoundingSphere BoundingSphere::transformed(const glm::mat4& matrix) const
+{
+    float scale = std::max({
+        glm::dot(glm::vec3(matrix[0]), glm::vec3(matrix[0])),
+        glm::dot(glm::vec3(matrix[1]), glm::vec3(matrix[1])),
+        glm::dot(glm::vec3(matrix[2]), glm::vec3(matrix[2]))
+        });
+
+    BoundingSphere result;
+    result.center = glm::vec3(matrix * glm::vec4(center, 1.0f));
+    result.radius = radius * std::sqrt(scale);
+    return result;
+}
+
+BoundingSphere BoundingSphere::merge(const BoundingSphere& a, const BoundingSphere& b)
+{
+    glm::vec3 offset = b.center - a.center;
+    float distance = glm::length(offset);
+
+    if(distance + b.radius <= a.radius)
+    {
+        return a;
+    }
+    if(distance + a.radius <= b.radius)
+    {
+        return b;
+    }
+
+    BoundingSphere result;
+    result.radius = (distance + a.radius + b.radius) * 0.5f;
+    result.center = a.center + offset * ((result.radius - a.radius) / distance);
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////// AABB
+///////////////////////////////////////////////////////////////////////////////////////////
+
+AABB AABB::fromSphere(const BoundingSphere& sphere)
+{
+    AABB result;
+    result.min = sphere.center - glm::vec3(sphere.radius);
+    result.max = sphere.center + glm::vec3(sphere.radius);
+    return result;
+}
+
+AABB AABB::merge(const AABB& a, const AABB& b)
+{
+    AABB result;
+    result.min = glm::min(a.min, b.min);
+    result.max = glm::max(a.max, b.max);
+    return result;
+}
+
+bool AABB::contains(const AABB& other) const
+{
+    return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+           max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+}
+
+bool AABB::overlaps(const AABB& other) const
+{
+    return min.x <= other.max.x && max.x >= other.min.x &&
+           min.y <= other.max.y && max.y >= other.min.y &&
+           min.z <= other.max.z && max.z >= other.min.z;
+}
+
+float AABB::perimeter() const
+{
+    glm::vec3 size = max - min;
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+AABB AABB::grown(float margin) const
+{
+    AABB result;
+    result.min = min - glm::vec3(margin);
+    result.max = max + glm::vec3(margin);
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////// FRUSTUM
+///////////////////////////////////////////////////////////////////////////////////////////
+
+Frustum::Frustum()
+{
+    // Accepts everything until built from a matrix
+    _planes.fill(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+Frustum::Frustum(const glm::mat4& viewProjection)
+{
+    // Gribb & Hartmann, glm matrices are column major so the rows are gathered by hand
+    glm::vec4 rows[4];
+    for(int i = 0; i < 4; ++i)
+    {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+
+    _planes[0] = rows[3] + rows[0];     // Left
+    _planes[1] = rows[3] - rows[0];     // Right
+    _planes[2] = rows[3] + rows[1];     // Bottom
+    _planes[3] = rows[3] - rows[1];     // Top
+    _planes[4] = rows[3] + rows[2];     // Near
+    _planes[5] = rows[3] - rows[2];     // Far
+
+    for(glm::vec4& plane : _planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+
+bool Frustum::intersects(const BoundingSphere& sphere) const
+{
+    for(const glm::vec4& plane : _planes)
+    {
+        if(glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+E_Containment Frustum::classify(const AABB& box) const
+{
+    E_Containment result = E_Containment::INSIDE;
+    for(const glm::vec4& plane : _planes)
+    {
+        // Corners furthest along and against the plane normal
+        glm::vec3 positive(plane.x >= 0.0f ? box.max.x : box.min.x, plane.y >= 0.0f ? box.max.y : box.min.y, plane.z >= 0.0f ? box.max.z : box.min.z);
+        glm::vec3 negative(plane.x >= 0.0f ? box.min.x : box.max.x, plane.y >= 0.0f ? box.min.y : box.max.y, plane.z >= 0.0f ? box.min.z : box.max.z);
+
+        if(glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f)
+        {
+            return E_Containment::OUTSIDE;
+        }
+        if(glm::dot(glm::vec3(plane), negative) + plane.w < 0.0f)
+        {
+            result = E_Containment::INTERSECTS;
+        }
+    }
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////// KERNELS
+///////////////////////////////////////////////////////////////////////////////////////////
+
+namespace culling
+{
+    void frustumSpheres(const Frustum& frustum, const float* x, const float* y, const float* z, const float* radius, std::size_t count, uint8_t* visible)
+    {
+        const std::array<glm::vec4, 6>& planes = frustum.getPlanes();
+        std::size_t i = 0;
+
+#ifdef FLUX_CULLING_SSE
+        __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+        for(int p = 0; p < 6; ++p)
+        {
+            planeX[p] = _mm_set1_ps(planes[p].x);
+            planeY[p] = _mm_set1_ps(planes[p].y);
+            planeZ[p] = _mm_set1_ps(planes[p].z);
+            planeW[p] = _mm_set1_ps(planes[p].w);
+        }
+
+        const __m128 zero = _mm_setzero_ps();
+        for(; i + 4 <= count; i += 4)
+        {
+            __m128 sx = _mm_loadu_ps(x + i);
+            __m128 sy = _mm_loadu_ps(y + i);
+            __m128 sz = _mm_loadu_ps(z + i);
+            __m128 negativeRadius = _mm_sub_ps(zero, _mm_loadu_ps(radius + i));
+
+            __m128 inside = _mm_cmpeq_ps(zero, zero);
+            for(int p = 0; p < 6; ++p)
+            {
+                __m128 distance = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(planeX[p], sx), _mm_mul_ps(planeY[p], sy)),
+                    _mm_add_ps(_mm_mul_ps(planeZ[p], sz), planeW[p]));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+            }
+
+            int mask = _mm_movemask_ps(inside);
+            visible[i + 0] = static_cast<uint8_t>(mask & 1);
+            visible[i + 1] = static_cast<uint8_t>((mask >> 1) & 1);
+            visible[i + 2] = static_cast<uint8_t>((mask >> 2) & 1);
+            visible[i + 3] = static_cast<uint8_t>((mask >> 3) & 1);
+        }
+#endif
+
+        for(; i < count; ++i)
+        {
+            visible[i] = frustum.intersects({glm::vec3(x[i], y[i], z[i]), radius[i]}) ? 1 : 0;
+        }
+    }
+}
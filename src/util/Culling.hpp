@@ -0,0 +1,64 @@
+#pragma once
+
+// STL includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Third-party includes
+#include <glm/glm.hpp>
+
+struct BoundingSphere
+{
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+
+    // The radius follows the largest axis scale of the matrix
+    BoundingSphere transformed(const glm::mat4& matrix) const;
+    // Smallest sphere enclosing both
+    static BoundingSphere merge(const BoundingSphere& a, const BoundingSphere& b);
+};
+
+struct AABB
+{
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+
+    static AABB fromSphere(const BoundingSphere& sphere);
+    static AABB merge(const AABB& a, const AABB& b);
+
+    bool contains(const AABB& other) const;
+    bool overlaps(const AABB& other) const;
+    // Half the surface area, only used to compare boxes
+    float perimeter() const;
+    AABB grown(float margin) const;
+};
+
+enum class E_Containment
+{
+    OUTSIDE,
+    INTERSECTS,
+    INSIDE
+};
+
+// The six planes of a view projection matrix, normals point inside
+class Frustum
+{
+public:
+    Frustum();
+    explicit Frustum(const glm::mat4& viewProjection);
+
+    const std::array<glm::vec4, 6>& getPlanes() const { return _planes; }
+    bool intersects(const BoundingSphere& sphere) const;
+    E_Containment classify(const AABB& box) const;
+
+private:
+    std::array<glm::vec4, 6> _planes;
+};
+
+// Spheres are passed as one array per component so that the kernel tests four of them per SSE instruction
+namespace culling
+{
+    // visible[i] is 1 if sphere i touches the frustum, 0 otherwise
+    void frustumSpheres(const Frustum& frustum, const float* x, const float* y, const float* z, const float* radius, std::size_t count, uint8_t* visible);
+}
@@ -0,0 +1,385 @@
+#include "util/MeshSimplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+namespace
+{
+    // Symmetric 4x4 matrix, the sum of the squared distances to a set of planes
+    struct Quadric
+    {
+        double xx = 0.0, xy = 0.0, xz = 0.0, xw = 0.0;
+        double yy = 0.0, yz = 0.0, yw = 0.0;
+        double zz = 0.0, zw = 0.0;
+        double ww = 0.0;
+
+        void addPlane(const glm::dvec3& normal, double distance)
+        {
+            xx += normal.x * normal.x; xy += normal.x * normal.y; xz += normal.x * normal.z; xw += normal.x * distance;
+            yy += normal.y * normal.y; yz += normal.y * normal.z; yw += normal.y * distance;
+            zz += normal.z * normal.z; zw += normal.z * distance;
+            ww += distance * distance;
+        }
+
+        Quadric& operator+=(const Quadric& other)
+        {
+            xx += other.xx; xy += other.xy; xz += other.xz; xw += other.xw;
+            yy += other.yy; yz += other.yz; yw += other.yw;
+            zz += other.zz; zw += other.zw;
+            ww += other.ww;
+            return *this;
+        }
+
+        double evaluate(const glm::vec3& point) const
+        {
+            const double x = point.x, y = point.y, z = point.z;
+            double error = xx * x * x + 2.0 * xy * x * y + 2.0 * xz * x * z + 2.0 * xw * x
+                         + yy * y * y + 2.0 * yz * y * z + 2.0 * yw * y
+                         + zz * z * z + 2.0 * zw * z
+                         + ww;
+            // Rounding can leave it slightly negative
+            return std::max(error, 0.0);
+        }
+    };
+
+    struct Collapse
+    {
+        double cost;
+        unsigned int from;
+        unsigned int to;
+        // Versions of both vertices when the cost was computed, the entry is stale once one changed
+        unsigned int fromVersion;
+        unsigned int toVersion;
+
+        bool operator>(const Collapse& other) const { return cost > other.cost; }
+    };
+
+    uint64_t edgeKey(unsigned int a, unsigned int b)
+    {
+        return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+    }
+
+    class Simplifier
+    {
+    public:
+        Simplifier(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices);
+
+        size_t getIndexCount() const { return _liveTriangles * 3; }
+        double getMaxCost() const { return _maxCost; }
+        // Returns false once the queue holds no valid collapse
+        bool collapseNext();
+        std::vector<unsigned int> gatherIndices() const;
+
+    private:
+        bool contains(unsigned int triangle, unsigned int vertex) const;
+        bool isValid(unsigned int from, unsigned int to);
+        void collapse(unsigned int from, unsigned int to);
+        void pushCollapse(unsigned int from, unsigned int to);
+        // Live vertices sharing a triangle with the vertex, the dead triangles are dropped from its list on the way
+        void gatherNeighbours(unsigned int vertex, std::vector<unsigned int>& neighbours);
+
+        const std::vector<glm::vec3>& _positions;
+        std::vector<unsigned int> _triangles;
+        std::vector<uint8_t> _removed;
+        size_t _liveTriangles;
+
+        std::vector<std::vector<unsigned int>> _vertexTriangles;
+        std::vector<Quadric> _quadrics;
+        std::vector<uint8_t> _locked;
+        std::vector<unsigned int> _versions;
+
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> _queue;
+        double _maxCost;
+
+        // Neighbours of both ends of the edge being checked
+        std::vector<unsigned int> _fromNeighbours, _toNeighbours;
+    };
+
+    Simplifier::Simplifier(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices) :
+        _positions(positions),
+        _liveTriangles(0),
+        _vertexTriangles(positions.size()),
+        _quadrics(positions.size()),
+        _locked(positions.size(), 0),
+        _versions(positions.size(), 0),
+        _maxCost(0.0)
+    {
+        // Degenerate triangles would only get in the way
+        _triangles.reserve(indices.size());
+        for(size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+            if(a == b || b == c || a == c)
+            {
+                continue;
+            }
+            _triangles.push_back(a);
+            _triangles.push_back(b);
+            _triangles.push_back(c);
+        }
+        _liveTriangles = _triangles.size() / 3;
+        _removed.assign(_liveTriangles, 0);
+
+        std::unordered_map<uint64_t, unsigned int> edgeUses;
+        edgeUses.reserve(_triangles.size());
+
+        for(unsigned int triangle = 0; triangle < _liveTriangles; ++triangle)
+        {
+            const unsigned int* corners = &_triangles[triangle * 3];
+            const glm::dvec3 p0 = _positions[corners[0]], p1 = _positions[corners[1]], p2 = _positions[corners[2]];
+
+            glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+            double length = glm::length(normal);
+            if(length > 0.0)
+            {
+                normal /= length;
+                Quadric plane;
+                plane.addPlane(normal, -glm::dot(normal, p0));
+                for(int corner = 0; corner < 3; ++corner)
+                {
+                    _quadrics[corners[corner]] += plane;
+                }
+            }
+
+            for(int corner = 0; corner < 3; ++corner)
+            {
+                _vertexTriangles[corners[corner]].push_back(triangle);
+                ++edgeUses[edgeKey(corners[corner], corners[(corner + 1) % 3])];
+            }
+        }
+
+        // Edges with a single triangle are borders, more than two is not a surface the collapses can reason about
+        for(const auto& edge : edgeUses)
+        {
+            if(edge.second != 2)
+            {
+                _locked[static_cast<unsigned int>(edge.first >> 32)] = 1;
+                _locked[static_cast<unsigned int>(edge.first & 0xffffffffu)] = 1;
+            }
+        }
+
+        for(const auto& edge : edgeUses)
+        {
+            unsigned int a = static_cast<unsigned int>(edge.first >> 32);
+            unsigned int b = static_cast<unsigned int>(edge.first & 0xffffffffu);
+            pushCollapse(a, b);
+            pushCollapse(b, a);
+        }
+    }
+
+    bool Simplifier::contains(unsigned int triangle, unsigned int vertex) const
+    {
+        const unsigned int* corners = &_triangles[triangle * 3];
+        return corners[0] == vertex || corners[1] == vertex || corners[2] == vertex;
+    }
+
+    void Simplifier::pushCollapse(unsigned int from, unsigned int to)
+    {
+        if(_locked[from])
+        {
+            return;
+        }
+
+        Quadric combined = _quadrics[from];
+        combined += _quadrics[to];
+        _queue.push({combined.evaluate(_positions[to]), from, to, _versions[from], _versions[to]});
+    }
+
+    void Simplifier::gatherNeighbours(unsigned int vertex, std::vector<unsigned int>& neighbours)
+    {
+        neighbours.clear();
+
+        std::vector<unsigned int>& triangles = _vertexTriangles[vertex];
+        triangles.erase(std::remove_if(triangles.begin(), triangles.end(), [&](unsigned int triangle) { return _removed[triangle] != 0; }), triangles.end());
+
+        for(unsigned int triangle : triangles)
+        {
+            for(int corner = 0; corner < 3; ++corner)
+            {
+                unsigned int other = _triangles[triangle * 3 + corner];
+                if(other != vertex && std::find(neighbours.begin(), neighbours.end(), other) == neighbours.end())
+                {
+                    neighbours.push_back(other);
+                }
+            }
+        }
+    }
+
+    bool Simplifier::isValid(unsigned int from, unsigned int to)
+    {
+        // The vertices both edge triangles have in front of the edge must be the only ones shared,
+        // any other one would pinch the surface into a non manifold edge
+        gatherNeighbours(from, _fromNeighbours);
+        gatherNeighbours(to, _toNeighbours);
+
+        size_t edgeTriangles = 0;
+        for(unsigned int triangle : _vertexTriangles[from])
+        {
+            edgeTriangles += contains(triangle, to) ? 1 : 0;
+        }
+
+        size_t shared = 0;
+        for(unsigned int neighbour : _fromNeighbours)
+        {
+            shared += std::find(_toNeighbours.begin(), _toNeighbours.end(), neighbour) != _toNeighbours.end() ? 1 : 0;
+        }
+        if(shared != edgeTriangles)
+        {
+            return false;
+        }
+
+        // No remaining triangle may flip over
+        const glm::vec3& target = _positions[to];
+        for(unsigned int triangle : _vertexTriangles[from])
+        {
+            if(contains(triangle, to))
+            {
+                continue;
+            }
+
+            const unsigned int* corners = &_triangles[triangle * 3];
+
+            // The same two neighbours also close a triangle with the kept vertex, as on a tetrahedron,
+            // the collapse would fold both onto each other
+            unsigned int first = corners[0] == from ? corners[1] : corners[0];
+            unsigned int second = corners[2] == from ? corners[1] : corners[2];
+            for(unsigned int other : _vertexTriangles[to])
+            {
+                if(contains(other, first) && contains(other, second))
+                {
+                    return false;
+                }
+            }
+
+            glm::vec3 before[3], after[3];
+            for(int corner = 0; corner < 3; ++corner)
+            {
+                before[corner] = _positions[corners[corner]];
+                after[corner] = corners[corner] == from ? target : before[corner];
+            }
+
+            glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+            glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+            if(glm::dot(normalBefore, normalAfter) <= 0.0f)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void Simplifier::collapse(unsigned int from, unsigned int to)
+    {
+        for(unsigned int triangle : _vertexTriangles[from])
+        {
+            if(contains(triangle, to))
+            {
+                _removed[triangle] = 1;
+                --_liveTriangles;
+                continue;
+            }
+
+            unsigned int* corners = &_triangles[triangle * 3];
+            for(int corner = 0; corner < 3; ++corner)
+            {
+                if(corners[corner] == from)
+                {
+                    corners[corner] = to;
+                }
+            }
+            _vertexTriangles[to].push_back(triangle);
+        }
+        _vertexTriangles[from].clear();
+
+        _quadrics[to] += _quadrics[from];
+        ++_versions[from];
+        ++_versions[to];
+
+        // Every edge around the kept vertex now costs something else
+        gatherNeighbours(to, _toNeighbours);
+        for(unsigned int neighbour : _toNeighbours)
+        {
+            pushCollapse(neighbour, to);
+            pushCollapse(to, neighbour);
+        }
+    }
+
+    bool Simplifier::collapseNext()
+    {
+        while(!_queue.empty())
+        {
+            Collapse candidate = _queue.top();
+            _queue.pop();
+
+            if(candidate.fromVersion != _versions[candidate.from] || candidate.toVersion != _versions[candidate.to])
+            {
+                continue;
+            }
+            if(!isValid(candidate.from, candidate.to))
+            {
+                continue;
+            }
+
+            _maxCost = std::max(_maxCost, candidate.cost);
+            collapse(candidate.from, candidate.to);
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<unsigned int> Simplifier::gatherIndices() const
+    {
+        std::vector<unsigned int> indices;
+        indices.reserve(_liveTriangles * 3);
+        for(size_t triangle = 0; triangle < _removed.size(); ++triangle)
+        {
+            if(!_removed[triangle])
+            {
+                indices.insert(indices.end(), &_triangles[triangle * 3], &_triangles[triangle * 3] + 3);
+            }
+        }
+        return indices;
+    }
+}
+
+namespace simplification
+{
+    std::vector<Level> simplify(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices, const std::vector<size_t>& targetIndexCounts)
+    {
+        std::vector<size_t> targets = targetIndexCounts;
+        std::sort(targets.begin(), targets.end(), std::greater<size_t>());
+
+        Simplifier simplifier(positions, indices);
+        std::vector<Level> levels;
+
+        for(size_t target : targets)
+        {
+            bool exhausted = false;
+            while(simplifier.getIndexCount() > target)
+            {
+                if(!simplifier.collapseNext())
+                {
+                    exhausted = true;
+                    break;
+                }
+            }
+
+            size_t previousCount = levels.empty() ? indices.size() : levels.back().indices.size();
+            if(simplifier.getIndexCount() < previousCount)
+            {
+                levels.push_back({simplifier.gatherIndices(), static_cast<float>(std::sqrt(simplifier.getMaxCost()))});
+            }
+            if(exhausted)
+            {
+                break;
+            }
+        }
+
+        return levels;
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <vector>
+
+// Third-party includes
+#include <glm/glm.hpp>
+
+// Quadric error edge collapse, used to build the levels of detail of imported meshes
+namespace simplification
+{
+    struct Level
+    {
+        std::vector<unsigned int> indices;
+        // Distance, in mesh units, the surface may have moved from the planes of the original triangles
+        float error;
+    };
+
+    // Collapses one vertex of an edge onto the other, cheapest quadric error first, and takes a snapshot
+    // each time the index count drops to a target. Targets are reached from the largest one down.
+    // Vertices on a border, UV seams included since they split the indices, never move,
+    // so the levels only index the input vertices.
+    // When no valid collapse is left the last level is what could be reached, the remaining targets are dropped.
+    std::vector<Level> simplify(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices, const std::vector<size_t>& targetIndexCounts);
+}
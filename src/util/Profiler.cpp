@@ -0,0 +1,132 @@
+#include "util/Profiler.hpp"
+
+// STL includes
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    struct ZoneEvent
+    {
+        const char* name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    // Written only by its own thread, the write index is published so that the exporter can read without locking
+    struct ThreadBuffer
+    {
+        static constexpr uint64_t capacity = 1 << 16;
+
+        unsigned int threadIndex = 0;
+        std::atomic<uint64_t> written{0};
+        std::array<ZoneEvent, capacity> events;
+    };
+
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    // Buffers are owned by the registry, so the zones of finished threads can still be exported
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> registry;
+
+    ThreadBuffer& threadBuffer()
+    {
+        thread_local ThreadBuffer* buffer = nullptr;
+
+        if(buffer == nullptr)
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            registry.emplace_back(std::make_unique<ThreadBuffer>());
+            buffer = registry.back().get();
+            buffer->threadIndex = static_cast<unsigned int>(registry.size());
+        }
+
+        return *buffer;
+    }
+
+    void writeEscaped(std::ofstream& file, const char* text)
+    {
+        for(const char* c = text; *c != '\0'; ++c)
+        {
+            if(*c == '"' || *c == '\\')
+            {
+                file << '\\';
+            }
+            file << *c;
+        }
+    }
+}
+
+namespace profiler
+{
+    uint64_t now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    void record(const char* name, uint64_t start, uint64_t end)
+    {
+        ThreadBuffer& buffer = threadBuffer();
+
+        // Oldest zones get overwritten once the buffer is full
+        uint64_t index = buffer.written.load(std::memory_order_relaxed);
+        buffer.events[index % ThreadBuffer::capacity] = { name, start, end };
+        buffer.written.store(index + 1, std::memory_order_release);
+    }
+
+    bool writeChromeTrace(const std::string& path)
+    {
+        std::ofstream file(path);
+        if(!file.is_open())
+        {
+            return false;
+        }
+
+        file << std::fixed << std::setprecision(3);
+        file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+
+        bool first = true;
+        for(const auto& buffer : registry)
+        {
+            uint64_t written = buffer->written.load(std::memory_order_acquire);
+            uint64_t begin = written > ThreadBuffer::capacity ? written - ThreadBuffer::capacity : 0;
+
+            for(uint64_t i = begin; i < written; ++i)
+            {
+                const ZoneEvent& event = buffer->events[i % ThreadBuffer::capacity];
+
+                file << (first ? "\n" : ",\n");
+                first = false;
+
+                // Chrome traces use microseconds
+                file << "{\"name\":\"";
+                writeEscaped(file, event.name);
+                file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadIndex
+                     << ",\"ts\":" << static_cast<double>(event.start) / 1000.0
+                     << ",\"dur\":" << static_cast<double>(event.end - event.start) / 1000.0 << "}";
+            }
+        }
+
+        file << "\n]}\n";
+
+        return true;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+
+        for(auto& buffer : registry)
+        {
+            buffer->written.store(0, std::memory_order_release);
+        }
+    }
+}
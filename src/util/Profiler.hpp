@@ -0,0 +1,77 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+#include <string>
+
+// CPU profiling zones. Only recorded when built with FLUXLUMINA_PROFILING, otherwise the macros expand to nothing.
+//
+//  void SomeClass::someMethod()
+//  {
+//      FLUX_PROFILE_FUNCTION();
+//      ...
+//      {
+//          FLUX_PROFILE_ZONE("Inner loop");
+//          ...
+//      }
+//  }
+//
+// Zone names are kept by pointer, they must outlive the profiler (string literals, function names).
+// Function zones are named by the full signature where the compiler provides one, so that methods
+// of different classes sharing a name (update, render...) stay apart in the trace.
+
+#ifdef FLUXLUMINA_PROFILING
+    #if defined(_MSC_VER)
+        #define FLUX_PROFILE_FUNCTION_NAME __FUNCSIG__
+    #elif defined(__GNUC__) || defined(__clang__)
+        #define FLUX_PROFILE_FUNCTION_NAME __PRETTY_FUNCTION__
+    #else
+        #define FLUX_PROFILE_FUNCTION_NAME __func__
+    #endif
+
+    #define FLUX_PROFILE_CONCAT_INNER(a, b) a##b
+    #define FLUX_PROFILE_CONCAT(a, b) FLUX_PROFILE_CONCAT_INNER(a, b)
+    #define FLUX_PROFILE_ZONE(name) profiler::Zone FLUX_PROFILE_CONCAT(_profilerZone, __LINE__)(name)
+    #define FLUX_PROFILE_FUNCTION() FLUX_PROFILE_ZONE(FLUX_PROFILE_FUNCTION_NAME)
+#else
+    #define FLUX_PROFILE_ZONE(name)
+    #define FLUX_PROFILE_FUNCTION()
+#endif
+
+namespace profiler
+{
+    // Nanoseconds since the profiler was first used
+    uint64_t now();
+
+    // Store a finished zone in the buffer of the calling thread
+    void record(const char* name, uint64_t start, uint64_t end);
+
+    // Write every recorded zone, of every thread, as a Chrome trace (chrome://tracing, ui.perfetto.dev)
+    bool writeChromeTrace(const std::string& path);
+
+    // Drop every recorded zone, not meant to be called while other threads are recording
+    void clear();
+
+    class Zone
+    {
+    public:
+        explicit Zone(const char* name) :
+            _name(name),
+            _start(now())
+        {
+            ;
+        }
+
+        ~Zone()
+        {
+            record(_name, _start, now());
+        }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        const char* _name;
+        uint64_t _start;
+    };
+}
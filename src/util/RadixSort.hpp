@@ -0,0 +1,49 @@
+#pragma once
+
+// STL includes
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace sorting
+{
+    // LSD radix sort, one byte at a time, stable so items with equal keys keep their order.
+    // keyOf returns the unsigned key of an item, only its keyBits low bits are sorted on.
+    // scratch holds the intermediate passes, pass the same one every time to reuse its storage.
+    template<typename T, typename KeyOf>
+    void radixSort(std::vector<T>& items, std::vector<T>& scratch, unsigned int keyBits, KeyOf keyOf)
+    {
+        const size_t count = items.size();
+        scratch.resize(count);
+
+        std::array<size_t, 256> histogram;
+        for(unsigned int shift = 0; shift < keyBits; shift += 8)
+        {
+            histogram.fill(0);
+            for(const T& item : items)
+            {
+                histogram[(keyOf(item) >> shift) & 0xFF]++;
+            }
+
+            // Every key has the same byte here, nothing to reorder
+            if(count == 0 || histogram[(keyOf(items[0]) >> shift) & 0xFF] == count)
+            {
+                continue;
+            }
+
+            size_t offset = 0;
+            for(auto& bucket : histogram)
+            {
+                size_t size = bucket;
+                bucket = offset;
+                offset += size;
+            }
+
+            for(const T& item : items)
+            {
+                scratch[histogram[(keyOf(item) >> shift) & 0xFF]++] = item;
+            }
+            items.swap(scratch);
+        }
+    }
+}
@@ -9,6 +9,11 @@ Rotation::Rotation()
 }
 
 void Rotation::rotate(float x, float y, float z)
+{
+    _rotation = rotated(_rotation, x, y, z);
+}
+
+glm::fquat Rotation::rotated(const glm::fquat& rotation, float x, float y, float z)
 {
 
     glm::fquat quatx = glm::angleAxis(glm::radians(x), glm::vec3(1.0f, 0.0f, 0.0f));
@@ -21,15 +26,15 @@ void Rotation::rotate(float x, float y, float z)
     float scalar = total.w;
     axis = glm::normalize(axis);
 
-
+    glm::fquat result;
     if (1)   // model space
     {
-        _rotation = _rotation * total;
+        result = rotation * total;
     }
     else                    // world space
-        _rotation = total * _rotation;
+        result = total * rotation;
 
-    _rotation = glm::normalize(_rotation);
+    return glm::normalize(result);
 }
 
 const glm::fquat& Rotation::getRotation() const
@@ -13,6 +13,9 @@ public:
     Rotation();
     void rotate(float x, float y, float z);
     const glm::fquat& getRotation() const;
+
+    // Model space rotation of a quaternion by euler angles in degrees
+    static glm::fquat rotated(const glm::fquat& rotation, float x, float y, float z);
 private:
     glm::fquat _rotation;    
 };
\ No newline at end of file
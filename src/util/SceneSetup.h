@@ -1,10 +1,14 @@
 #pragma once
     
+#include <array>
+#include <cmath>
+#include <random>
 #include <string>
 #include <vector>
 
 
-void scene01_Setup(FluxLumina& engine)
+// Ground, an n by n grid of statues framed by columns, one point light and three spotlights
+inline void scene01_Setup(FluxLumina& engine, int n = 5)
 {
     // Camera setup
     engine.create_Camera();
@@ -25,17 +29,20 @@ void scene01_Setup(FluxLumina& engine)
     engine.setPosition(ground_ID, {0.0f, 0.0f, 0.0f});
 
     // Create an n by n grid of statues centered at the origin and with a spacing of 10
-    int n = 5;
     float spacing = 10.0f;
     float offset = (n - 1) * spacing / 2.0f;
+    auto statues = engine.create_Models("res/models/Statue/Statue_fixed.obj", n * n, "Basic");
+    auto statueHandles = engine.getTransformHandles(statues);
+
+    std::vector<TransformUpdate> statueTransforms(statueHandles.size());
     for(int i(0); i < n; ++i)
     {
         for(int j(0); j < n; ++j)
         {
-            auto statue = engine.create_Model("res/models/Statue/Statue_fixed.obj", "Basic");
-            engine.setPosition(statue, {(i * spacing) - offset, 0.0f, (j * spacing) - offset});
+            statueTransforms[i * n + j] = {statueHandles[i * n + j], {(i * spacing) - offset, 0.0f, (j * spacing) - offset}, {1.0f, 0.0f, 0.0f, 0.0f}, 1.0f};
         }
     }
+    engine.setTransforms(statueTransforms.data(), statueTransforms.size());
 
     // place columns long the outer edges of the grid of statues
     for(int i(0); i < n; ++i)
@@ -111,7 +118,7 @@ void scene01_Setup(FluxLumina& engine)
 
 }
 
-void scene02_Setup(FluxLumina& engine)
+inline void scene02_Setup(FluxLumina& engine)
 {
     engine.create_Camera();
 
@@ -141,7 +148,7 @@ void scene02_Setup(FluxLumina& engine)
 }
 
 
-void scene03_Setup(FluxLumina& engine)
+inline void scene03_Setup(FluxLumina& engine)
 {
     // Camera setup
     engine.create_Camera();
@@ -164,4 +171,58 @@ void scene03_Setup(FluxLumina& engine)
     engine.setPosition(light_A_ID, {1.0f, 1.0f, 0.5f});
     engine.setAttenuationFactors(light_A_ID, {1.0f, 0.0f, 0.040f});
 
-}
\ No newline at end of file
+}
+
+
+// Ground covered by an n by n field of overlapping alpha foliage cards, the worst case of the transparent passes
+inline void scene04_Setup(FluxLumina& engine, int n = 40)
+{
+    // Camera setup
+    engine.create_Camera();
+
+    // Skybox setup
+    engine.create_Skybox({
+        "res/models/skybox/right.jpg",
+        "res/models/skybox/left.jpg",
+        "res/models/skybox/top.jpg",
+        "res/models/skybox/bottom.jpg",
+        "res/models/skybox/front.jpg",
+        "res/models/skybox/back.jpg"
+        });
+
+    // Models
+    auto ground_ID = engine.create_Model("res/models/Ground/Ground.obj", "Basic");
+    engine.setScale(ground_ID, 3.5f);
+    engine.setPosition(ground_ID, {0.0f, 0.0f, 0.0f});
+
+    // Cards are two units wide and placed less than one apart, any view ray crosses a dozen of them.
+    // Fixed seed, every run gets the same field.
+    float spacing = 0.75f;
+    float offset = (n - 1) * spacing / 2.0f;
+    std::mt19937 random(22);
+    std::uniform_real_distribution<float> jitter(-0.3f, 0.3f);
+    std::uniform_real_distribution<float> angle(0.0f, 3.14159265f);
+    std::uniform_real_distribution<float> size(0.8f, 1.6f);
+
+    auto cards = engine.create_Models("res/models/FoliageCard/FoliageCard.obj", n * n, "transparency");
+    auto cardHandles = engine.getTransformHandles(cards);
+
+    std::vector<TransformUpdate> cardTransforms(cardHandles.size());
+    for(int i(0); i < n; ++i)
+    {
+        for(int j(0); j < n; ++j)
+        {
+            // Around the vertical axis only, w, x, y, z
+            float yaw = angle(random);
+            std::array<float, 3> position = {(i * spacing) - offset + jitter(random), 0.0f, (j * spacing) - offset + jitter(random)};
+            cardTransforms[i * n + j] = {cardHandles[i * n + j], position, {std::cos(yaw / 2.0f), 0.0f, std::sin(yaw / 2.0f), 0.0f}, size(random)};
+        }
+    }
+    engine.setTransforms(cardTransforms.data(), cardTransforms.size());
+
+    // Point Light
+    auto light_A = engine.create_LightSource(1);
+    engine.setColor(light_A, {0.8f, 0.8f, 0.8f});
+    engine.setPosition(light_A, {0.0f, 10.0f, 0.0f});
+    engine.setAttenuationFactors(light_A, {1.0f, 0.0f, 0.002f});
+}
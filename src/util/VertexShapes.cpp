@@ -1,5 +1,6 @@
 #include "util/VertexShapes.hpp"
 #include "rendering/GLFW_Wrapper.hpp"
+#include "rendering/GLStateCache.hpp"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
@@ -127,7 +128,7 @@ namespace
 
         // Generate and bind the VAO
         glGenVertexArrays(1, &sphereVAO_nr);
-        glBindVertexArray(sphereVAO_nr);
+        GLStateCache::Instance().bindVertexArray(sphereVAO_nr);
 
         // Generate and bind the VBO
         glGenBuffers(1, &sphereVBO_nr);
@@ -146,7 +147,7 @@ namespace
         glEnableVertexAttribArray(1);
 
         // Unbind the VAO
-        glBindVertexArray(0);
+        GLStateCache::Instance().bindVertexArray(0);
 
         return sphereVAO_nr;
     } 
@@ -164,7 +165,7 @@ namespace shapes
             {
                 glGenVertexArrays(1, &quadVAO_nr);
                 glGenBuffers(1, &quadVBO_nr);
-                glBindVertexArray(quadVAO_nr);
+                GLStateCache::Instance().bindVertexArray(quadVAO_nr);
                 glBindBuffer(GL_ARRAY_BUFFER, quadVBO_nr);
                 glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
                 glEnableVertexAttribArray(0);
@@ -187,7 +188,7 @@ namespace shapes
             {
                 glGenVertexArrays(1, &cubeVAO_nr);
                 glGenBuffers(1, &quadVBO_nr);
-                glBindVertexArray(cubeVAO_nr);
+                GLStateCache::Instance().bindVertexArray(cubeVAO_nr);
                 glBindBuffer(GL_ARRAY_BUFFER, quadVBO_nr);
                 glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), &cubeVertices, GL_STATIC_DRAW);
                 glEnableVertexAttribArray(0);
@@ -0,0 +1,153 @@
+#include "util/MeshSimplifier.hpp"
+
+// Third-party includes
+#include <gtest/gtest.h>
+
+// STL includes
+#include <cmath>
+#include <set>
+#include <vector>
+
+namespace
+{
+    // Flat square of size x size vertices in the XY plane, counter clockwise seen from +Z
+    void buildGrid(unsigned int size, std::vector<glm::vec3>& positions, std::vector<unsigned int>& indices)
+    {
+        for (unsigned int y = 0; y < size; ++y)
+        {
+            for (unsigned int x = 0; x < size; ++x)
+            {
+                positions.push_back(glm::vec3(static_cast<float>(x), static_cast<float>(y), 0.0f));
+            }
+        }
+
+        for (unsigned int y = 0; y + 1 < size; ++y)
+        {
+            for (unsigned int x = 0; x + 1 < size; ++x)
+            {
+                unsigned int corner = y * size + x;
+                indices.insert(indices.end(), {corner, corner + 1, corner + size + 1});
+                indices.insert(indices.end(), {corner, corner + size + 1, corner + size});
+            }
+        }
+    }
+
+    bool isBorder(unsigned int vertex, unsigned int size)
+    {
+        unsigned int x = vertex % size;
+        unsigned int y = vertex / size;
+        return x == 0 || y == 0 || x == size - 1 || y == size - 1;
+    }
+
+    // Every triangle valid and still facing +Z
+    bool isValidGrid(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices)
+    {
+        if (indices.size() % 3 != 0)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            if (indices[i] >= positions.size() || indices[i + 1] >= positions.size() || indices[i + 2] >= positions.size())
+            {
+                return false;
+            }
+            glm::vec3 normal = glm::cross(positions[indices[i + 1]] - positions[indices[i]], positions[indices[i + 2]] - positions[indices[i]]);
+            if (normal.z <= 0.0f)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+TEST(MeshSimplifier, ReachesTargetsFromTheLargestDown)
+{
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+    buildGrid(9, positions, indices);
+    EXPECT_EQ(indices.size(), 384u);
+
+    // Unsorted on purpose
+    std::vector<simplification::Level> levels = simplification::simplify(positions, indices, {150, 300, 200});
+    ASSERT_EQ(levels.size(), 3u);
+
+    const size_t targets[] = {300, 200, 150};
+    size_t previousCount = indices.size();
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        EXPECT_LE(levels[i].indices.size(), targets[i]);
+        EXPECT_LT(levels[i].indices.size(), previousCount);
+        EXPECT_TRUE(isValidGrid(positions, levels[i].indices));
+        // Every collapse stays in the plane
+        EXPECT_LT(levels[i].error, 1e-3f);
+        previousCount = levels[i].indices.size();
+    }
+}
+
+TEST(MeshSimplifier, LocksBorderVertices)
+{
+    const unsigned int size = 9;
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+    buildGrid(size, positions, indices);
+
+    // Far below what the border allows, the last level is as far as it could go
+    std::vector<simplification::Level> levels = simplification::simplify(positions, indices, {3});
+    ASSERT_EQ(levels.size(), 1u);
+
+    const std::vector<unsigned int>& simplified = levels.back().indices;
+    EXPECT_LT(simplified.size(), indices.size());
+    EXPECT_TRUE(isValidGrid(positions, simplified));
+
+    std::set<unsigned int> used(simplified.begin(), simplified.end());
+    for (unsigned int vertex = 0; vertex < positions.size(); ++vertex)
+    {
+        if (isBorder(vertex, size))
+        {
+            EXPECT_EQ(used.count(vertex), 1u);
+        }
+    }
+}
+
+TEST(MeshSimplifier, DropsTargetsOnceExhausted)
+{
+    // Closed cube, no border but nothing simpler than a tetrahedron can come out of it
+    std::vector<glm::vec3> positions;
+    for (unsigned int corner = 0; corner < 8; ++corner)
+    {
+        positions.push_back(glm::vec3(static_cast<float>(corner & 1), static_cast<float>((corner >> 1) & 1), static_cast<float>((corner >> 2) & 1)));
+    }
+    std::vector<unsigned int> indices = {
+        0, 2, 3, 0, 3, 1,
+        4, 5, 7, 4, 7, 6,
+        0, 1, 5, 0, 5, 4,
+        2, 6, 7, 2, 7, 3,
+        0, 4, 6, 0, 6, 2,
+        1, 3, 7, 1, 7, 5
+    };
+
+    std::vector<simplification::Level> levels = simplification::simplify(positions, indices, {30, 6, 3});
+    ASSERT_FALSE(levels.empty());
+    EXPECT_LT(levels.size(), 3u);
+
+    EXPECT_LE(levels.front().indices.size(), 30u);
+    EXPECT_GE(levels.back().indices.size(), 12u);
+    EXPECT_EQ(levels.back().indices.size() % 3, 0u);
+    EXPECT_GT(levels.back().error, 0.0f);
+}
+
+TEST(MeshSimplifier, SkipsTargetsAlreadyMet)
+{
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+    buildGrid(5, positions, indices);
+
+    // Above the input count, no collapse and no level
+    EXPECT_TRUE(simplification::simplify(positions, indices, {1000}).empty());
+
+    // Two targets met by the same collapses give a single level
+    std::vector<simplification::Level> levels = simplification::simplify(positions, indices, {indices.size() - 1, indices.size() - 2});
+    EXPECT_EQ(levels.size(), 1u);
+}
@@ -0,0 +1,111 @@
+#include "rendering/GeometryBuffer.hpp"
+
+// Third-party includes
+#include <gtest/gtest.h>
+
+// STL includes
+#include <utility>
+#include <vector>
+
+TEST(RangeAllocator, AllocatesFirstFit)
+{
+    RangeAllocator allocator(100);
+
+    EXPECT_EQ(allocator.allocate(10), 0u);
+    EXPECT_EQ(allocator.allocate(20), 10u);
+    EXPECT_EQ(allocator.allocate(30), 30u);
+    EXPECT_EQ(allocator.getUsed(), 60u);
+    EXPECT_EQ(allocator.getLargestFreeBlock(), 40u);
+
+    // The hole left at the front is the first block large enough
+    allocator.release(0, 10);
+    EXPECT_EQ(allocator.allocate(5), 0u);
+    EXPECT_EQ(allocator.allocate(5), 5u);
+    EXPECT_EQ(allocator.allocate(5), 60u);
+}
+
+TEST(RangeAllocator, FailsWhenNoBlockIsLargeEnough)
+{
+    RangeAllocator allocator(64);
+
+    EXPECT_EQ(allocator.allocate(65), RangeAllocator::invalid);
+    EXPECT_EQ(allocator.allocate(64), 0u);
+    EXPECT_EQ(allocator.allocate(1), RangeAllocator::invalid);
+    EXPECT_EQ(allocator.getFreeBlockCount(), 0u);
+
+    // Enough free space in total, but split in two blocks
+    allocator.release(0, 16);
+    allocator.release(32, 16);
+    EXPECT_EQ(allocator.getUsed(), 32u);
+    EXPECT_EQ(allocator.allocate(20), RangeAllocator::invalid);
+    EXPECT_EQ(allocator.getUsed(), 32u);
+
+    RangeAllocator empty(0);
+    EXPECT_EQ(empty.allocate(1), RangeAllocator::invalid);
+}
+
+TEST(RangeAllocator, CoalescesNeighbouringBlocks)
+{
+    RangeAllocator allocator(40);
+    unsigned int a = allocator.allocate(10);
+    unsigned int b = allocator.allocate(10);
+    unsigned int c = allocator.allocate(10);
+    unsigned int d = allocator.allocate(10);
+    EXPECT_EQ(allocator.getFreeBlockCount(), 0u);
+
+    // Not adjacent, stay apart
+    allocator.release(a, 10);
+    allocator.release(c, 10);
+    EXPECT_EQ(allocator.getFreeBlockCount(), 2u);
+    EXPECT_EQ(allocator.getLargestFreeBlock(), 10u);
+
+    // Merged with the block before and the block after
+    allocator.release(b, 10);
+    EXPECT_EQ(allocator.getFreeBlockCount(), 1u);
+    EXPECT_EQ(allocator.getLargestFreeBlock(), 30u);
+    EXPECT_EQ(allocator.allocate(30), 0u);
+
+    allocator.release(0, 30);
+    allocator.release(d, 10);
+    EXPECT_EQ(allocator.getFreeBlockCount(), 1u);
+    EXPECT_EQ(allocator.getLargestFreeBlock(), 40u);
+    EXPECT_EQ(allocator.getUsed(), 0u);
+}
+
+TEST(RangeAllocator, IgnoresEmptyReleases)
+{
+    RangeAllocator allocator(10);
+    allocator.allocate(10);
+
+    allocator.release(5, 0);
+    EXPECT_EQ(allocator.getUsed(), 10u);
+    EXPECT_EQ(allocator.getFreeBlockCount(), 0u);
+}
+
+TEST(RangeAllocator, StaysConsistentUnderChurn)
+{
+    RangeAllocator allocator(1000);
+    std::vector<std::pair<unsigned int, unsigned int>> blocks;
+
+    // Deterministic sizes, released in an interleaved order
+    for (unsigned int i = 0; i < 40; ++i)
+    {
+        unsigned int size = 1 + (i * 7) % 23;
+        unsigned int offset = allocator.allocate(size);
+        ASSERT_NE(offset, RangeAllocator::invalid);
+        blocks.push_back({offset, size});
+    }
+
+    for (size_t i = 0; i < blocks.size(); i += 2)
+    {
+        allocator.release(blocks[i].first, blocks[i].second);
+    }
+    for (size_t i = 1; i < blocks.size(); i += 2)
+    {
+        allocator.release(blocks[i].first, blocks[i].second);
+    }
+
+    EXPECT_EQ(allocator.getUsed(), 0u);
+    EXPECT_EQ(allocator.getFreeBlockCount(), 1u);
+    EXPECT_EQ(allocator.getLargestFreeBlock(), 1000u);
+}
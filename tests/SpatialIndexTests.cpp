@@ -0,0 +1,224 @@
+#include "scene/SpatialIndex.hpp"
+
+// Third-party includes
+#include <glm/gtc/matrix_transform.hpp>
+#include <gtest/gtest.h>
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // The index never dereferences its objects, any distinct address will do
+    SceneObject* objectAt(std::vector<char>& storage, size_t index)
+    {
+        return reinterpret_cast<SceneObject*>(&storage[index]);
+    }
+
+    AABB randomBox(std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> size(0.1f, 5.0f);
+
+        glm::vec3 min(position(random), position(random), position(random));
+        return {min, min + glm::vec3(size(random), size(random), size(random))};
+    }
+
+    struct Entry
+    {
+        SceneObject* object;
+        int proxy;
+        uint32_t mask;
+    };
+
+    bool sameObjects(std::vector<SceneObject*> a, std::vector<SceneObject*> b)
+    {
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        return a == b;
+    }
+
+    // Queries against every leaf, with the same tests the tree applies to its nodes
+    std::vector<SceneObject*> bruteSphere(const SpatialIndex& index, const std::vector<Entry>& entries, const BoundingSphere& sphere, uint32_t mask)
+    {
+        std::vector<SceneObject*> results;
+        for (const Entry& entry : entries)
+        {
+            const AABB& box = index.getFatBounds(entry.proxy);
+            glm::vec3 offset = glm::clamp(sphere.center, box.min, box.max) - sphere.center;
+            if ((entry.mask & mask) != 0 && glm::dot(offset, offset) <= sphere.radius * sphere.radius)
+            {
+                results.push_back(entry.object);
+            }
+        }
+        return results;
+    }
+
+    std::vector<SceneObject*> bruteFrustum(const SpatialIndex& index, const std::vector<Entry>& entries, const Frustum& frustum, uint32_t mask)
+    {
+        std::vector<SceneObject*> results;
+        for (const Entry& entry : entries)
+        {
+            if ((entry.mask & mask) != 0 && frustum.classify(index.getFatBounds(entry.proxy)) != E_Containment::OUTSIDE)
+            {
+                results.push_back(entry.object);
+            }
+        }
+        return results;
+    }
+
+    void checkQueries(const SpatialIndex& index, const std::vector<Entry>& entries, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> radius(1.0f, 40.0f);
+
+        for (uint32_t mask : {~0u, 1u, 2u, 4u})
+        {
+            for (int query = 0; query < 8; ++query)
+            {
+                BoundingSphere sphere;
+                sphere.center = glm::vec3(position(random), position(random), position(random));
+                sphere.radius = radius(random);
+
+                std::vector<SceneObject*> results;
+                index.querySphere(sphere, results, mask);
+                EXPECT_TRUE(sameObjects(results, bruteSphere(index, entries, sphere, mask)));
+            }
+
+            glm::vec3 eye(position(random), position(random), position(random));
+            glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            Frustum frustum(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 150.0f) * view);
+
+            std::vector<SceneObject*> results;
+            index.queryFrustum(frustum, results, mask);
+            EXPECT_TRUE(sameObjects(results, bruteFrustum(index, entries, frustum, mask)));
+        }
+    }
+}
+
+TEST(SpatialIndex, QueriesMatchBruteForceThroughChanges)
+{
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> step(-3.0f, 3.0f);
+    std::vector<char> storage(600);
+
+    SpatialIndex index;
+    std::vector<Entry> entries;
+    size_t nextObject = 0;
+
+    for (int i = 0; i < 300; ++i)
+    {
+        uint32_t mask = 1u << (i % 3);
+        SceneObject* object = objectAt(storage, nextObject++);
+        entries.push_back({object, index.insert(object, randomBox(random), mask), mask});
+    }
+    EXPECT_EQ(index.size(), entries.size());
+    checkQueries(index, entries, random);
+
+    // Small moves mostly stay inside the fat boxes, teleports always reinsert
+    for (Entry& entry : entries)
+    {
+        AABB box = index.getFatBounds(entry.proxy).grown(-0.5f);
+        glm::vec3 offset(step(random), step(random), step(random));
+        AABB moved = {box.min + offset, box.max + offset};
+        index.move(entry.proxy, moved);
+        EXPECT_TRUE(index.getFatBounds(entry.proxy).contains(moved));
+    }
+    for (size_t i = 0; i < entries.size(); i += 4)
+    {
+        AABB moved = randomBox(random);
+        index.move(entries[i].proxy, moved);
+        EXPECT_TRUE(index.getFatBounds(entries[i].proxy).contains(moved));
+    }
+    checkQueries(index, entries, random);
+
+    // Removed objects are gone, their nodes get reused by the next inserts
+    for (size_t i = 0; i < 150; ++i)
+    {
+        size_t victim = random() % entries.size();
+        index.remove(entries[victim].proxy);
+        entries.erase(entries.begin() + victim);
+    }
+    EXPECT_EQ(index.size(), entries.size());
+    checkQueries(index, entries, random);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        SceneObject* object = objectAt(storage, nextObject++);
+        entries.push_back({object, index.insert(object, randomBox(random), 1u), 1u});
+    }
+    EXPECT_EQ(index.size(), entries.size());
+    checkQueries(index, entries, random);
+}
+
+TEST(SpatialIndex, MovesInsideTheFatBoxAreFree)
+{
+    std::vector<char> storage(1);
+    SpatialIndex index(1.0f);
+
+    int proxy = index.insert(objectAt(storage, 0), {glm::vec3(0.0f), glm::vec3(1.0f)}, 1u);
+    EXPECT_TRUE(index.getFatBounds(proxy).contains({glm::vec3(-1.0f), glm::vec3(2.0f)}));
+
+    EXPECT_FALSE(index.move(proxy, {glm::vec3(0.5f), glm::vec3(1.5f)}));
+    EXPECT_TRUE(index.move(proxy, {glm::vec3(10.0f), glm::vec3(11.0f)}));
+    EXPECT_TRUE(index.getFatBounds(proxy).contains({glm::vec3(10.0f), glm::vec3(11.0f)}));
+}
+
+TEST(SpatialIndex, StaysBalancedOnSortedInserts)
+{
+    // Inserting along a line is the worst case of an unbalanced tree, it would grow as deep as there are leaves
+    std::vector<char> storage(1024);
+    SpatialIndex index(0.0f);
+    std::vector<int> proxies;
+    for (size_t i = 0; i < storage.size(); ++i)
+    {
+        glm::vec3 min(static_cast<float>(i) * 2.0f, 0.0f, 0.0f);
+        proxies.push_back(index.insert(objectAt(storage, i), {min, min + glm::vec3(1.0f)}, 1u));
+    }
+    EXPECT_LE(index.getHeight(), 2 * static_cast<int>(std::log2(storage.size())));
+
+    for (size_t i = 0; i < proxies.size(); i += 2)
+    {
+        index.remove(proxies[i]);
+    }
+    EXPECT_EQ(index.size(), storage.size() / 2);
+    EXPECT_LE(index.getHeight(), 2 * static_cast<int>(std::log2(storage.size())));
+
+    for (size_t i = 1; i < proxies.size(); i += 2)
+    {
+        index.remove(proxies[i]);
+    }
+    EXPECT_EQ(index.size(), 0u);
+    EXPECT_EQ(index.getHeight(), 0);
+}
+
+TEST(SpatialIndex, RayHitsAreSortedByDistance)
+{
+    std::vector<char> storage(10);
+    SpatialIndex index(0.0f);
+
+    // A row of unit boxes along x, every other one off the ray
+    for (size_t i = 0; i < storage.size(); ++i)
+    {
+        glm::vec3 min(static_cast<float>(9 - i) * 3.0f, i % 2 == 0 ? 0.0f : 5.0f, 0.0f);
+        index.insert(objectAt(storage, i), {min, min + glm::vec3(1.0f)}, 1u);
+    }
+
+    std::vector<RayHit> hits;
+    index.queryRay(glm::vec3(-5.0f, 0.5f, 0.5f), glm::vec3(1.0f, 0.0f, 0.0f), 100.0f, hits);
+    EXPECT_EQ(hits.size(), 5u);
+    for (size_t i = 0; i < hits.size(); ++i)
+    {
+        // Closest first, the box of object 8 starts at x = 3
+        EXPECT_EQ(hits[i].object, objectAt(storage, 8 - 2 * i));
+        EXPECT_NEAR(hits[i].distance, 8.0f + 6.0f * static_cast<float>(i), 1e-4f);
+    }
+
+    // Cut short by the maximum distance
+    hits.clear();
+    index.queryRay(glm::vec3(-5.0f, 0.5f, 0.5f), glm::vec3(1.0f, 0.0f, 0.0f), 10.0f, hits);
+    EXPECT_EQ(hits.size(), 1u);
+}
@@ -0,0 +1,302 @@
+#include "scene/TransformStore.hpp"
+
+// Third-party includes
+#include <glm/gtc/matrix_transform.hpp>
+#include <gtest/gtest.h>
+
+// STL includes
+#include <cmath>
+
+namespace
+{
+    bool near(const glm::mat4& a, const glm::mat4& b)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            for (int row = 0; row < 4; ++row)
+            {
+                if (std::abs(a[column][row] - b[column][row]) > 1e-4f)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // What TransformStore::compose builds without the intermediate matrices
+    glm::mat4 local(const std::array<float, 3>& position, const glm::fquat& rotation, float scale)
+    {
+        glm::mat4 matrix = glm::translate(glm::mat4(1.0f), glm::vec3(position[0], position[1], position[2]));
+        matrix = glm::scale(matrix, glm::vec3(scale));
+        return matrix * glm::mat4_cast(rotation);
+    }
+}
+
+TEST(TransformStore, MatchesTranslateScaleRotate)
+{
+    TransformStore& store = TransformStore::Instance();
+    unsigned int entry = store.allocate();
+    EXPECT_TRUE(near(store.getWorldMatrix(entry), glm::mat4(1.0f)));
+
+    const glm::fquat rotation = glm::angleAxis(glm::radians(30.0f), glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f)));
+    store.setPosition(entry, {1.0f, -2.0f, 3.0f});
+    store.setRotation(entry, rotation);
+    store.setScale(entry, 2.5f);
+    EXPECT_TRUE(near(store.getWorldMatrix(entry), local({1.0f, -2.0f, 3.0f}, rotation, 2.5f)));
+
+    // Applied before the entry's own transform
+    const glm::mat4 offset = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 4.0f, 0.0f));
+    store.setOffset(entry, offset);
+    EXPECT_TRUE(near(store.getWorldMatrix(entry), local({1.0f, -2.0f, 3.0f}, rotation, 2.5f) * offset));
+
+    store.release(entry);
+}
+
+TEST(TransformStore, UpdateRebuildsEveryDirtyEntry)
+{
+    TransformStore& store = TransformStore::Instance();
+
+    // More than one 64 entry block, so that fully and partly dirty blocks are both taken
+    std::vector<unsigned int> entries;
+    for (unsigned int i = 0; i < 200; ++i)
+    {
+        entries.push_back(store.allocate());
+    }
+    for (unsigned int i = 0; i < entries.size(); ++i)
+    {
+        store.setPosition(entries[i], {static_cast<float>(i), 0.0f, 0.0f});
+    }
+    store.update();
+    for (unsigned int i = 0; i < entries.size(); ++i)
+    {
+        EXPECT_TRUE(near(store.getWorldMatrix(entries[i]), glm::translate(glm::mat4(1.0f), glm::vec3(static_cast<float>(i), 0.0f, 0.0f))));
+    }
+
+    // Every third one only
+    for (unsigned int i = 0; i < entries.size(); i += 3)
+    {
+        store.setScale(entries[i], 2.0f);
+    }
+    store.update();
+    for (unsigned int i = 0; i < entries.size(); ++i)
+    {
+        glm::mat4 expected = glm::translate(glm::mat4(1.0f), glm::vec3(static_cast<float>(i), 0.0f, 0.0f));
+        if (i % 3 == 0)
+        {
+            expected = glm::scale(expected, glm::vec3(2.0f));
+        }
+        EXPECT_TRUE(near(store.getWorldMatrix(entries[i]), expected));
+    }
+
+    for (unsigned int entry : entries)
+    {
+        store.release(entry);
+    }
+}
+
+TEST(TransformStore, FullyDirtyBlocksKeepTheirHierarchy)
+{
+    TransformStore& store = TransformStore::Instance();
+
+    // Three blocks at least, every entry moved, with one child and one offset among them
+    std::vector<unsigned int> entries;
+    for (unsigned int i = 0; i < 192; ++i)
+    {
+        entries.push_back(store.allocate());
+    }
+    const glm::mat4 offset = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    store.setParent(entries[100], entries[10]);
+    store.setOffset(entries[150], offset);
+    store.update();
+
+    for (unsigned int i = 0; i < entries.size(); ++i)
+    {
+        store.setPosition(entries[i], {0.0f, static_cast<float>(i), 0.0f});
+    }
+    store.update();
+    for (unsigned int i = 0; i < entries.size(); ++i)
+    {
+        glm::mat4 expected = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, static_cast<float>(i), 0.0f));
+        if (i == 100)
+        {
+            expected = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 110.0f, 0.0f));
+        }
+        if (i == 150)
+        {
+            expected = expected * offset;
+        }
+        EXPECT_TRUE(near(store.getWorldMatrix(entries[i]), expected));
+    }
+
+    for (unsigned int entry : entries)
+    {
+        store.release(entry);
+    }
+}
+
+TEST(TransformStore, ReadsBeforeUpdateAreRebuilt)
+{
+    TransformStore& store = TransformStore::Instance();
+    unsigned int entry = store.allocate();
+    store.update();
+
+    store.setPosition(entry, {0.0f, 0.0f, -5.0f});
+    EXPECT_TRUE(near(store.getWorldMatrix(entry), glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -5.0f))));
+
+    store.release(entry);
+}
+
+TEST(TransformStore, ReusedSlotsStartFromIdentity)
+{
+    TransformStore& store = TransformStore::Instance();
+    unsigned int entry = store.allocate();
+    store.setPosition(entry, {4.0f, 5.0f, 6.0f});
+    store.setScale(entry, 3.0f);
+    store.update();
+    store.release(entry);
+
+    unsigned int reused = store.allocate();
+    EXPECT_EQ(reused, entry);
+    EXPECT_EQ(store.getScale(reused), 1.0f);
+    EXPECT_TRUE(near(store.getWorldMatrix(reused), glm::mat4(1.0f)));
+
+    store.release(reused);
+}
+
+TEST(TransformStore, ChildrenFollowTheirParent)
+{
+    TransformStore& store = TransformStore::Instance();
+    unsigned int parent = store.allocate();
+    unsigned int child = store.allocate();
+    unsigned int grandChild = store.allocate();
+
+    const glm::fquat identity(1.0f, 0.0f, 0.0f, 0.0f);
+    const glm::fquat rotation = glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    store.setPosition(parent, {10.0f, 0.0f, 0.0f});
+    store.setRotation(parent, rotation);
+    store.setScale(parent, 2.0f);
+    store.setParent(child, parent);
+    store.setPosition(child, {0.0f, 0.0f, 1.0f});
+    store.setParent(grandChild, child);
+    store.setScale(grandChild, 0.5f);
+    store.update();
+
+    const glm::mat4 childLocal = local({0.0f, 0.0f, 1.0f}, identity, 1.0f);
+    const glm::mat4 grandChildLocal = local({0.0f, 0.0f, 0.0f}, identity, 0.5f);
+    EXPECT_EQ(store.getParent(child), parent);
+    EXPECT_TRUE(near(store.getWorldMatrix(child), local({10.0f, 0.0f, 0.0f}, rotation, 2.0f) * childLocal));
+    EXPECT_TRUE(near(store.getWorldMatrix(grandChild), local({10.0f, 0.0f, 0.0f}, rotation, 2.0f) * childLocal * grandChildLocal));
+
+    store.setPosition(parent, {0.0f, 5.0f, 0.0f});
+    store.update();
+    EXPECT_TRUE(near(store.getWorldMatrix(child), local({0.0f, 5.0f, 0.0f}, rotation, 2.0f) * childLocal));
+
+    // Read before update(), the dirty ancestor is rebuilt on the spot
+    store.setPosition(parent, {0.0f, 0.0f, -5.0f});
+    EXPECT_TRUE(near(store.getWorldMatrix(grandChild), local({0.0f, 0.0f, -5.0f}, rotation, 2.0f) * childLocal * grandChildLocal));
+
+    store.release(grandChild);
+    store.release(child);
+    store.release(parent);
+}
+
+TEST(TransformStore, RefusesCycles)
+{
+    TransformStore& store = TransformStore::Instance();
+    unsigned int a = store.allocate();
+    unsigned int b = store.allocate();
+
+    store.setParent(b, a);
+    store.setParent(a, b);
+    store.setParent(a, a);
+    EXPECT_EQ(store.getParent(a), TransformStore::none);
+    EXPECT_EQ(store.getParent(b), a);
+
+    store.setParent(b, TransformStore::none);
+    EXPECT_EQ(store.getParent(b), TransformStore::none);
+
+    store.release(a);
+    store.release(b);
+}
+
+TEST(TransformStore, ReleasedParentLeavesRoots)
+{
+    TransformStore& store = TransformStore::Instance();
+    unsigned int parent = store.allocate();
+    unsigned int first = store.allocate();
+    unsigned int second = store.allocate();
+
+    store.setPosition(parent, {3.0f, 0.0f, 0.0f});
+    store.setParent(first, parent);
+    store.setParent(second, parent);
+    store.setPosition(second, {0.0f, 1.0f, 0.0f});
+    store.update();
+    EXPECT_TRUE(near(store.getWorldMatrix(second), glm::translate(glm::mat4(1.0f), glm::vec3(3.0f, 1.0f, 0.0f))));
+
+    store.release(parent);
+    EXPECT_EQ(store.getParent(first), TransformStore::none);
+    EXPECT_EQ(store.getParent(second), TransformStore::none);
+    store.update();
+    EXPECT_TRUE(near(store.getWorldMatrix(first), glm::mat4(1.0f)));
+    EXPECT_TRUE(near(store.getWorldMatrix(second), glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.0f, 0.0f))));
+
+    // The slot is reused, without its old children
+    unsigned int reused = store.allocate();
+    EXPECT_EQ(reused, parent);
+    store.setPosition(reused, {7.0f, 0.0f, 0.0f});
+    store.update();
+    EXPECT_TRUE(near(store.getWorldMatrix(second), glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.0f, 0.0f))));
+
+    store.release(reused);
+    store.release(first);
+    store.release(second);
+}
+
+TEST(TransformStore, VersionsFollowRebuilds)
+{
+    TransformStore& store = TransformStore::Instance();
+    unsigned int parent = store.allocate();
+    unsigned int child = store.allocate();
+    unsigned int unrelated = store.allocate();
+    store.setParent(child, parent);
+    store.update();
+
+    // Moving the parent rebuilds its subtree only
+    const uint32_t parentVersion = store.getVersion(parent);
+    const uint32_t childVersion = store.getVersion(child);
+    const uint32_t unrelatedVersion = store.getVersion(unrelated);
+    store.setPosition(parent, {0.0f, 5.0f, 0.0f});
+    store.update();
+    EXPECT_NE(store.getVersion(parent), parentVersion);
+    EXPECT_NE(store.getVersion(child), childVersion);
+    EXPECT_EQ(store.getVersion(unrelated), unrelatedVersion);
+
+    // Nothing changed, nothing rebuilt
+    const uint32_t settledVersion = store.getVersion(child);
+    store.update();
+    EXPECT_EQ(store.getVersion(child), settledVersion);
+
+    store.release(child);
+    store.release(parent);
+    store.release(unrelated);
+}
+
+TEST(TransformStore, HandlesGoStaleOnRelease)
+{
+    TransformStore& store = TransformStore::Instance();
+    unsigned int entry = store.allocate();
+    unsigned int handle = store.getHandle(entry);
+    EXPECT_EQ(store.resolve(handle), entry);
+    EXPECT_EQ(store.resolve(TransformStore::none), TransformStore::none);
+
+    // Released, then the slot goes to another object
+    store.release(entry);
+    EXPECT_EQ(store.resolve(handle), TransformStore::none);
+    unsigned int reused = store.allocate();
+    EXPECT_EQ(reused, entry);
+    EXPECT_EQ(store.resolve(handle), TransformStore::none);
+    EXPECT_EQ(store.resolve(store.getHandle(reused)), reused);
+
+    store.release(reused);
+}